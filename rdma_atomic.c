@@ -0,0 +1,452 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA ATOMIC - Compteurs et verrous dans la RAM du serveur
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * Voir rdma_atomic.h
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "rdma_common.h"
+#include "rdma_atomic.h"
+
+// Mots communs du benchmark, au début de la RAM serveur, chacun sur
+// SA ligne de cache (deux mots sur la même ligne : la carte du
+// serveur sérialise aussi leurs atomiques)
+#define AT_LOCK_OFF         0       // Le verrou
+#define AT_GUARDED_OFF      64      // Compteur protégé par le verrou
+#define AT_SHARED_OFF       128     // Compteur commun (FAA / CAS)
+#define AT_SLICE_MIN        512     // Tranche serveur d'un thread : son
+                                    // compteur privé est à la fin
+#define AT_LOCK_TIMEOUT_MS  1000    // Verrou gardé plus longtemps : abandon
+
+void ra_init(struct remote_atomic *ra, struct ibv_qp *qp,
+             struct cq_waiter *cqw, void *result, uint32_t lkey,
+             uint32_t rkey) {
+    memset(ra, 0, sizeof(*ra));
+    ra->qp = qp;
+    ra->cqw = cqw;
+    ra->result = result;
+    ra->lkey = lkey;
+    ra->rkey = rkey;
+    ra->seed = (uint64_t)result | 1;   // Un par buffer : des reculs différents
+}
+
+int post_atomic(struct ibv_qp *qp, enum ibv_wr_opcode opcode,
+                uint64_t wr_id, uint64_t *result, uint32_t lkey,
+                uint64_t remote_addr, uint32_t rkey,
+                uint64_t compare_add, uint64_t swap,
+                unsigned int send_flags) {
+    struct ibv_sge sge;
+    sge.addr = (uint64_t)result;
+    sge.length = sizeof(*result);
+    sge.lkey = lkey;
+
+    struct ibv_send_wr wr, *bad_wr;
+    memset(&wr, 0, sizeof(wr));
+    wr.wr_id = wr_id;
+    wr.sg_list = &sge;
+    wr.num_sge = 1;
+    wr.opcode = opcode;
+    wr.send_flags = send_flags;
+    wr.wr.atomic.remote_addr = remote_addr;
+    wr.wr.atomic.compare_add = compare_add;
+    wr.wr.atomic.swap = swap;
+    wr.wr.atomic.rkey = rkey;
+
+    return ibv_post_send(qp, &wr, &bad_wr);
+}
+
+// ═══════════════════════════════════════════════════════
+// UN ATOMIQUE, ALLER-RETOUR
+// ═══════════════════════════════════════════════════════
+// Un WR signalé, on attend SA complétion : l'ancienne valeur est
+// alors dans ra->result (écrite par la carte, comme un READ).
+
+static int ra_op(struct remote_atomic *ra, enum ibv_wr_opcode opcode,
+                 uint64_t remote_addr, uint64_t compare_add,
+                 uint64_t swap, uint64_t *old) {
+    const char *what = opcode == IBV_WR_ATOMIC_FETCH_AND_ADD ?
+                       "FETCH_AND_ADD" : "COMPARE_AND_SWAP";
+
+    if (remote_addr & 7) {
+        printf("   ❌ %s sur 0x%lx : pas aligné sur 8 octets\n",
+               what, remote_addr);
+        return -1;
+    }
+
+    int ret = post_atomic(ra->qp, opcode, ra->ops, ra->result, ra->lkey,
+                          remote_addr, ra->rkey, compare_add, swap,
+                          IBV_SEND_SIGNALED);
+    if (ret) {
+        printf("   ❌ ibv_post_send (%s) : %s\n", what, strerror(ret));
+        return -1;
+    }
+
+    struct ibv_wc wc;
+    if (wait_wc(ra->cqw, &wc, what))
+        return -1;
+    ra->ops++;
+    *old = *ra->result;
+    return 0;
+}
+
+int ra_fetch_add(struct remote_atomic *ra, uint64_t remote_addr,
+                 uint64_t add, uint64_t *old) {
+    return ra_op(ra, IBV_WR_ATOMIC_FETCH_AND_ADD, remote_addr, add, 0, old);
+}
+
+int ra_cmp_swap(struct remote_atomic *ra, uint64_t remote_addr,
+                uint64_t expect, uint64_t swap, uint64_t *old) {
+    if (ra_op(ra, IBV_WR_ATOMIC_CMP_AND_SWP, remote_addr, expect, swap, old))
+        return -1;
+    if (*old != expect)
+        ra->cas_failed++;
+    return 0;
+}
+
+// ═══════════════════════════════════════════════════════
+// VERROU : CAS + RECUL EXPONENTIEL
+// ═══════════════════════════════════════════════════════
+// Chaque CAS perdu double le recul (RA_BACKOFF_MIN_NS → _MAX_NS),
+// tiré entre la moitié et le tout : les perdants ne repartent pas
+// tous ensemble sur le même mot.
+
+int ra_lock(struct remote_atomic *ra, uint64_t remote_addr, uint64_t owner,
+            int timeout_ms) {
+    uint64_t delay = RA_BACKOFF_MIN_NS;
+    uint64_t start = bench_now();
+    uint64_t old;
+
+    for (;;) {
+        if (ra_cmp_swap(ra, remote_addr, 0, owner, &old))
+            return -1;
+        if (old == 0)
+            return 0;
+        if (old == owner) {
+            printf("   ❌ Verrou 0x%lx déjà pris par %lu (nous)\n",
+                   remote_addr, owner);
+            return -1;
+        }
+        if (timeout_ms >= 0 &&
+            bench_ticks_to_ns(bench_now() - start) > timeout_ms * 1000000ULL)
+            return 1;
+
+        uint64_t wait = delay / 2 + xorshift64(&ra->seed) % (delay / 2 + 1);
+        uint64_t t0 = bench_now();
+        while (bench_ticks_to_ns(bench_now() - t0) < wait);
+        if (delay < RA_BACKOFF_MAX_NS)
+            delay *= 2;
+    }
+}
+
+int ra_unlock(struct remote_atomic *ra, uint64_t remote_addr, uint64_t owner) {
+    uint64_t old;
+
+    if (ra_cmp_swap(ra, remote_addr, owner, 0, &old))
+        return -1;
+    if (old != owner) {
+        printf("   ❌ Verrou 0x%lx à %lu, pas à %lu : pas libéré\n",
+               remote_addr, old, owner);
+        return -1;
+    }
+    return 0;
+}
+
+// ═══════════════════════════════════════════════════════
+// BENCHMARK : CE QUE FAIT UN THREAD
+// ═══════════════════════════════════════════════════════
+
+enum at_kind {
+    AT_FAA_SHARED,
+    AT_FAA_PRIVATE,
+    AT_CAS,
+    AT_LOCK,
+};
+
+struct at_bench {
+    enum at_kind kind;
+    uint64_t base;                  // Début de la RAM serveur
+    struct remote_atomic *ctl;      // Connexion principale : vérification
+    uint64_t last;                  // Compteur vérifié, avant le palier
+    uint64_t ops;                   // Somme des threads du palier
+    uint64_t failed;                // CAS perdus, idem
+};
+
+// FAA +1 en continu sur addr, depth en vol, tous signalés (chacun
+// rapporte une valeur, dans SON slot de conn->buf). Sur une QP RC
+// ils se terminent dans l'ordre : on lit le slot du WR k avant de
+// le réutiliser pour le WR k + depth.
+// → first / last : valeurs rapportées par le 1er et le dernier
+static int at_faa_burst(struct bench_conn *conn, uint64_t addr,
+                        const struct bench_opts *opts,
+                        struct bench_result *res,
+                        uint64_t *first, uint64_t *last) {
+    uint64_t *slots = (uint64_t *)conn->buf;
+    uint64_t depth = opts->queue_depth;
+    const long duration_ns = opts->duration_s * 1000000000L;
+    uint64_t posted = 0, completed = 0, polls = 0;
+    int running = 1;
+    struct ibv_wc wc[POLL_BATCH];
+    struct timespec start, now;
+
+    if (depth > conn->buf_size / sizeof(*slots))
+        depth = conn->buf_size / sizeof(*slots);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    while (running || completed < posted) {
+        while (running && posted - completed < depth) {
+            int ret = post_atomic(conn->qp, IBV_WR_ATOMIC_FETCH_AND_ADD,
+                                  posted, &slots[posted % depth], conn->lkey,
+                                  addr, conn->rkey, 1, 0, IBV_SEND_SIGNALED);
+            if (ret) {
+                printf("   ❌ ibv_post_send (FETCH_AND_ADD) : %s\n",
+                       strerror(ret));
+                return -1;
+            }
+            posted++;
+        }
+
+        int n = cq_wait(conn->cqw, wc, POLL_BATCH, -1);
+        polls++;
+        if (n < 0) {
+            printf("   ❌ ibv_poll_cq échoué\n");
+            return -1;
+        }
+        for (int i = 0; i < n; i++) {
+            if (wc[i].status != IBV_WC_SUCCESS) {
+                printf("   ❌ FETCH_AND_ADD échoué (status: %s, wr_id: %lu)\n",
+                       ibv_wc_status_str(wc[i].status), wc[i].wr_id);
+                return -1;
+            }
+            if (wc[i].wr_id == 0)
+                *first = slots[0];
+            *last = slots[wc[i].wr_id % depth];
+            completed = wc[i].wr_id + 1;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (elapsed_ns(&start, &now) >= duration_ns)
+            running = 0;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    res->ops = completed;
+    res->bytes = completed * sizeof(*slots);
+    res->cqes = completed;
+    res->polls = polls;
+    res->seconds = elapsed_ns(&start, &now) / 1e9;
+    return 0;
+}
+
+// Lock, compteur protégé lu puis écrit (+1) en RDMA_READ / WRITE
+// ordinaires, unlock. Sans le verrou, deux threads liraient la même
+// valeur et un +1 serait perdu.
+static int at_locked_incr(struct remote_atomic *ra, struct bench_conn *conn,
+                          uint64_t base, uint64_t owner) {
+    uint64_t *val = (uint64_t *)conn->buf + 1;     // Slot 0 : ra->result
+    struct ibv_wc wc;
+
+    int ret = ra_lock(ra, base + AT_LOCK_OFF, owner, AT_LOCK_TIMEOUT_MS);
+    if (ret > 0)
+        printf("   ❌ Verrou pas obtenu en %d ms : gardé par un thread en échec ?\n",
+               AT_LOCK_TIMEOUT_MS);
+    if (ret)
+        return -1;
+
+    if (post_rdma_op(conn->qp, IBV_WR_RDMA_READ, 0, val, sizeof(*val),
+                     conn->lkey, base + AT_GUARDED_OFF, conn->rkey,
+                     IBV_SEND_SIGNALED) ||
+        wait_wc(conn->cqw, &wc, "RDMA_READ (compteur protégé)"))
+        goto err;
+    (*val)++;
+    if (post_rdma_op(conn->qp, IBV_WR_RDMA_WRITE, 0, val, sizeof(*val),
+                     conn->lkey, base + AT_GUARDED_OFF, conn->rkey,
+                     IBV_SEND_SIGNALED) ||
+        wait_wc(conn->cqw, &wc, "RDMA_WRITE (compteur protégé)"))
+        goto err;
+
+    return ra_unlock(ra, base + AT_LOCK_OFF, owner);
+
+err:
+    ra_unlock(ra, base + AT_LOCK_OFF, owner);   // Les autres attendent
+    return -1;
+}
+
+static int at_body(struct bench_conn *conn, int idx,
+                   const struct bench_opts *opts, struct bench_result *res,
+                   void *arg) {
+    struct at_bench *b = arg;
+    struct remote_atomic ra;
+    struct timespec start, now;
+    const long duration_ns = opts->duration_s * 1000000000L;
+    uint64_t first = 0, last = 0, value = 0;
+    int ret = 0;
+
+    if (conn->remote_size < AT_SLICE_MIN || conn->buf_size < 2 * sizeof(uint64_t)) {
+        printf("   ❌ [thread %d] Tranche trop petite (serveur : %zu octets,"
+               " au moins %d)\n", idx, conn->remote_size, AT_SLICE_MIN);
+        return -1;
+    }
+    ra_init(&ra, conn->qp, conn->cqw, conn->buf, conn->lkey, conn->rkey);
+    memset(res, 0, sizeof(*res));
+
+    switch (b->kind) {
+    case AT_FAA_SHARED:
+        ret = at_faa_burst(conn, b->base + AT_SHARED_OFF, opts, res,
+                           &first, &last);
+        break;
+
+    case AT_FAA_PRIVATE: {
+        // Personne d'autre n'y touche : les valeurs rapportées se
+        // suivent, de first à first + ops - 1
+        uint64_t mine = (conn->remote_addr + conn->remote_size - 64) & ~63ULL;
+        ret = at_faa_burst(conn, mine, opts, res, &first, &last);
+        if (ret == 0 && res->ops && last != first + res->ops - 1) {
+            printf("   ❌ [thread %d] Compteur privé : +%lu pour %lu FAA\n",
+                   idx, last + 1 - first, res->ops);
+            ret = -1;
+        }
+        break;
+    }
+
+    case AT_CAS:
+    case AT_LOCK:
+        // Dépendants : un seul en vol (la réponse décide du suivant)
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        do {
+            if (b->kind == AT_CAS) {
+                // Perdu : le CAS a rapporté la valeur actuelle,
+                // pas besoin de la relire
+                uint64_t old = value;
+                ret = ra_cmp_swap(&ra, b->base + AT_SHARED_OFF, value,
+                                  value + 1, &old);
+                if (ret == 0 && old == value)
+                    res->ops++;
+                value = old == value ? value + 1 : old;
+            } else {
+                ret = at_locked_incr(&ra, conn, b->base, idx + 1);
+                if (ret == 0)
+                    res->ops++;
+            }
+            clock_gettime(CLOCK_MONOTONIC, &now);
+        } while (ret == 0 && elapsed_ns(&start, &now) < duration_ns);
+        res->bytes = res->ops * sizeof(uint64_t);
+        res->cqes = ra.ops;
+        res->polls = ra.ops;
+        res->seconds = elapsed_ns(&start, &now) / 1e9;
+        break;
+    }
+
+    __atomic_add_fetch(&b->ops, res->ops, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&b->failed, ra.cas_failed, __ATOMIC_RELAXED);
+    return ret;
+}
+
+// ═══════════════════════════════════════════════════════
+// BENCHMARK : APRÈS CHAQUE PALIER, LE COMPTE EST-IL BON ?
+// ═══════════════════════════════════════════════════════
+// Le compteur est relu par la connexion principale (FAA de 0 : une
+// lecture atomique) ; il doit avoir avancé d'exactement le nombre
+// d'opérations réussies de tous les threads.
+
+static uint64_t at_checked_addr(const struct at_bench *b) {
+    return b->base + (b->kind == AT_LOCK ? AT_GUARDED_OFF : AT_SHARED_OFF);
+}
+
+static int at_round_done(int k, void *arg) {
+    struct at_bench *b = arg;
+    uint64_t ops = b->ops, failed = b->failed;
+    uint64_t now;
+
+    b->ops = b->failed = 0;
+
+    if (b->kind == AT_CAS || b->kind == AT_LOCK)
+        printf("      🔁 %.2f CAS perdu(s) par opération (%lu au total)\n",
+               ops ? (double)failed / ops : 0.0, failed);
+
+    if (b->kind == AT_FAA_PRIVATE) {
+        printf("      ✅ %d compteur(s) privé(s) exact(s) (vérifiés par chaque"
+               " thread)\n", k);
+        return 0;
+    }
+
+    if (ra_fetch_add(b->ctl, at_checked_addr(b), 0, &now))
+        return -1;
+    uint64_t delta = now - b->last;
+    b->last = now;
+    if (delta != ops) {
+        printf("      ❌ Compteur +%lu pour %lu opérations : %s\n", delta, ops,
+               b->kind == AT_LOCK ? "le verrou a laissé passer deux threads" :
+                                    "un atomique s'est perdu");
+        return -1;
+    }
+    printf("      ✅ Compteur +%lu : exactement les opérations réussies\n", delta);
+    return 0;
+}
+
+int bench_atomics(const struct mt_opts *o, struct bench_conn *ctl) {
+    static const struct {
+        enum at_kind kind;
+        const char *name;
+        const char *what;
+    } kinds[] = {
+        { AT_FAA_SHARED,  "FAA commun", "FETCH_AND_ADD +1 sur UN compteur commun" },
+        { AT_FAA_PRIVATE, "FAA privés", "FETCH_AND_ADD +1, chacun sur SON compteur" },
+        { AT_CAS,         "CAS +1",     "COMPARE_AND_SWAP v → v + 1 sur le compteur commun" },
+        { AT_LOCK,        "verrou",     "lock, READ + WRITE du compteur protégé, unlock" },
+    };
+    struct ibv_device_attr attr;
+
+    if (ibv_query_device(o->pd->context, &attr) ||
+        attr.atomic_cap == IBV_ATOMIC_NONE) {
+        printf("   ❌ Pas d'atomiques sur cette carte\n");
+        return -1;
+    }
+    if (ctl->remote_size < AT_SLICE_MIN) {
+        printf("   ❌ RAM serveur trop petite : au moins %d octets\n", AT_SLICE_MIN);
+        return -1;
+    }
+    printf("   ⚛️  Atomiques de la carte : %s\n",
+           attr.atomic_cap == IBV_ATOMIC_GLOB ?
+           "globaux (aussi vis-à-vis des CPU)" : "entre atomiques de la carte");
+
+    // Verrou laissé pris par une exécution interrompue : rendu
+    struct remote_atomic ctl_ra;
+    uint64_t owner, old;
+    ra_init(&ctl_ra, ctl->qp, ctl->cqw, ctl->buf, ctl->lkey, ctl->rkey);
+    if (ra_fetch_add(&ctl_ra, ctl->remote_addr + AT_LOCK_OFF, 0, &owner))
+        return -1;
+    if (owner) {
+        printf("   ⚠️  Verrou pris par %lu (exécution interrompue ?) : libéré\n",
+               owner);
+        if (ra_cmp_swap(&ctl_ra, ctl->remote_addr + AT_LOCK_OFF, owner, 0, &old))
+            return -1;
+    }
+
+    for (int i = 0; i < (int)(sizeof(kinds) / sizeof(kinds[0])); i++) {
+        struct at_bench b = {
+            .kind = kinds[i].kind,
+            .base = ctl->remote_addr,
+            .ctl = &ctl_ra,
+        };
+        if (b.kind != AT_FAA_PRIVATE &&
+            ra_fetch_add(&ctl_ra, at_checked_addr(&b), 0, &b.last))
+            return -1;
+
+        printf("\n   ⚛️  %s\n", kinds[i].what);
+        struct mt_opts mopts = *o;
+        mopts.base.size = sizeof(uint64_t);
+        mopts.body = at_body;
+        mopts.round_done = at_round_done;
+        mopts.name = kinds[i].name;
+        mopts.arg = &b;
+        if (bench_threads(&mopts))
+            return -1;
+    }
+    return 0;
+}
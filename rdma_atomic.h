@@ -0,0 +1,105 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA ATOMIC - Compteurs et verrous dans la RAM du serveur
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * POURQUOI ?
+ * → Plusieurs clients qui se partagent la RAM serveur doivent se
+ *   mettre d'accord (qui prend quelle page ? bitmap d'allocation,
+ *   compteurs, verrous) SANS réveiller le CPU du serveur
+ * → READ puis WRITE ne suffit pas : deux clients lisent la même
+ *   valeur, et l'un des deux écrase l'autre
+ *
+ * DEUX OPÉRATIONS, EXÉCUTÉES PAR LA CARTE DU SERVEUR :
+ * → FETCH_AND_ADD(addr, n)        : *addr += n
+ * → COMPARE_AND_SWAP(addr, e, s)  : si *addr == e, alors *addr = s
+ * → Sur UN mot de 8 octets, aligné sur 8 ; l'ancienne valeur
+ *   revient dans 8 octets de la MR locale (comme un RDMA_READ :
+ *   compte dans les READ en vol, initiator_depth)
+ * → La RKEY doit avoir IBV_ACCESS_REMOTE_ATOMIC (INFO_ATOMIC dans
+ *   les infos du serveur, voir rdma_common.h)
+ *
+ * ⚠️ Atomiques entre eux seulement, et garantis pour ceux qui
+ * passent par la MÊME carte serveur : un RDMA_WRITE ou le CPU du
+ * serveur sur le même mot peuvent s'intercaler.
+ *
+ * CONTENTION :
+ * → Sur UN mot, la carte du serveur les exécute l'un après l'autre
+ *   (~quelques Mops/s en tout, quel que soit le nombre de clients)
+ * → Sur des mots différents, ils avancent en parallèle
+ *
+ * VERROU (spinlock) : 0 = libre, sinon numéro du propriétaire
+ * → lock   : CAS(0 → owner) jusqu'à gagner, avec un recul
+ *   exponentiel entre deux essais (sinon les perdants saturent la
+ *   carte du serveur et retardent celui qui tient le verrou)
+ * → unlock : CAS(owner → 0), qui vérifie au passage qu'on le tenait
+ */
+
+#ifndef RDMA_ATOMIC_H
+#define RDMA_ATOMIC_H
+
+#include <stdint.h>
+#include <infiniband/verbs.h>
+
+#include "rdma_cq.h"
+#include "rdma_bench.h"
+#include "rdma_mt.h"
+
+#define RA_BACKOFF_MIN_NS   200     // Recul après le 1er CAS perdu
+#define RA_BACKOFF_MAX_NS   20000   // Recul maximum (doublé à chaque échec)
+
+struct remote_atomic {
+    struct ibv_qp *qp;
+    struct cq_waiter *cqw;
+    uint64_t *result;           // 8 octets de la MR locale (alignés)
+    uint32_t lkey;
+    uint32_t rkey;
+    uint64_t seed;              // Tirage du recul (jamais 0)
+
+    uint64_t ops;               // Statistiques : atomiques complétés,
+    uint64_t cas_failed;        // CAS perdus (valeur != attendue)
+};
+
+void ra_init(struct remote_atomic *ra, struct ibv_qp *qp,
+             struct cq_waiter *cqw, void *result, uint32_t lkey,
+             uint32_t rkey);
+
+// Poste UN atomique (IBV_WR_ATOMIC_FETCH_AND_ADD : compare_add = n ;
+// IBV_WR_ATOMIC_CMP_AND_SWP : compare_add = e, swap = s), ancienne
+// valeur dans *result. Retourne le code de ibv_post_send.
+int post_atomic(struct ibv_qp *qp, enum ibv_wr_opcode opcode,
+                uint64_t wr_id, uint64_t *result, uint32_t lkey,
+                uint64_t remote_addr, uint32_t rkey,
+                uint64_t compare_add, uint64_t swap,
+                unsigned int send_flags);
+
+// Synchrones : au retour, l'opération est faite chez le serveur et
+// *old contient la valeur d'avant. Retournent 0 si l'opération a eu
+// lieu (pour un CAS : gagné si *old == expect).
+int ra_fetch_add(struct remote_atomic *ra, uint64_t remote_addr,
+                 uint64_t add, uint64_t *old);
+int ra_cmp_swap(struct remote_atomic *ra, uint64_t remote_addr,
+                uint64_t expect, uint64_t swap, uint64_t *old);
+
+// owner != 0. timeout_ms < 0 : essaie indéfiniment.
+// Retourne 0 une fois le verrou pris, 1 si timeout, -1 si erreur.
+int ra_lock(struct remote_atomic *ra, uint64_t remote_addr, uint64_t owner,
+            int timeout_ms);
+
+// Retourne -1 si le verrou n'était pas à owner (il n'est pas touché)
+int ra_unlock(struct remote_atomic *ra, uint64_t remote_addr, uint64_t owner);
+
+// ─── Benchmark ───────────────────────────────────────────
+// bench_threads (rdma_mt.h) avec 1, 2, 4, ... o->max_threads
+// threads, quatre fois :
+// → FAA sur UN compteur commun (o->base.queue_depth en vol)
+// → FAA chacun sur SON compteur (même chose, sans contention)
+// → CAS +1 sur le compteur commun (lire, proposer, réessayer)
+// → verrou : lock, READ + WRITE d'un compteur protégé, unlock
+// Chaque palier : atomiques/s, CAS perdus par opération, et le
+// compteur relu par ctl (la connexion principale) doit avoir
+// avancé d'EXACTEMENT le nombre d'opérations.
+// Les mots communs sont au début de la RAM serveur (ctl->remote_addr).
+int bench_atomics(const struct mt_opts *o, struct bench_conn *ctl);
+
+#endif /* RDMA_ATOMIC_H */
@@ -0,0 +1,115 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA BATCH - Chaînes de Work Requests (un seul "doorbell")
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * Voir rdma_batch.h
+ */
+
+#include <string.h>
+
+#include "rdma_batch.h"
+
+static int clamp_max(int max) {
+    if (max < 1)
+        return 1;
+    return max > WR_BATCH_MAX ? WR_BATCH_MAX : max;
+}
+
+// ═══════════════════════════════════════════════════════
+// SEND QUEUE
+// ═══════════════════════════════════════════════════════
+
+void send_batch_init(struct send_batch *b, struct ibv_qp *qp, int max) {
+    b->qp = qp;
+    b->max = clamp_max(max);
+    b->n = 0;
+}
+
+int send_batch_add(struct send_batch *b, enum ibv_wr_opcode opcode,
+                   uint64_t wr_id, void *local, uint32_t length,
+                   uint32_t lkey, uint64_t remote_addr, uint32_t rkey,
+                   unsigned int send_flags) {
+    struct ibv_sge *sge = &b->sge[b->n];
+    sge->addr = (uint64_t)local;
+    sge->length = length;
+    sge->lkey = lkey;
+
+    struct ibv_send_wr *wr = &b->wr[b->n];
+    memset(wr, 0, sizeof(*wr));
+    wr->wr_id = wr_id;
+    wr->sg_list = sge;
+    wr->num_sge = 1;
+    wr->opcode = opcode;
+    wr->send_flags = send_flags;
+    wr->wr.rdma.remote_addr = remote_addr;
+    wr->wr.rdma.rkey = rkey;
+
+    // Chaîner au précédent
+    if (b->n > 0)
+        b->wr[b->n - 1].next = wr;
+    b->n++;
+
+    return b->n == b->max ? send_batch_flush(b) : 0;
+}
+
+int send_batch_flush(struct send_batch *b) {
+    struct ibv_send_wr *bad_wr;
+
+    if (b->n == 0)
+        return 0;
+
+    int ret = ibv_post_send(b->qp, &b->wr[0], &bad_wr);
+    b->n = 0;
+    return ret;
+}
+
+// ═══════════════════════════════════════════════════════
+// RECEIVE QUEUE
+// ═══════════════════════════════════════════════════════
+
+void recv_batch_init(struct recv_batch *b, struct ibv_qp *qp, int max) {
+    b->qp = qp;
+    b->srq = NULL;
+    b->max = clamp_max(max);
+    b->n = 0;
+}
+
+void recv_batch_init_srq(struct recv_batch *b, struct ibv_srq *srq, int max) {
+    b->qp = NULL;
+    b->srq = srq;
+    b->max = clamp_max(max);
+    b->n = 0;
+}
+
+int recv_batch_add(struct recv_batch *b, uint64_t wr_id,
+                   void *local, uint32_t length, uint32_t lkey) {
+    struct ibv_sge *sge = &b->sge[b->n];
+    sge->addr = (uint64_t)local;
+    sge->length = length;
+    sge->lkey = lkey;
+
+    struct ibv_recv_wr *wr = &b->wr[b->n];
+    memset(wr, 0, sizeof(*wr));
+    wr->wr_id = wr_id;
+    wr->sg_list = sge;
+    wr->num_sge = 1;
+
+    if (b->n > 0)
+        b->wr[b->n - 1].next = wr;
+    b->n++;
+
+    return b->n == b->max ? recv_batch_flush(b) : 0;
+}
+
+int recv_batch_flush(struct recv_batch *b) {
+    struct ibv_recv_wr *bad_wr;
+
+    if (b->n == 0)
+        return 0;
+
+    int ret = b->srq ? ibv_post_srq_recv(b->srq, &b->wr[0], &bad_wr)
+                     : ibv_post_recv(b->qp, &b->wr[0], &bad_wr);
+    b->n = 0;
+    return ret;
+}
@@ -0,0 +1,73 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA BATCH - Chaînes de Work Requests (un seul "doorbell")
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * POURQUOI ?
+ * → Chaque ibv_post_send / ibv_post_recv finit par une écriture
+ *   MMIO dans la carte (le "doorbell") : ~100-200 ns, barrières
+ *   mémoire comprises
+ * → Un WR par appel : à quelques Mops/s, c'est le doorbell qui
+ *   limite, pas le réseau
+ *
+ * COMMENT ?
+ * → On accumule les WR dans un tableau, chaînés par wr.next
+ * → flush = UN SEUL ibv_post_send / ibv_post_recv pour toute la
+ *   chaîne : la carte lit les WR d'un coup
+ * → add() fait le flush tout seul quand la chaîne est pleine
+ *
+ * Les SGE vivent dans le batch : rien à garder de côté jusqu'au
+ * flush (les données inline sont copiées au flush).
+ */
+
+#ifndef RDMA_BATCH_H
+#define RDMA_BATCH_H
+
+#include <stdint.h>
+#include <infiniband/verbs.h>
+
+#define WR_BATCH_MAX 64     // WR max par doorbell
+
+// ─── Send Queue ──────────────────────────────────────────
+
+struct send_batch {
+    struct ibv_qp *qp;
+    int max;                // Flush automatique à max WR (1..WR_BATCH_MAX)
+    int n;                  // WR en attente de flush
+    struct ibv_send_wr wr[WR_BATCH_MAX];
+    struct ibv_sge sge[WR_BATCH_MAX];
+};
+
+void send_batch_init(struct send_batch *b, struct ibv_qp *qp, int max);
+
+// Ajoute un WR à un seul SGE (mêmes paramètres que post_rdma_op).
+// Retourne 0, ou l'erreur de ibv_post_send si un flush a échoué.
+int send_batch_add(struct send_batch *b, enum ibv_wr_opcode opcode,
+                   uint64_t wr_id, void *local, uint32_t length,
+                   uint32_t lkey, uint64_t remote_addr, uint32_t rkey,
+                   unsigned int send_flags);
+
+// Poste la chaîne (rien à faire si vide). Retourne 0 si succès.
+// En cas d'échec, les WR avant le fautif sont PARTIS quand même.
+int send_batch_flush(struct send_batch *b);
+
+// ─── Receive Queue ───────────────────────────────────────
+
+struct recv_batch {
+    struct ibv_qp *qp;
+    struct ibv_srq *srq;    // Si non NULL : on poste sur le SRQ, pas la QP
+    int max;
+    int n;
+    struct ibv_recv_wr wr[WR_BATCH_MAX];
+    struct ibv_sge sge[WR_BATCH_MAX];
+};
+
+void recv_batch_init(struct recv_batch *b, struct ibv_qp *qp, int max);
+void recv_batch_init_srq(struct recv_batch *b, struct ibv_srq *srq, int max);
+
+int recv_batch_add(struct recv_batch *b, uint64_t wr_id,
+                   void *local, uint32_t length, uint32_t lkey);
+
+int recv_batch_flush(struct recv_batch *b);
+
+#endif /* RDMA_BATCH_H */
@@ -0,0 +1,1809 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA BENCH - Outils de mesure côté client
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * Voir rdma_bench.h
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "rdma_common.h"
+#include "rdma_bench.h"
+
+const char *bench_op_name(enum bench_op op) {
+    switch (op) {
+    case BENCH_SEND:  return "SEND";
+    case BENCH_READ:  return "RDMA_READ";
+    case BENCH_WRITE: return "RDMA_WRITE";
+    }
+    return "?";
+}
+
+static enum ibv_wr_opcode bench_opcode(enum bench_op op) {
+    switch (op) {
+    case BENCH_SEND:  return IBV_WR_SEND;
+    case BENCH_READ:  return IBV_WR_RDMA_READ;
+    case BENCH_WRITE: return IBV_WR_RDMA_WRITE;
+    }
+    return IBV_WR_SEND;
+}
+
+long elapsed_ns(const struct timespec *start, const struct timespec *end) {
+    return (end->tv_sec - start->tv_sec) * 1000000000L +
+           (end->tv_nsec - start->tv_nsec);
+}
+
+// ═══════════════════════════════════════════════════════
+// HORLOGE : CALIBRATION DU TSC
+// ═══════════════════════════════════════════════════════
+// Le TSC compte des cycles de référence, pas des ns.
+// → On compte les ticks pendant ~100 ms de CLOCK_MONOTONIC
+// → ns_per_tick = durée / ticks
+// Sans "constant_tsc" + "nonstop_tsc", la fréquence peut varier
+// (économie d'énergie) : on refuse, mieux vaut CLOCK_MONOTONIC.
+
+int bench_use_tsc = 0;
+double bench_ns_per_tick = 1.0;
+
+static int cpu_has_flag(const char *flag) {
+    FILE *f = fopen("/proc/cpuinfo", "r");
+    if (!f)
+        return 0;
+
+    char line[4096];
+    int found = 0;
+    while (!found && fgets(line, sizeof(line), f)) {
+        if (strncmp(line, "flags", 5) != 0)
+            continue;
+        for (char *tok = strtok(line, " \t\n"); tok; tok = strtok(NULL, " \t\n")) {
+            if (!strcmp(tok, flag)) {
+                found = 1;
+                break;
+            }
+        }
+        break;  // Première ligne "flags" suffit
+    }
+    fclose(f);
+    return found;
+}
+
+int bench_clock_init(int use_tsc) {
+    bench_use_tsc = 0;
+    bench_ns_per_tick = 1.0;
+    if (!use_tsc)
+        return 0;
+
+#if BENCH_HAVE_TSC
+    if (!cpu_has_flag("constant_tsc") || !cpu_has_flag("nonstop_tsc")) {
+        printf("   ❌ TSC non invariant sur ce CPU (utiliser CLOCK_MONOTONIC)\n");
+        return -1;
+    }
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    uint64_t c0 = __rdtsc();
+    usleep(100000);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    uint64_t c1 = __rdtsc();
+
+    bench_ns_per_tick = (double)elapsed_ns(&t0, &t1) / (double)(c1 - c0);
+    bench_use_tsc = 1;
+    printf("   ⏱️  TSC calibré : %.3f GHz\n", 1.0 / bench_ns_per_tick);
+    return 0;
+#else
+    printf("   ❌ Pas de TSC sur cette architecture\n");
+    return -1;
+#endif
+}
+
+// ═══════════════════════════════════════════════════════
+// POSTER UN WORK REQUEST (SEND / RDMA_READ / RDMA_WRITE)
+// ═══════════════════════════════════════════════════════
+// → Un seul SGE
+// → IBV_SEND_INLINE : le contenu est copié dans le WR, la carte
+//   ne relit pas local par DMA
+// → Non signalé (send_flags = 0) : PAS de CQE, le slot de la Send
+//   Queue n'est libéré qu'avec le prochain WR signalé
+// → remote_addr / rkey ignorés par la carte pour un SEND
+
+int post_rdma_op(struct ibv_qp *qp, enum ibv_wr_opcode opcode,
+                 uint64_t wr_id, void *local, uint32_t length,
+                 uint32_t lkey, uint64_t remote_addr, uint32_t rkey,
+                 unsigned int send_flags) {
+    struct ibv_sge sge;
+    sge.addr = (uint64_t)local;
+    sge.length = length;
+    sge.lkey = lkey;
+
+    struct ibv_send_wr wr, *bad_wr;
+    memset(&wr, 0, sizeof(wr));
+    wr.wr_id = wr_id;
+    wr.sg_list = &sge;
+    wr.num_sge = 1;
+    wr.opcode = opcode;
+    wr.send_flags = send_flags;
+    wr.wr.rdma.remote_addr = remote_addr;
+    wr.wr.rdma.rkey = rkey;
+
+    return ibv_post_send(qp, &wr, &bad_wr);
+}
+
+// ═══════════════════════════════════════════════════════
+// POSTER UNE COMMANDE
+// ═══════════════════════════════════════════════════════
+// SEND_WITH_IMM sans aucun SGE : 0 octet de données,
+// tout est dans l'immediate data (ordre réseau !)
+
+int post_cmd(struct ibv_qp *qp, uint64_t wr_id, int cmd, uint32_t arg) {
+    struct ibv_send_wr wr, *bad_wr;
+    memset(&wr, 0, sizeof(wr));
+    wr.wr_id = wr_id;
+    wr.sg_list = NULL;
+    wr.num_sge = 0;
+    wr.opcode = IBV_WR_SEND_WITH_IMM;
+    wr.send_flags = IBV_SEND_SIGNALED;
+    wr.imm_data = htonl(CMD_IMM(cmd, arg));
+
+    return ibv_post_send(qp, &wr, &bad_wr);
+}
+
+// Attendre UNE complétion (spin / sommeil selon w->mode),
+// en vérifiant son statut
+int wait_wc(struct cq_waiter *w, struct ibv_wc *wc, const char *what) {
+    int n = cq_wait(w, wc, 1, -1);
+
+    if (n < 0) {
+        printf("   ❌ %s : ibv_poll_cq échoué\n", what);
+        return -1;
+    }
+    if (wc->status != IBV_WC_SUCCESS) {
+        printf("   ❌ %s échoué (status: %s)\n", what,
+               ibv_wc_status_str(wc->status));
+        return -1;
+    }
+    return 0;
+}
+
+// ═══════════════════════════════════════════════════════
+// BENCHMARK DE DÉBIT (façon ib_write_bw)
+// ═══════════════════════════════════════════════════════
+// CONCRÈTEMENT :
+// 1. On remplit la Send Queue jusqu'à queue_depth WR en vol
+// 2. Dès que des complétions arrivent, on reposte autant de WR
+// 3. Au bout de duration_s secondes : on arrête de poster,
+//    on attend les WR encore en vol, on compte
+//
+// → La carte a TOUJOURS du travail devant elle : le lien reste
+//   occupé, au lieu d'attendre un aller-retour par opération
+//
+// SIGNALISATION SÉLECTIVE :
+// → Seul 1 WR sur signal_every demande un CQE
+// → wr_id = numéro du WR : sur une QP RC, les WR se terminent
+//   DANS L'ORDRE, donc le CQE du WR k dit "0..k sont finis"
+//   → completed = k + 1, et les slots de tous ces WR sont libres
+// → Le WR qui REMPLIT la file est toujours signalé (sinon, avec
+//   queue_depth < signal_every, plus rien ne reviendrait jamais)
+// → Idem pour le dernier WR posté avant l'arrêt
+//
+// DOORBELL BATCHING :
+// → Les WR d'un remplissage sont chaînés par paquets de batch :
+//   un seul ibv_post_send (un seul doorbell) par paquet
+// → La chaîne est toujours postée avant de récolter : sinon on
+//   attendrait des WR que la carte n'a jamais vus
+//
+// Les complétions sont récoltées par paquets de POLL_BATCH.
+//
+// Les messages tournent sur des "slots" de taille size :
+// → côté local  : dans conn->buf
+// → côté serveur : dans la RAM exposée (READ/WRITE)
+// Le contenu n'a aucune importance, seul le débit compte.
+
+int bench_bw(struct bench_conn *conn, const struct bench_opts *opts,
+             struct bench_result *res) {
+    const size_t size = opts->size;
+    const size_t local_slots = conn->buf_size / size;
+    const size_t remote_slots = conn->remote_size / size;
+    const enum ibv_wr_opcode opcode = bench_opcode(opts->op);
+    const long duration_ns = opts->duration_s * 1000000000L;
+    const uint64_t depth = opts->queue_depth;
+    const uint64_t signal_every = opts->signal_every > 0 ? opts->signal_every : 1;
+    const unsigned int inl = inline_flag(conn->max_inline, opcode, size);
+
+    if (opts->op == BENCH_SEND && size > conn->max_send) {
+        printf("   ❌ SEND de %zu octets > max du serveur (%zu)\n",
+               size, conn->max_send);
+        return -1;
+    }
+
+    uint64_t posted = 0, completed = 0;
+    uint64_t signaled = 0;  // WR [0, signaled) : un CQE finira par couvrir
+    uint64_t cqes = 0, polls = 0;
+    int running = 1;
+    struct ibv_wc wc[POLL_BATCH];
+    struct timespec start, now;
+    struct send_batch sq;
+
+    send_batch_init(&sq, conn->qp, opts->batch);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    while (running || completed < posted) {
+        // 1. Remplir la Send Queue
+        while (running && posted - completed < depth) {
+            char *local = conn->buf + (posted % local_slots) * size;
+            uint64_t remote = conn->remote_addr + (posted % remote_slots) * size;
+            unsigned int flags = inl;
+
+            if ((posted + 1) % signal_every == 0 || posted + 1 - completed == depth)
+                flags |= IBV_SEND_SIGNALED;
+
+            int ret = send_batch_add(&sq, opcode, posted, local, size,
+                                     conn->lkey, remote, conn->rkey, flags);
+            if (ret) {
+                printf("   ❌ ibv_post_send (%s) : %s\n",
+                       bench_op_name(opts->op), strerror(ret));
+                return -1;
+            }
+            posted++;
+            if (flags & IBV_SEND_SIGNALED)
+                signaled = posted;
+        }
+        int ret = send_batch_flush(&sq);
+        if (ret) {
+            printf("   ❌ ibv_post_send (%s) : %s\n",
+                   bench_op_name(opts->op), strerror(ret));
+            return -1;
+        }
+
+        // 2. Récolter jusqu'à POLL_BATCH complétions (au moins une :
+        //    il y a toujours des WR en vol ici)
+        int n = cq_wait(conn->cqw, wc, POLL_BATCH, -1);
+        polls++;
+        if (n < 0) {
+            printf("   ❌ ibv_poll_cq échoué\n");
+            return -1;
+        }
+        for (int i = 0; i < n; i++) {
+            if (wc[i].status != IBV_WC_SUCCESS) {
+                printf("   ❌ %s échoué (status: %s, wr_id: %lu)\n",
+                       bench_op_name(opts->op),
+                       ibv_wc_status_str(wc[i].status), wc[i].wr_id);
+                return -1;
+            }
+            if (!(wc[i].opcode & IBV_WC_RECV)) {
+                completed = wc[i].wr_id + 1;
+                cqes++;
+            }
+        }
+
+        // 3. Temps écoulé ?
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (running && elapsed_ns(&start, &now) >= duration_ns) {
+            running = 0;
+
+            // Queue non signalée : un dernier WR signalé la couvre
+            if (signaled < posted) {
+                char *local = conn->buf + (posted % local_slots) * size;
+                uint64_t remote = conn->remote_addr + (posted % remote_slots) * size;
+
+                ret = post_rdma_op(conn->qp, opcode, posted, local, size,
+                                   conn->lkey, remote, conn->rkey,
+                                   IBV_SEND_SIGNALED | inl);
+                if (ret) {
+                    printf("   ❌ ibv_post_send (%s) : %s\n",
+                           bench_op_name(opts->op), strerror(ret));
+                    return -1;
+                }
+                signaled = ++posted;
+            }
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    res->ops = completed;
+    res->bytes = completed * size;
+    res->cqes = cqes;
+    res->polls = polls;
+    res->seconds = elapsed_ns(&start, &now) / 1e9;
+    return 0;
+}
+
+void bench_print_bw(const struct bench_opts *opts,
+                    const struct bench_result *res) {
+    double gbps = res->bytes / res->seconds / 1e9;
+    double mops = res->ops / res->seconds / 1e6;
+
+    printf("   📊 %-10s %8zu o  qd=%-4d sig=%-4d db=%-2d : %8.3f GB/s"
+           "  %8.3f Mops/s  (%lu ops en %.2f s, %.2f CQE/op, %.1f ops/poll)\n",
+           bench_op_name(opts->op), opts->size, opts->queue_depth,
+           opts->signal_every, opts->batch, gbps, mops, res->ops, res->seconds,
+           res->ops ? (double)res->cqes / res->ops : 0.0,
+           res->polls ? (double)res->ops / res->polls : 0.0);
+}
+
+// ═══════════════════════════════════════════════════════
+// DÉBIT EN FONCTION DU BATCH (doorbells)
+// ═══════════════════════════════════════════════════════
+// Même mesure que bench_bw, batch = 1, 2, 4, ... WR_BATCH_MAX.
+// → À prendre en petits messages (-s 8..64) : c'est là que le
+//   coût du doorbell domine
+// → Au-delà de queue_depth, la chaîne ne se remplit plus
+
+int bench_doorbell(struct bench_conn *conn, const struct bench_opts *opts) {
+    for (int batch = 1; batch <= WR_BATCH_MAX; batch *= 2) {
+        struct bench_opts o = *opts;
+        struct bench_result res;
+
+        o.batch = batch;
+        if (bench_bw(conn, &o, &res))
+            return -1;
+        bench_print_bw(&o, &res);
+    }
+    return 0;
+}
+
+// ═══════════════════════════════════════════════════════
+// BENCHMARK DE LATENCE (façon ib_read_lat / ib_send_lat)
+// ═══════════════════════════════════════════════════════
+// CONCRÈTEMENT :
+// → UNE opération en vol à la fois (sinon on mesure la file)
+// → warmup itérations jetées : caches, TLB, MTT de la carte
+// → chaque aller-retour va dans l'histogramme, en ns
+//
+// READ / WRITE : inline dès que size <= conn->max_inline
+// (WRITE seulement, voir rdma_common.h).
+//
+// SEND (ping-pong) : le RECV de la réponse est posté AVANT de
+// démarrer le chrono, puis PING → le CPU serveur répond → RECV.
+// Deux complétions à récolter : le SEND du PING et le RECV.
+
+int bench_lat(struct bench_conn *conn, const struct bench_opts *opts,
+              struct hist *h) {
+    const uint32_t size = opts->size;
+    const enum ibv_wr_opcode opcode = bench_opcode(opts->op);
+    struct ibv_wc wc;
+    int ret;
+
+    if (opts->op == BENCH_SEND && size > conn->max_send) {
+        printf("   ❌ SEND de %u octets > max du serveur (%zu)\n",
+               size, conn->max_send);
+        return -1;
+    }
+
+    struct ibv_sge recv_sge;
+    recv_sge.addr = (uint64_t)conn->buf;
+    recv_sge.length = size;
+    recv_sge.lkey = conn->lkey;
+
+    struct ibv_recv_wr recv_wr, *bad_recv_wr;
+    memset(&recv_wr, 0, sizeof(recv_wr));
+    recv_wr.wr_id = 0;
+    recv_wr.sg_list = &recv_sge;
+    recv_wr.num_sge = 1;
+
+    for (long i = 0; i < opts->warmup + opts->iters; i++) {
+        if (opts->op == BENCH_SEND) {
+            ret = ibv_post_recv(conn->qp, &recv_wr, &bad_recv_wr);
+            if (ret) {
+                printf("   ❌ ibv_post_recv (réponse) : %s\n", strerror(ret));
+                return -1;
+            }
+        }
+
+        uint64_t t0 = bench_now();
+
+        if (opts->op == BENCH_SEND)
+            ret = post_cmd(conn->qp, i, CMD_PING, size);
+        else
+            ret = post_rdma_op(conn->qp, opcode, i, conn->buf, size,
+                               conn->lkey, conn->remote_addr, conn->rkey,
+                               IBV_SEND_SIGNALED |
+                               inline_flag(conn->max_inline, opcode, size));
+        if (ret) {
+            printf("   ❌ ibv_post_send (%s) : %s\n",
+                   bench_op_name(opts->op), strerror(ret));
+            return -1;
+        }
+
+        int pending = (opts->op == BENCH_SEND) ? 2 : 1;
+        while (pending > 0) {
+            if (wait_wc(conn->cqw, &wc, bench_op_name(opts->op)))
+                return -1;
+            pending--;
+        }
+
+        uint64_t t1 = bench_now();
+
+        if (i >= opts->warmup)
+            hist_record(h, bench_ticks_to_ns(t1 - t0));
+    }
+    return 0;
+}
+
+void bench_print_lat(const struct bench_opts *opts, const struct hist *h) {
+    printf("   📊 %-10s %8zu o : min %7.2f  p50 %7.2f  p99 %7.2f"
+           "  p99.9 %7.2f  max %8.2f μs  (moy %.2f, %lu éch.)\n",
+           bench_op_name(opts->op), opts->size,
+           h->min / 1000.0,
+           hist_percentile(h, 50.0) / 1000.0,
+           hist_percentile(h, 99.0) / 1000.0,
+           hist_percentile(h, 99.9) / 1000.0,
+           h->max / 1000.0,
+           hist_mean(h) / 1000.0, h->total);
+}
+
+// ═══════════════════════════════════════════════════════
+// BALAYAGE DES TAILLES (1 B → toute la RAM)
+// ═══════════════════════════════════════════════════════
+// POURQUOI ?
+// → Trouver les "genoux" de la courbe sur NOTRE fabric :
+//   taille inline max, MTU (2K / 4K), saturation du lien
+// → Une ligne par (opération, taille) : facile à tracer
+//
+// La progression part sur stderr, le tableau sur sw->out :
+// "./rdma_client -S ... > resultats.csv" donne un CSV propre.
+
+static void sweep_header(const struct sweep_opts *sw) {
+    if (sw->format == SWEEP_CSV)
+        fprintf(sw->out, "op,size,lat_min_ns,lat_p50_ns,lat_p99_ns,"
+                "lat_p999_ns,lat_max_ns,lat_mean_ns,bw_gbps,bw_mops,inline\n");
+    else
+        fprintf(sw->out, "[");
+}
+
+static void sweep_row(const struct sweep_opts *sw, int first,
+                      enum bench_op op, size_t size, int inl,
+                      const struct hist *h, const struct bench_result *res) {
+    double gbps = res->bytes / res->seconds / 1e9;
+    double mops = res->ops / res->seconds / 1e6;
+
+    if (sw->format == SWEEP_CSV) {
+        fprintf(sw->out, "%s,%zu,%lu,%lu,%lu,%lu,%lu,%.1f,%.4f,%.4f,%d\n",
+                bench_op_name(op), size, h->min,
+                hist_percentile(h, 50.0), hist_percentile(h, 99.0),
+                hist_percentile(h, 99.9), h->max, hist_mean(h),
+                gbps, mops, inl);
+    } else {
+        fprintf(sw->out, "%s\n  {\"op\": \"%s\", \"size\": %zu, "
+                "\"lat_min_ns\": %lu, \"lat_p50_ns\": %lu, "
+                "\"lat_p99_ns\": %lu, \"lat_p999_ns\": %lu, "
+                "\"lat_max_ns\": %lu, \"lat_mean_ns\": %.1f, "
+                "\"bw_gbps\": %.4f, \"bw_mops\": %.4f, \"inline\": %s}",
+                first ? "" : ",", bench_op_name(op), size, h->min,
+                hist_percentile(h, 50.0), hist_percentile(h, 99.0),
+                hist_percentile(h, 99.9), h->max, hist_mean(h),
+                gbps, mops, inl ? "true" : "false");
+    }
+    fflush(sw->out);
+}
+
+int bench_sweep(struct bench_conn *conn, const struct sweep_opts *sw) {
+    static struct hist h;   // ~30 KB : pas sur la pile
+    int first = 1;
+
+    sweep_header(sw);
+
+    for (size_t size = sw->min_size; size <= sw->max_size; size *= 2) {
+        for (int i = 0; i < sw->num_ops; i++) {
+            struct bench_opts opts = sw->base;
+            opts.op = sw->ops[i];
+            opts.size = size;
+
+            if (opts.op == BENCH_SEND && size > conn->max_send) {
+                fprintf(stderr, "   ⏭️  %-10s %10zu o : > SEND max du serveur"
+                        " (%zu), sauté\n", bench_op_name(opts.op), size,
+                        conn->max_send);
+                continue;
+            }
+
+            struct bench_result res;
+            hist_init(&h);
+            if (bench_lat(conn, &opts, &h) || bench_bw(conn, &opts, &res))
+                return -1;
+
+            fprintf(stderr, "   📊 %-10s %10zu o : p50 %8.2f μs  p99 %8.2f μs"
+                    "  %8.3f GB/s\n", bench_op_name(opts.op), size,
+                    hist_percentile(&h, 50.0) / 1000.0,
+                    hist_percentile(&h, 99.0) / 1000.0,
+                    res.bytes / res.seconds / 1e9);
+
+            int inl = inline_flag(conn->max_inline,
+                                  bench_opcode(opts.op), size) != 0;
+            sweep_row(sw, first, opts.op, size, inl, &h, &res);
+            first = 0;
+        }
+        if (size > sw->max_size / 2)    // Évite le débordement de size * 2
+            break;
+    }
+
+    if (sw->format == SWEEP_JSON)
+        fprintf(sw->out, "\n]\n");
+    fflush(sw->out);
+    return 0;
+}
+
+// ═══════════════════════════════════════════════════════
+// PAGINATION DISTANTE : REJEU D'UNE TRACE
+// ═══════════════════════════════════════════════════════
+// CONCRÈTEMENT :
+// 1. On génère la trace (séquentielle ou aléatoire, graine fixe :
+//    deux lancements rejouent la MÊME trace)
+// 2. Page-out de chaque accès : la page porte son page_id dans
+//    ses 8 premiers octets
+// 3. Page-in de chaque accès : on vérifie ce page_id
+//    → une page qui revient d'ailleurs = offset mal calculé
+//
+// Une page à la fois : la latence mesurée est celle d'un défaut
+// de page servi par le réseau (ce que voit l'application).
+
+static void print_pages(const char *what, long n, uint64_t ns,
+                        const struct hist *h) {
+    double s = ns / 1e9;
+
+    printf("   📊 %-8s : %9.0f pages/s  %8.1f Mo/s  p50 %6.2f  p99 %6.2f"
+           "  max %7.2f μs\n", what, n / s, n * (double)RDMA_PAGE_SIZE / s / 1e6,
+           hist_percentile(h, 50.0) / 1000.0,
+           hist_percentile(h, 99.0) / 1000.0, h->max / 1000.0);
+}
+
+int bench_pages(struct page_store *ps, char *local, size_t local_size,
+                const struct page_bench_opts *o) {
+    static struct hist h;   // ~30 KB : pas sur la pile
+    const size_t local_pages = local_size / RDMA_PAGE_SIZE;
+    int status = -1;
+
+    if (ps->num_pages == 0 || local_pages == 0) {
+        printf("   ❌ Pas assez de RAM pour une page (locale ou distante)\n");
+        return -1;
+    }
+
+    uint64_t *trace = malloc(o->accesses * sizeof(*trace));
+    if (!trace) {
+        perror("   ❌ malloc (trace)");
+        return -1;
+    }
+    uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    for (long i = 0; i < o->accesses; i++)
+        trace[i] = o->pattern == PAGE_SEQ ? (uint64_t)i % ps->num_pages
+                                          : xorshift64(&seed) % ps->num_pages;
+
+    // 1. Page-out
+    hist_init(&h);
+    uint64_t t_start = bench_now();
+    for (long i = 0; i < o->accesses; i++) {
+        char *page = local + (i % local_pages) * RDMA_PAGE_SIZE;
+        memcpy(page, &trace[i], sizeof(trace[i]));
+
+        uint64_t t0 = bench_now();
+        if (page_out(ps, trace[i], page))
+            goto out;
+        hist_record(&h, bench_ticks_to_ns(bench_now() - t0));
+    }
+    print_pages("page-out", o->accesses,
+                bench_ticks_to_ns(bench_now() - t_start), &h);
+
+    // 2. Page-in + vérification
+    hist_init(&h);
+    t_start = bench_now();
+    for (long i = 0; i < o->accesses; i++) {
+        char *page = local + (i % local_pages) * RDMA_PAGE_SIZE;
+        uint64_t id;
+
+        uint64_t t0 = bench_now();
+        if (page_in(ps, trace[i], page))
+            goto out;
+        hist_record(&h, bench_ticks_to_ns(bench_now() - t0));
+
+        memcpy(&id, page, sizeof(id));
+        if (id != trace[i]) {
+            printf("   ❌ Page %lu : contenu de la page %lu !\n", trace[i], id);
+            goto out;
+        }
+    }
+    print_pages("page-in", o->accesses,
+                bench_ticks_to_ns(bench_now() - t_start), &h);
+    printf("   ✅ %ld pages relues et vérifiées\n", o->accesses);
+    status = 0;
+
+out:
+    free(trace);
+    return status;
+}
+
+// ═══════════════════════════════════════════════════════
+// PAGINATION VECTORISÉE : N WR CONTRE UN WR À N SGE
+// ═══════════════════════════════════════════════════════
+// Les pages d'un lot sont une sur deux du buffer local (paires à
+// l'écriture, impaires à la lecture) : rien de contigu, comme les
+// pages sales d'un processus. Chaque page porte son numéro distant
+// et le numéro du lot : une page lue à la mauvaise place, ou pas
+// rafraîchie, se voit.
+
+static void print_vec(int pages, int wr_out, int wr_in, const struct hist *out,
+                      const struct hist *in, uint64_t out_ns, uint64_t in_ns,
+                      long batches) {
+    double bytes = (double)batches * pages * RDMA_PAGE_SIZE;
+
+    printf("   │ %5d │ %2d/%-2d │ %8.2f %8.2f %7.2f │ %8.2f %8.2f %7.2f │\n",
+           pages, wr_out, wr_in,
+           hist_percentile(out, 50.0) / 1000.0,
+           hist_percentile(out, 99.0) / 1000.0, bytes / out_ns,
+           hist_percentile(in, 50.0) / 1000.0,
+           hist_percentile(in, 99.0) / 1000.0, bytes / in_ns);
+}
+
+int bench_pages_vec(struct page_store *ps, char *local, size_t local_size,
+                    const struct page_bench_opts *o) {
+    static struct hist h_out, h_in;    // ~30 KB chacun : pas sur la pile
+    const int max_sge = ps->max_sge, max_sge_rd = ps->max_sge_rd;
+    struct iovec iov_out[PAGE_IOV_MAX], iov_in[PAGE_IOV_MAX];
+    uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    int status = -1;
+
+    if (local_size / RDMA_PAGE_SIZE < 2 * PAGE_IOV_MAX ||
+        ps->num_pages < PAGE_IOV_MAX) {
+        printf("   ❌ Il faut %d pages locales et %d distantes au moins (-b)\n",
+               2 * PAGE_IOV_MAX, PAGE_IOV_MAX);
+        return -1;
+    }
+
+    printf("   SGE par WR : %d en écriture, %d en lecture (QP + carte)\n",
+           max_sge, max_sge_rd);
+    printf("   ┌───────┬───────┬────────── page-out ───────┬────────── page-in ────────┐\n");
+    printf("   │ pages │ WR o/i│   p50 μs   p99 μs    Go/s │   p50 μs   p99 μs    Go/s │\n");
+    printf("   ├───────┼───────┼───────────────────────────┼───────────────────────────┤\n");
+
+    for (int pages = 4; pages <= PAGE_IOV_MAX; pages *= 2) {
+        long batches = o->accesses / pages > 0 ? o->accesses / pages : 1;
+
+        for (int i = 0; i < pages; i++) {
+            iov_out[i].iov_base = local + (2 * i) * RDMA_PAGE_SIZE;
+            iov_out[i].iov_len = RDMA_PAGE_SIZE;
+            iov_in[i].iov_base = local + (2 * i + 1) * RDMA_PAGE_SIZE;
+            iov_in[i].iov_len = RDMA_PAGE_SIZE;
+        }
+
+        // 1 SGE par WR, puis tout ce que la QP accepte
+        for (int vec = 0; vec < 2; vec++) {
+            if (vec)
+                page_store_sge(ps, max_sge, max_sge_rd);
+            else
+                page_store_sge(ps, 1, 1);
+            uint64_t out_ns = 0, in_ns = 0;
+
+            hist_init(&h_out);
+            hist_init(&h_in);
+            for (long b = 0; b < batches; b++) {
+                uint64_t first = xorshift64(&seed) % (ps->num_pages - pages + 1);
+                for (int i = 0; i < pages; i++) {
+                    uint64_t tag[2] = { first + i, b };
+                    memcpy(iov_out[i].iov_base, tag, sizeof(tag));
+                    memset(iov_in[i].iov_base, 0, sizeof(tag));
+                }
+
+                uint64_t t0 = bench_now();
+                if (page_out_v(ps, first, iov_out, pages))
+                    goto out;
+                uint64_t t1 = bench_now();
+                if (page_in_v(ps, first, iov_in, pages))
+                    goto out;
+                uint64_t t2 = bench_now();
+                hist_record(&h_out, bench_ticks_to_ns(t1 - t0));
+                hist_record(&h_in, bench_ticks_to_ns(t2 - t1));
+                out_ns += bench_ticks_to_ns(t1 - t0);
+                in_ns += bench_ticks_to_ns(t2 - t1);
+
+                for (int i = 0; i < pages; i++) {
+                    uint64_t tag[2];
+                    memcpy(tag, iov_in[i].iov_base, sizeof(tag));
+                    if (tag[0] != first + i || tag[1] != (uint64_t)b) {
+                        printf("   ❌ Page %lu (lot %ld) : contenu de la page %lu"
+                               " du lot %lu !\n", first + i, b, tag[0], tag[1]);
+                        goto out;
+                    }
+                }
+            }
+            // WR par lot, écriture / lecture (max_sge_rd peut être
+            // plus petit que max_sge)
+            print_vec(pages, (pages + ps->max_sge - 1) / ps->max_sge,
+                      (pages + ps->max_sge_rd - 1) / ps->max_sge_rd,
+                      &h_out, &h_in, out_ns, in_ns, batches);
+        }
+    }
+    printf("   └───────┴───────┴───────────────────────────┴───────────────────────────┘\n");
+    printf("   ✅ %lu pages écrites et relues, vérifiées\n", ps->pages_in);
+    status = 0;
+
+out:
+    page_store_sge(ps, max_sge, max_sge_rd);
+    return status;
+}
+
+// ═══════════════════════════════════════════════════════
+// RÉGIONS 4K / 2M / 1G : ENREGISTREMENT + ACCÈS ALÉATOIRES
+// ═══════════════════════════════════════════════════════
+// Ce qui change avec la taille des pages (voir rdma_mem.h) :
+// → ibv_reg_mr : épingler + une entrée MTT par page
+// → Accès aléatoires sur une grande région : la carte doit
+//   traduire l'adresse LOCALE de chaque SGE ; avec des pages de
+//   4 KB son cache de traductions rate, avec 2M / 1G beaucoup moins
+//
+// Côté serveur, la même chose vaut pour les adresses distantes :
+// relancer le serveur avec -H 2m pour comparer.
+
+int bench_region(struct bench_conn *conn, struct ibv_pd *pd, size_t size,
+                 const struct bench_opts *opts) {
+    static struct hist h;   // ~30 KB : pas sur la pile
+    static const enum mem_pages kinds[] = {
+        MEM_PAGES_4K, MEM_PAGES_2M, MEM_PAGES_1G,
+    };
+    const size_t msg = opts->size;
+    const uint64_t remote_slots = conn->remote_size / msg;
+    uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    struct ibv_wc wc;
+
+    for (size_t k = 0; k < sizeof(kinds) / sizeof(kinds[0]); k++) {
+        struct mem_region r;
+        struct timespec t0, t1, t2, t3;
+
+        if (mem_region_alloc(&r, size, kinds[k])) {
+            printf("   ⏭️  Pages de %s : indisponibles, sautées\n",
+                   mem_pages_name(kinds[k]));
+            continue;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        struct ibv_mr *mr = ibv_reg_mr(pd, r.addr, r.size, IBV_ACCESS_LOCAL_WRITE);
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        if (!mr) {
+            perror("   ❌ ibv_reg_mr");
+            mem_region_free(&r);
+            return -1;
+        }
+
+        const uint64_t local_slots = r.size / msg;
+        hist_init(&h);
+        for (long i = 0; i < opts->warmup + opts->iters; i++) {
+            char *local = (char *)r.addr + (xorshift64(&seed) % local_slots) * msg;
+            uint64_t remote = conn->remote_addr +
+                              (xorshift64(&seed) % remote_slots) * msg;
+
+            uint64_t s0 = bench_now();
+            int ret = post_rdma_op(conn->qp, IBV_WR_RDMA_READ, i, local, msg,
+                                   mr->lkey, remote, conn->rkey,
+                                   IBV_SEND_SIGNALED);
+            if (ret) {
+                printf("   ❌ ibv_post_send (RDMA_READ) : %s\n", strerror(ret));
+                ibv_dereg_mr(mr);
+                mem_region_free(&r);
+                return -1;
+            }
+            if (wait_wc(conn->cqw, &wc, "RDMA_READ")) {
+                ibv_dereg_mr(mr);
+                mem_region_free(&r);
+                return -1;
+            }
+            if (i >= opts->warmup)
+                hist_record(&h, bench_ticks_to_ns(bench_now() - s0));
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &t2);
+        ibv_dereg_mr(mr);
+        clock_gettime(CLOCK_MONOTONIC, &t3);
+
+        printf("   📊 %s : %8zu pages  reg %8.2f ms  dereg %7.2f ms  |"
+               "  READ %zu o aléatoire : p50 %6.2f  p99 %6.2f  max %7.2f μs\n",
+               mem_pages_name(kinds[k]), r.size / r.page_size,
+               elapsed_ns(&t0, &t1) / 1e6, elapsed_ns(&t2, &t3) / 1e6, msg,
+               hist_percentile(&h, 50.0) / 1000.0,
+               hist_percentile(&h, 99.0) / 1000.0, h.max / 1000.0);
+        mem_region_free(&r);
+    }
+    return 0;
+}
+
+// ═══════════════════════════════════════════════════════
+// CACHE D'ENREGISTREMENTS : ZÉRO-COPIE DEPUIS L'APPLICATION
+// ═══════════════════════════════════════════════════════
+// MRC_BENCH_BUFS buffers mmap de opts->size octets, jamais
+// pré-enregistrés (ceux d'une application). Chaque transfert part
+// d'un buffer tiré au hasard, vers un offset distant aléatoire :
+// 1. sans cache : ibv_reg_mr + opération + ibv_dereg_mr
+// 2. cache, plafond = tous les buffers : que des hits après le 1er tour
+// 3. cache, plafond = la moitié : LRU + tirage uniforme ≈ 50 % de hits
+// Latence mesurée = enregistrement (ou hit) + opération.
+
+#define MRC_BENCH_BUFS 16
+
+// Un transfert depuis buf, enregistré par c (ou à la volée si NULL)
+static int mrc_transfer(struct bench_conn *conn, struct ibv_pd *pd,
+                        struct mr_cache *c, char *buf,
+                        const struct bench_opts *opts, uint64_t remote) {
+    struct ibv_mr *mr = NULL;
+    struct mrc_entry *e = NULL;
+    struct ibv_wc wc;
+    int status = -1;
+
+    if (c) {
+        e = mrc_get(c, buf, opts->size);
+        if (!e)
+            return -1;
+    } else {
+        mr = ibv_reg_mr(pd, buf, opts->size, IBV_ACCESS_LOCAL_WRITE);
+        if (!mr) {
+            perror("   ❌ ibv_reg_mr");
+            return -1;
+        }
+    }
+
+    int ret = post_rdma_op(conn->qp, bench_opcode(opts->op), 0, buf,
+                           opts->size, e ? e->mr->lkey : mr->lkey,
+                           remote, conn->rkey, IBV_SEND_SIGNALED);
+    if (ret)
+        printf("   ❌ ibv_post_send (%s) : %s\n", bench_op_name(opts->op),
+               strerror(ret));
+    else if (wait_wc(conn->cqw, &wc, bench_op_name(opts->op)) == 0)
+        status = 0;
+
+    if (e)
+        mrc_put(c, e);
+    else
+        ibv_dereg_mr(mr);
+    return status;
+}
+
+int bench_mrcache(struct bench_conn *conn, struct ibv_pd *pd,
+                  const struct bench_opts *opts) {
+    static struct hist h;   // ~30 KB : pas sur la pile
+    const size_t bsize = (opts->size + MRC_ALIGN - 1) & ~(size_t)(MRC_ALIGN - 1);
+    const uint64_t remote_slots = conn->remote_size / opts->size;
+    const size_t caps[] = { 0, MRC_BENCH_BUFS * bsize, MRC_BENCH_BUFS / 2 * bsize };
+    const char *names[] = { "sans cache", "cache (plafond = 16 buf)",
+                            "cache (plafond = 8 buf)" };
+    char *bufs[MRC_BENCH_BUFS];
+    struct mr_cache c;
+    int status = -1;
+
+    for (int i = 0; i < MRC_BENCH_BUFS; i++) {
+        bufs[i] = mmap(NULL, bsize, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+        if (bufs[i] == MAP_FAILED) {
+            perror("   ❌ mmap");
+            while (i--)
+                munmap(bufs[i], bsize);
+            return -1;
+        }
+    }
+
+    for (int pass = 0; pass < 3; pass++) {
+        uint64_t seed = 0x9E3779B97F4A7C15ULL;
+        struct mr_cache *cp = pass ? &c : NULL;
+
+        if (cp && mrc_init(cp, pd, IBV_ACCESS_LOCAL_WRITE, caps[pass]))
+            goto out;
+
+        hist_init(&h);
+        for (long i = 0; i < opts->warmup + opts->iters; i++) {
+            char *buf = bufs[xorshift64(&seed) % MRC_BENCH_BUFS];
+            uint64_t remote = conn->remote_addr +
+                              (xorshift64(&seed) % remote_slots) * opts->size;
+
+            uint64_t t0 = bench_now();
+            if (mrc_transfer(conn, pd, cp, buf, opts, remote)) {
+                if (cp)
+                    mrc_destroy(cp);
+                goto out;
+            }
+            if (i >= opts->warmup)
+                hist_record(&h, bench_ticks_to_ns(bench_now() - t0));
+        }
+
+        long regs = cp ? cp->misses : opts->warmup + opts->iters;
+        printf("   📊 %-25s : hits %5.1f %%  ibv_reg_mr %7ld  |"
+               "  p50 %7.2f  p99 %7.2f  max %8.2f μs\n",
+               names[pass], cp ? mrc_hit_rate(cp) : 0.0, regs,
+               hist_percentile(&h, 50.0) / 1000.0,
+               hist_percentile(&h, 99.0) / 1000.0, h.max / 1000.0);
+
+        // Dernier passage : un buffer rendu puis re-mappé au même
+        // endroit ne doit PAS être servi par l'ancienne MR
+        if (pass == 2) {
+            long misses = cp->misses;
+            if (mrc_munmap(cp, bufs[0], bsize) ||
+                mmap(bufs[0], bsize, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_POPULATE,
+                     -1, 0) == MAP_FAILED) {
+                perror("   ❌ munmap / mmap");
+                mrc_destroy(cp);
+                goto out;
+            }
+            if (mrc_transfer(conn, pd, cp, bufs[0], opts, conn->remote_addr)) {
+                mrc_destroy(cp);
+                goto out;
+            }
+            printf("   %s munmap + mmap : %ld entrée(s) invalidée(s), %s\n",
+                   cp->misses > misses ? "✅" : "❌", cp->invalidations,
+                   cp->misses > misses ? "ré-enregistré au transfert suivant"
+                                       : "ANCIENNE MR réutilisée !");
+        }
+        if (cp)
+            mrc_destroy(cp);
+    }
+    status = 0;
+
+out:
+    for (int i = 0; i < MRC_BENCH_BUFS; i++)
+        munmap(bufs[i], bsize);
+    return status;
+}
+
+// ═══════════════════════════════════════════════════════
+// PREMIER ACCÈS / ACCÈS CHAUD (SERVEUR EN ODP)
+// ═══════════════════════════════════════════════════════
+// Serveur lancé avec -O odp / implicit : une page de sa RAM n'existe
+// qu'après un premier accès, et c'est la CARTE qui faute.
+// → Passage 1 : RDMA_READ dans des pages jamais touchées
+// → Passage 2 : la même trace, pages maintenant résidentes
+// → Pages visitées avec un pas premier avec leur nombre : jamais
+//   deux voisines de suite (pas de pré-faute par voisinage)
+// Serveur épinglé (-O pin) : les deux passages se valent.
+
+static uint64_t gcd(uint64_t a, uint64_t b) {
+    while (b) {
+        uint64_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+static void print_touch(const char *what, const struct hist *h) {
+    printf("   📊 %-13s : moy %8.2f  p50 %8.2f  p99 %8.2f  max %9.2f μs\n",
+           what, hist_mean(h) / 1000.0, hist_percentile(h, 50.0) / 1000.0,
+           hist_percentile(h, 99.0) / 1000.0, h->max / 1000.0);
+}
+
+int bench_first_touch(struct bench_conn *conn, const struct bench_opts *opts) {
+    static struct hist first, warm;     // ~30 KB chacun : pas sur la pile
+    const uint64_t num_pages = conn->remote_size / RDMA_PAGE_SIZE;
+    const size_t msg = opts->size < RDMA_PAGE_SIZE ? opts->size : RDMA_PAGE_SIZE;
+    long n = opts->iters;
+    struct ibv_wc wc;
+
+    if ((uint64_t)n > num_pages) {
+        printf("   ⚠️  %lu pages distantes seulement : %lu accès par passage\n",
+               num_pages, num_pages);
+        n = num_pages;
+    }
+
+    // Pas ≈ 0.618 × num_pages, premier avec num_pages : chaque page
+    // au plus une fois par passage
+    uint64_t step = num_pages * 618 / 1000 | 1;
+    while (gcd(step, num_pages) != 1)
+        step += 2;
+
+    for (int pass = 0; pass < 2; pass++) {
+        struct hist *h = pass ? &warm : &first;
+        hist_init(h);
+
+        for (long i = 0; i < n; i++) {
+            uint64_t page = (uint64_t)(i + 1) * step % num_pages;
+
+            uint64_t t0 = bench_now();
+            int ret = post_rdma_op(conn->qp, IBV_WR_RDMA_READ, i, conn->buf,
+                                   msg, conn->lkey,
+                                   conn->remote_addr + page * RDMA_PAGE_SIZE,
+                                   conn->rkey, IBV_SEND_SIGNALED);
+            if (ret) {
+                printf("   ❌ ibv_post_send (RDMA_READ) : %s\n", strerror(ret));
+                return -1;
+            }
+            if (wait_wc(conn->cqw, &wc, "RDMA_READ"))
+                return -1;
+            hist_record(h, bench_ticks_to_ns(bench_now() - t0));
+        }
+    }
+
+    print_touch("premier accès", &first);
+    print_touch("accès chaud", &warm);
+    printf("   ➡️  Premier accès / chaud : x%.1f en moyenne (x1 = pages déjà "
+           "là : serveur épinglé, ou déjà touchées)\n",
+           hist_mean(&warm) > 0 ? hist_mean(&first) / hist_mean(&warm) : 0.0);
+    return 0;
+}
+
+// ═══════════════════════════════════════════════════════
+// LOI DE ZIPF
+// ═══════════════════════════════════════════════════════
+// Gray et al., "Quickly Generating Billion-Record Synthetic
+// Databases" : inverse approchée de la fonction de répartition,
+// exacte pour les rangs 0 et 1.
+
+void zipf_init(struct zipf *z, uint64_t n, double theta, uint64_t seed) {
+    double zeta2 = 1.0 + pow(0.5, theta);
+
+    z->n = n;
+    z->theta = theta;
+    z->alpha = 1.0 / (1.0 - theta);
+    z->zetan = 0.0;
+    for (uint64_t i = 1; i <= n; i++)
+        z->zetan += 1.0 / pow((double)i, theta);
+    z->eta = (1.0 - pow(2.0 / n, 1.0 - theta)) / (1.0 - zeta2 / z->zetan);
+    z->seed = seed ? seed : 0x9E3779B97F4A7C15ULL;
+}
+
+uint64_t zipf_next(struct zipf *z) {
+    double u = (xorshift64(&z->seed) >> 11) * (1.0 / 9007199254740992.0);
+    double uz = u * z->zetan;
+
+    if (uz < 1.0)
+        return 0;
+    if (uz < 1.0 + pow(0.5, z->theta))
+        return z->n > 1;
+    uint64_t r = (uint64_t)(z->n * pow(z->eta * u - z->eta + 1.0, z->alpha));
+    return r < z->n ? r : z->n - 1;
+}
+
+// ═══════════════════════════════════════════════════════
+// TABLE CLÉ-VALEUR : YCSB
+// ═══════════════════════════════════════════════════════
+// Clé = rang + 1 (la table hache déjà les clés sur les buckets :
+// les clés chaudes sont dispersées). Valeur = motif tiré de la clé,
+// le même à chaque PUT : tout GET peut être vérifié, même pendant
+// YCSB-A.
+
+static void kv_fill(uint8_t *v, uint64_t key, size_t len) {
+    for (size_t i = 0; i < len; i++)
+        v[i] = (uint8_t)(key * 31 + i);
+}
+
+// PUT avec le statut du serveur expliqué
+static int kv_bench_put(struct kv_client *kv, uint64_t key, const uint8_t *v,
+                        size_t len) {
+    int ret = kv_put(kv, key, v, len);
+    if (ret == KV_OK)
+        return 0;
+    if (ret > 0) {
+        printf("   ❌ PUT %lu (%zu o) : %s\n", key, len, kv_status_name(ret));
+        if (ret == KV_FULL || ret == KV_NO_SPACE)
+            printf("   💡 Relancer le serveur avec plus de buckets (-K) et/ou"
+                   " une RAM plus grande (-b), ou réduire -K ici\n");
+    }
+    return -1;
+}
+
+// GET vérifié (la clé doit être là, avec le bon motif)
+static int kv_bench_get(struct kv_client *kv, uint64_t key, uint8_t *v,
+                        size_t len) {
+    uint8_t want[KV_VALUE_MAX];
+    uint32_t got;
+
+    int ret = kv_get(kv, key, v, &got);
+    if (ret < 0)
+        return -1;
+    if (ret == 1) {
+        printf("   ❌ GET %lu : absente !\n", key);
+        return -1;
+    }
+    kv_fill(want, key, len);
+    if (got != len || memcmp(v, want, len)) {
+        printf("   ❌ GET %lu : %u octets, contenu faux !\n", key, got);
+        return -1;
+    }
+    return 0;
+}
+
+// ops requêtes zipf sur n clés, PUT avec la probabilité put_pct %
+static int kv_mix(struct kv_client *kv, uint64_t n, size_t len, long ops,
+                  int put_pct, struct hist *hg, struct hist *hp,
+                  uint64_t *ns) {
+    static uint8_t v[KV_VALUE_MAX];
+    struct zipf z;
+    uint64_t seed = 0xD1B54A32D192ED03ULL;
+
+    zipf_init(&z, n, ZIPF_THETA, 0);
+    hist_init(hg);
+    hist_init(hp);
+
+    uint64_t t_start = bench_now();
+    for (long i = 0; i < ops; i++) {
+        uint64_t key = zipf_next(&z) + 1;
+        int put = put_pct && (int)(xorshift64(&seed) % 100) < put_pct;
+
+        uint64_t t0 = bench_now();
+        if (put) {
+            kv_fill(v, key, len);
+            if (kv_bench_put(kv, key, v, len))
+                return -1;
+        } else if (kv_bench_get(kv, key, v, len)) {
+            return -1;
+        }
+        hist_record(put ? hp : hg, bench_ticks_to_ns(bench_now() - t0));
+    }
+    *ns = bench_ticks_to_ns(bench_now() - t_start);
+    return 0;
+}
+
+int bench_kv(struct kv_client *kv, const struct kv_bench_opts *o) {
+    static struct hist hg, hp;  // ~30 KB chacun : pas sur la pile
+    static uint8_t v[KV_VALUE_MAX];
+    static const size_t sizes[] = { 8, 64, 512, 4096 };
+    const uint64_t counts[] = { o->max_keys / 100, o->max_keys / 10, o->max_keys };
+    size_t last = 0;
+    uint64_t ns;
+
+    printf("   Table : %lu buckets x %d slots, tas de %lu octets ;"
+           " valeurs ≤ %d o dans le slot\n", kv->hdr.num_buckets,
+           KV_BUCKET_SLOTS, kv->hdr.heap_size, KV_INLINE);
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        const size_t len = sizes[s];
+        if (len > o->max_value)
+            break;
+        last = len;
+
+        // 1. Chargement : toutes les clés à cette taille
+        hist_init(&hp);
+        uint64_t t_start = bench_now();
+        for (uint64_t key = 1; key <= o->max_keys; key++) {
+            kv_fill(v, key, len);
+            uint64_t t0 = bench_now();
+            if (kv_bench_put(kv, key, v, len))
+                return -1;
+            hist_record(&hp, bench_ticks_to_ns(bench_now() - t0));
+        }
+        ns = bench_ticks_to_ns(bench_now() - t_start);
+        printf("\n   📥 %4zu o : %lu PUT, %8.1f Kops/s  p50 %6.2f  p99 %6.2f μs\n",
+               len, o->max_keys, o->max_keys / (ns / 1e9) / 1e3,
+               hist_percentile(&hp, 50.0) / 1000.0,
+               hist_percentile(&hp, 99.0) / 1000.0);
+
+        // 2. YCSB-C sur de plus en plus de clés
+        for (int c = 0; c < 3; c++) {
+            if (counts[c] == 0 || (c > 0 && counts[c] == counts[c - 1]))
+                continue;
+            uint64_t reads = kv->reads, retries = kv->retries;
+            if (kv_mix(kv, counts[c], len, o->ops, 0, &hg, &hp, &ns))
+                return -1;
+            printf("   📊 YCSB-C %9lu clés : %8.1f Kops/s  p50 %6.2f  p99 %6.2f μs"
+                   "  %.2f READ/GET  %lu relecture(s)\n", counts[c],
+                   o->ops / (ns / 1e9) / 1e3,
+                   hist_percentile(&hg, 50.0) / 1000.0,
+                   hist_percentile(&hg, 99.0) / 1000.0,
+                   (double)(kv->reads - reads) / o->ops, kv->retries - retries);
+        }
+    }
+    if (last == 0) {
+        printf("   ❌ -s trop petit : au moins %zu octets\n", sizes[0]);
+        return -1;
+    }
+
+    // 3. Avec des écritures, à la plus grande taille
+    static const struct { const char *name; int put_pct; } mixes[] = {
+        { "YCSB-B", 5 }, { "YCSB-A", 50 },
+    };
+    printf("\n");
+    for (size_t m = 0; m < sizeof(mixes) / sizeof(mixes[0]); m++) {
+        uint64_t retries = kv->retries;
+        if (kv_mix(kv, o->max_keys, last, o->ops, mixes[m].put_pct,
+                   &hg, &hp, &ns))
+            return -1;
+        printf("   📊 %s (%2d %% PUT, %4zu o) : %8.1f Kops/s  GET p50 %6.2f"
+               " p99 %6.2f  PUT p50 %6.2f p99 %6.2f μs  %lu relecture(s)\n",
+               mixes[m].name, mixes[m].put_pct, last,
+               o->ops / (ns / 1e9) / 1e3,
+               hist_percentile(&hg, 50.0) / 1000.0,
+               hist_percentile(&hg, 99.0) / 1000.0,
+               hist_percentile(&hp, 50.0) / 1000.0,
+               hist_percentile(&hp, 99.0) / 1000.0, kv->retries - retries);
+    }
+    printf("   ✅ %lu GET vérifiés (%lu RDMA_READ), %lu PUT\n",
+           kv->gets, kv->reads, kv->puts);
+    return 0;
+}
+
+// ═══════════════════════════════════════════════════════
+// MESSAGES : ANNEAU VS SEND/RECV
+// ═══════════════════════════════════════════════════════
+// Une seule boucle pour les deux chemins (ring == NULL : SEND/RECV),
+// seules changent la façon de poster / recevoir et la vérification :
+// → SEND/RECV : le serveur répond à CMD_PING avec les premiers
+//   octets de sa RAM exposée, PAS avec notre message (celui-ci est
+//   dans son puits commun, déjà repris par le SRQ). Seule la
+//   longueur de la réponse est vérifiée
+// → anneau : l'écho est le message lui-même, son numéro est vérifié
+// → Jusqu'à window requêtes en vol, réponses dans l'ordre (RC, un
+//   seul thread serveur par connexion)
+// → Autant de RECV postés que de réponses attendues, pas plus : il
+//   n'en reste aucun à la fin. Le serveur ne rend pas de crédit
+//   seul (chaque écho porte ceux des messages déjà rendus) ; si ça
+//   arrivait (petit anneau), son RECV est re-posté aussitôt.
+// → Envois signalés 1 sur RING_SIGNAL_EVERY, comme l'anneau
+
+static int echo_post_recv(struct bench_conn *conn, char *buf, size_t len,
+                          uint64_t wr_id) {
+    struct ibv_sge sge;
+    sge.addr = (uint64_t)buf;
+    sge.length = len;
+    sge.lkey = conn->lkey;
+
+    struct ibv_recv_wr wr, *bad_wr;
+    memset(&wr, 0, sizeof(wr));
+    wr.wr_id = wr_id;
+    wr.sg_list = buf ? &sge : NULL;     // Anneau : RECV de 0 octet
+    wr.num_sge = buf ? 1 : 0;
+
+    int ret = ibv_post_recv(conn->qp, &wr, &bad_wr);
+    if (ret)
+        printf("   ❌ ibv_post_recv (écho) : %s\n", strerror(ret));
+    return ret;
+}
+
+static int echo_post_ping(struct bench_conn *conn, char *msg, size_t len,
+                          uint64_t posted) {
+    struct ibv_sge sge;
+    sge.addr = (uint64_t)msg;
+    sge.length = len;
+    sge.lkey = conn->lkey;
+
+    struct ibv_send_wr wr, *bad_wr;
+    memset(&wr, 0, sizeof(wr));
+    wr.wr_id = posted;
+    wr.sg_list = &sge;
+    wr.num_sge = 1;
+    wr.opcode = IBV_WR_SEND_WITH_IMM;
+    wr.imm_data = htonl(CMD_IMM(CMD_PING, len));
+    wr.send_flags = inline_flag(conn->max_inline, IBV_WR_SEND_WITH_IMM, len);
+    if (posted % RING_SIGNAL_EVERY == 0)
+        wr.send_flags |= IBV_SEND_SIGNALED;
+
+    int ret = ibv_post_send(conn->qp, &wr, &bad_wr);
+    if (ret) {
+        printf("   ❌ ibv_post_send (PING) : %s\n", strerror(ret));
+        return -1;
+    }
+    return 0;
+}
+
+static int echo_run(struct bench_conn *conn, struct ring *ring, size_t size,
+                    int window, long n, struct hist *h, uint64_t *ns) {
+    const size_t stride = ring ? ring->slot_size : (size + 63) & ~(size_t)63;
+    char *stage = conn->buf;
+    char *replies = conn->buf + window * stride;
+    uint64_t t_post[ECHO_WINDOW_MAX];
+    struct ibv_wc wcs[POLL_BATCH];
+    long sent = 0, done = 0, recvs = 0;
+    uint64_t posted = 0;
+
+    for (; recvs < window && recvs < n; recvs++)
+        if (echo_post_recv(conn, ring ? NULL : replies + recvs * stride,
+                           size, recvs))
+            return -1;
+
+    uint64_t t_start = bench_now();
+    while (done < n) {
+        while (sent < n && sent - done < window) {
+            char *msg = stage + (sent % window) * stride +
+                        (ring ? RING_HDR_SIZE : 0);
+            if (size >= sizeof(sent))
+                memcpy(msg, &sent, sizeof(sent));
+            t_post[sent % window] = bench_now();
+            int ret = ring ? ring_post(ring, msg, size, conn->lkey)
+                           : echo_post_ping(conn, msg, size, ++posted);
+            if (ret < 0)
+                return -1;
+            if (ret > 0)
+                break;                  // Plus de crédit : une réponse d'abord
+            sent++;
+        }
+
+        int cnt = cq_wait(conn->cqw, wcs, POLL_BATCH, -1);
+        if (cnt < 0) {
+            printf("   ❌ écho : ibv_poll_cq échoué\n");
+            return -1;
+        }
+        for (int i = 0; i < cnt; i++) {
+            struct ibv_wc *wc = &wcs[i];
+            if (wc->status != IBV_WC_SUCCESS) {
+                printf("   ❌ écho échoué (status: %s)\n",
+                       ibv_wc_status_str(wc->status));
+                return -1;
+            }
+            // Nos envois (1 sur N signalé) : rien à faire
+            if (wc->opcode != IBV_WC_RECV &&
+                wc->opcode != IBV_WC_RECV_RDMA_WITH_IMM)
+                continue;
+
+            if (ring) {
+                uint32_t imm = ntohl(wc->imm_data);
+                uint32_t len;
+                if (CMD_IMM_CMD(imm) == CMD_RING_CREDIT) {
+                    ring_credit_in(ring, CMD_IMM_ARG(imm));
+                    if (echo_post_recv(conn, NULL, 0, wc->wr_id))
+                        return -1;
+                    continue;
+                }
+                char *reply = ring_recv(ring, CMD_IMM_ARG(imm), &len);
+                if (!reply)
+                    return -1;
+                if (len != size ||
+                    (size >= sizeof(done) && memcmp(reply, &done, sizeof(done)))) {
+                    printf("   ❌ Écho %ld faux (%u octets)\n", done, len);
+                    return -1;
+                }
+                if (ring_release(ring))
+                    return -1;
+            } else if (wc->byte_len != size) {
+                printf("   ❌ Réponse %ld : %u octets au lieu de %zu\n",
+                       done, wc->byte_len, size);
+                return -1;
+            }
+            if (h)
+                hist_record(h, bench_ticks_to_ns(bench_now() - t_post[done % window]));
+            done++;
+
+            if (recvs < n) {
+                if (echo_post_recv(conn, ring ? NULL : replies + wc->wr_id * stride,
+                                   size, wc->wr_id))
+                    return -1;
+                recvs++;
+            }
+        }
+    }
+    *ns = bench_ticks_to_ns(bench_now() - t_start);
+    return 0;
+}
+
+int bench_echo(struct bench_conn *conn, struct ring *ring,
+               const struct echo_opts *o) {
+    static struct hist h;   // ~30 KB : pas sur la pile
+    int window = o->window;
+    uint64_t ns;
+
+    if (window > ECHO_WINDOW_MAX)
+        window = ECHO_WINDOW_MAX;
+    if (window > (int)ring->slots)
+        window = ring->slots;
+    if (o->size == 0 || o->size > ring_max_msg(ring) || o->size > conn->max_send) {
+        printf("   ❌ Messages de 1..%u octets (slot de %u octets)\n",
+               ring_max_msg(ring), ring->slot_size);
+        return -1;
+    }
+    if (2 * (size_t)window * ring->slot_size > conn->buf_size) {
+        printf("   ❌ Buffer local trop petit : %zu octets au moins (-b)\n",
+               2 * (size_t)window * ring->slot_size);
+        return -1;
+    }
+
+    printf("   Anneau : %u slots de %u octets chez chacun, crédits rendus"
+           " avec les messages\n", ring->slots, ring->slot_size);
+    printf("   ⚠️  SEND/RECV : réponse = octets de la RAM du serveur, longueur"
+           " seule vérifiée (l'anneau vérifie chaque écho)\n");
+    printf("   %zu octets par message, fenêtre de %d pour le débit\n\n",
+           o->size, window);
+
+    for (int r = 0; r < 2; r++) {
+        struct ring *path = r ? ring : NULL;
+        const char *name = r ? "anneau" : "SEND/RECV";
+
+        if (o->warmup > 0 && echo_run(conn, path, o->size, 1, o->warmup, NULL, &ns))
+            return -1;
+
+        hist_init(&h);
+        if (echo_run(conn, path, o->size, 1, o->iters, &h, &ns))
+            return -1;
+        double lat_rate = o->iters / (ns / 1e9);
+
+        if (echo_run(conn, path, o->size, window, o->iters, NULL, &ns))
+            return -1;
+        printf("   📊 %-9s : aller-retour p50 %6.2f  p99 %6.2f  p99.9 %6.2f μs"
+               "  (%7.0f/s)  │  %6.3f Mmsg/s en fenêtre\n", name,
+               hist_percentile(&h, 50.0) / 1000.0,
+               hist_percentile(&h, 99.0) / 1000.0,
+               hist_percentile(&h, 99.9) / 1000.0,
+               lat_rate, o->iters / (ns / 1e9) / 1e6);
+    }
+    printf("   ✅ %ld échos vérifiés par l'anneau, %lu crédit(s) envoyé(s)"
+           " seul(s)\n", 2 * o->iters + o->warmup, ring->credit_msgs);
+    return 0;
+}
+
+// ═══════════════════════════════════════════════════════
+// CACHE DE PAGES : CHARGE ZIPF
+// ═══════════════════════════════════════════════════════
+// Pour chaque mélange, la MÊME trace (zipf sur toutes les pages
+// distantes, rangs éparpillés par un pas premier avec leur nombre)
+// sans cache (un page_in / page_out par accès), puis avec 1/4, 1/2
+// et tout le cache. Chaque page porte son numéro et sa version
+// (shadow[] : la dernière écrite, 0 = jamais, contenu inconnu) :
+// une écriture perdue au write-back ou un mauvais cadre se voit.
+
+struct pc_tag {
+    uint64_t page;
+    uint64_t version;
+};
+
+static int pc_check(const char *p, uint64_t page, const uint64_t *shadow) {
+    struct pc_tag t;
+    memcpy(&t, p, sizeof(t));
+    if (shadow[page] && (t.page != page || t.version != shadow[page])) {
+        printf("   ❌ Page %lu : contenu de la page %lu version %lu,"
+               " attendu version %lu !\n", page, t.page, t.version,
+               shadow[page]);
+        return -1;
+    }
+    return 0;
+}
+
+static void pc_touch(char *p, uint64_t page, uint64_t *shadow) {
+    struct pc_tag t = { page, ++shadow[page] };
+    memcpy(p, &t, sizeof(t));
+}
+
+// pc == NULL : sans cache, par scratch. z est une copie : chaque
+// ligne rejoue la même trace.
+static int pc_run(struct page_store *ps, struct page_cache *pc, char *scratch,
+                  struct zipf z, uint64_t step, long accesses, int write_pct,
+                  uint64_t *shadow, struct hist *h, struct hist *h_hit,
+                  struct hist *h_miss) {
+    uint64_t seed = 0xD1B54A32D192ED03ULL;
+
+    hist_init(h);
+    hist_init(h_hit);
+    hist_init(h_miss);
+    for (long i = 0; i < accesses; i++) {
+        uint64_t page = (zipf_next(&z) + 1) * step % ps->num_pages;
+        int write = write_pct && (int)(xorshift64(&seed) % 100) < write_pct;
+        uint64_t misses = pc ? pc->misses : 0;
+        char *p = scratch;
+
+        uint64_t t0 = bench_now();
+        if (pc) {
+            p = pcache_get(pc, page, write);
+            if (!p)
+                return -1;
+        } else if (!write && page_in(ps, page, p)) {
+            return -1;
+        }
+        if (!write && pc_check(p, page, shadow))
+            return -1;
+        if (write) {
+            if (pc && pc_check(p, page, shadow))
+                return -1;
+            pc_touch(p, page, shadow);
+            if (!pc && page_out(ps, page, p))
+                return -1;
+        }
+        uint64_t ns = bench_ticks_to_ns(bench_now() - t0);
+
+        hist_record(h, ns);
+        if (pc)
+            hist_record(pc->misses != misses ? h_miss : h_hit, ns);
+    }
+    return 0;
+}
+
+// Lecteur concurrent : pcache_lookup en boucle depuis un autre
+// thread, sa propre trace zipf, chaque page trouvée vérifiée pendant
+// qu'elle est épinglée. L'écrivain ne fait que lire : shadow est figé.
+struct pc_reader {
+    struct page_cache *pc;
+    struct zipf z;
+    uint64_t step, num_pages;
+    const uint64_t *shadow;
+    int stop;                       // Atomique : 1 = fini
+    uint64_t lookups, found;
+    int ret;
+};
+
+static void *pc_reader_run(void *arg) {
+    struct pc_reader *r = arg;
+
+    while (!__atomic_load_n(&r->stop, __ATOMIC_ACQUIRE)) {
+        uint64_t page = (zipf_next(&r->z) + 1) * r->step % r->num_pages;
+        const char *p = pcache_lookup(r->pc, page);
+        r->lookups++;
+        if (!p)
+            continue;
+        r->found++;
+        int bad = pc_check(p, page, r->shadow);
+        pcache_unpin(r->pc, p);
+        if (bad) {
+            r->ret = -1;
+            break;
+        }
+    }
+    return NULL;
+}
+
+int bench_pcache(struct page_store *ps, char *local, size_t local_size,
+                 const struct pcache_bench_opts *o) {
+    static struct hist h, h_hit, h_miss;   // ~30 KB chacun : pas sur la pile
+    static const struct { const char *name; int write_pct; } mixes[] = {
+        { "lecture seule", 0 }, { "5 % écritures", 5 }, { "50 % écritures", 50 },
+    };
+    const uint64_t max_frames = local_size / RDMA_PAGE_SIZE - 1;
+    const uint64_t sizes[] = {
+        0, o->cache_pages / 4, o->cache_pages / 2, o->cache_pages,
+    };
+    struct zipf z;
+    int status = -1;
+
+    if (ps->num_pages < 2) {
+        printf("   ❌ Il faut au moins 2 pages distantes\n");
+        return -1;
+    }
+    if (o->cache_pages < 1 || o->cache_pages > max_frames) {
+        printf("   ❌ Cache de %lu pages : il faut -b ≥ %lu octets (une page"
+               " de plus pour les accès sans cache)\n", o->cache_pages,
+               (o->cache_pages + 1) * RDMA_PAGE_SIZE);
+        return -1;
+    }
+
+    uint64_t *shadow = calloc(ps->num_pages, sizeof(*shadow));
+    if (!shadow) {
+        perror("   ❌ calloc (versions des pages)");
+        return -1;
+    }
+    uint64_t step = ps->num_pages * 618 / 1000 | 1;
+    while (gcd(step, ps->num_pages) != 1)
+        step += 2;
+    zipf_init(&z, ps->num_pages, ZIPF_THETA, 0);
+
+    printf("   Zipf θ = %.2f sur %lu pages distantes, %ld accès par ligne\n",
+           ZIPF_THETA, ps->num_pages, o->accesses);
+
+    for (size_t m = 0; m < sizeof(mixes) / sizeof(mixes[0]); m++) {
+        printf("\n   %s :\n", mixes[m].name);
+        printf("   ┌─────────────────┬────────┬─────────┬──────────┬──────── accès μs ───────┬─ hit / miss p50 ─┐\n");
+        printf("   │ cache (pages)   │ hits   │ w-backs │ Mo évités│     p50     p99   p99.9 │     hit    miss  │\n");
+        printf("   ├─────────────────┼────────┼─────────┼──────────┼─────────────────────────┼──────────────────┤\n");
+
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+            struct page_cache pc, *cache = NULL;
+            char label[32];
+
+            if (s > 0 && (sizes[s] == 0 || sizes[s] == sizes[s - 1]))
+                continue;
+            if (sizes[s]) {
+                if (pcache_init(&pc, ps, local + RDMA_PAGE_SIZE,
+                                sizes[s] * RDMA_PAGE_SIZE))
+                    goto out;
+                cache = &pc;
+            }
+
+            int ret = pc_run(ps, cache, local, z, step, o->accesses,
+                             mixes[m].write_pct, shadow, &h, &h_hit, &h_miss);
+            if (!ret && cache)
+                ret = pcache_flush(cache);
+            if (ret) {
+                if (cache)
+                    pcache_destroy(cache);
+                goto out;
+            }
+
+            if (!cache) {
+                printf("   │ %-15s │      — │       — │        — │ %7.2f %7.2f %7.2f │       —       —  │\n",
+                       "aucun", hist_percentile(&h, 50.0) / 1000.0,
+                       hist_percentile(&h, 99.0) / 1000.0,
+                       hist_percentile(&h, 99.9) / 1000.0);
+                continue;
+            }
+            snprintf(label, sizeof(label), "%lu (%.1f %%)", sizes[s],
+                     100.0 * sizes[s] / ps->num_pages);
+            printf("   │ %-15s │ %5.1f%% │ %7lu │ %8.1f │ %7.2f %7.2f %7.2f │ %7.2f %7.2f  │\n",
+                   label, 100.0 * pc.hits / o->accesses, pc.writebacks,
+                   pcache_bytes_saved(&pc) / 1e6,
+                   hist_percentile(&h, 50.0) / 1000.0,
+                   hist_percentile(&h, 99.0) / 1000.0,
+                   hist_percentile(&h, 99.9) / 1000.0,
+                   hist_percentile(&h_hit, 50.0) / 1000.0,
+                   hist_percentile(&h_miss, 50.0) / 1000.0);
+            pcache_destroy(cache);
+        }
+        printf("   └─────────────────┴────────┴─────────┴──────────┴─────────────────────────┴──────────────────┘\n");
+    }
+
+    // Lookups sans verrou pendant que ce thread rejoue la trace en
+    // lecture seule, sur un demi-cache : des évictions en continu
+    {
+        struct page_cache pc;
+        struct pc_reader r = {
+            .pc = &pc, .z = z, .step = step, .num_pages = ps->num_pages,
+            .shadow = shadow,
+        };
+        uint64_t frames = o->cache_pages / 2 ? o->cache_pages / 2 : 1;
+        pthread_t reader;
+
+        r.z.seed = 0x9E3779B97F4A7C15ULL;   // Une autre trace
+        if (pcache_init(&pc, ps, local + RDMA_PAGE_SIZE, frames * RDMA_PAGE_SIZE))
+            goto out;
+        if (pthread_create(&reader, NULL, pc_reader_run, &r)) {
+            perror("   ❌ pthread_create (lecteur)");
+            pcache_destroy(&pc);
+            goto out;
+        }
+        int ret = pc_run(ps, &pc, local, z, step, o->accesses, 0, shadow,
+                         &h, &h_hit, &h_miss);
+        __atomic_store_n(&r.stop, 1, __ATOMIC_RELEASE);
+        pthread_join(reader, NULL);
+        pcache_destroy(&pc);
+        if (ret || r.ret)
+            goto out;
+        printf("\n   ✅ Lecteur concurrent (%lu cadres) : %lu lookups, %.1f %%"
+               " trouvés et vérifiés ; écrivain p50 %.2f μs, %.1f %% hits\n",
+               frames, r.lookups, r.lookups ? 100.0 * r.found / r.lookups : 0.0,
+               hist_percentile(&h, 50.0) / 1000.0,
+               100.0 * pc.hits / o->accesses);
+    }
+
+    // Tout a été écrit chez le serveur (flush) : on relit chaque
+    // page modifiée, sans cache
+    uint64_t checked = 0;
+    for (uint64_t page = 0; page < ps->num_pages; page++) {
+        if (!shadow[page])
+            continue;
+        if (page_in(ps, page, local) || pc_check(local, page, shadow))
+            goto out;
+        checked++;
+    }
+    printf("   ✅ %lu pages modifiées relues chez le serveur, toutes à jour\n",
+           checked);
+    status = 0;
+
+out:
+    free(shadow);
+    return status;
+}
+
+// ═══════════════════════════════════════════════════════
+// PRÉCHARGEMENT : BALAYAGES
+// ═══════════════════════════════════════════════════════
+// Chaque page distante porte son numéro (écrit une fois au début,
+// par lots vectorisés) : toute page rendue par le cache est vérifiée.
+// Chaque ligne repart d'un cache froid, sur la même trace.
+
+enum pf_trace {
+    PF_TRACE_SEQ,               // 0, 1, 2, ...
+    PF_TRACE_STRIDE,            // 0, 4, 8, ...
+    PF_TRACE_STREAMS,           // 4 balayages entrelacés
+    PF_TRACE_RAND,              // Uniforme : rien à deviner
+};
+
+#define PF_BENCH_STRIDE     4
+#define PF_BENCH_STREAMS    4
+
+static uint64_t pf_trace_page(enum pf_trace t, long i, uint64_t n,
+                              uint64_t *seed) {
+    switch (t) {
+    case PF_TRACE_SEQ:
+        return (uint64_t)i % n;
+    case PF_TRACE_STRIDE:
+        return (uint64_t)i * PF_BENCH_STRIDE % n;
+    case PF_TRACE_STREAMS:
+        return ((uint64_t)(i % PF_BENCH_STREAMS) * (n / PF_BENCH_STREAMS) +
+                (uint64_t)i / PF_BENCH_STREAMS) % n;
+    default:
+        return xorshift64(seed) % n;
+    }
+}
+
+// Numéro de chaque page écrit dans la page, PAGE_IOV_MAX pages par
+// page_out_v (local : au moins une page)
+static int pf_fill(struct page_store *ps, char *local, size_t local_size) {
+    struct iovec iov[PAGE_IOV_MAX];
+    uint64_t per_call = local_size / RDMA_PAGE_SIZE;
+
+    if (per_call > PAGE_IOV_MAX)
+        per_call = PAGE_IOV_MAX;
+    for (uint64_t first = 0; first < ps->num_pages; first += per_call) {
+        int n = ps->num_pages - first < per_call ? ps->num_pages - first : per_call;
+        for (int i = 0; i < n; i++) {
+            uint64_t page = first + i;
+            iov[i].iov_base = local + (uint64_t)i * RDMA_PAGE_SIZE;
+            iov[i].iov_len = RDMA_PAGE_SIZE;
+            memcpy(iov[i].iov_base, &page, sizeof(page));
+        }
+        if (page_out_v(ps, first, iov, n))
+            return -1;
+    }
+    return 0;
+}
+
+int bench_prefetch(struct page_store *ps, char *local, size_t local_size,
+                   const struct prefetch_bench_opts *o) {
+    static struct hist h;   // ~30 KB : pas sur la pile
+    static const char *const names[] = {
+        "séquentiel", "pas de 4", "4 flux entrelacés", "aléatoire",
+    };
+    const uint64_t frames = local_size / RDMA_PAGE_SIZE;
+
+    if (ps->num_pages < PF_BENCH_STREAMS || frames < 2) {
+        printf("   ❌ Il faut %d pages distantes et 2 locales au moins\n",
+               PF_BENCH_STREAMS);
+        return -1;
+    }
+    if (ps->num_pages <= frames)
+        printf("   ⚠️  Toutes les pages distantes tiennent dans le cache :"
+               " relancer le serveur avec un -b plus grand\n");
+    printf("   Cache de %lu pages (-b), %lu pages distantes, %ld accès par"
+           " ligne, %d SGE par READ\n", frames, ps->num_pages, o->accesses,
+           ps->max_sge_rd);
+    if (pf_fill(ps, local, local_size))
+        return -1;
+
+    for (int t = PF_TRACE_SEQ; t <= PF_TRACE_RAND; t++) {
+        printf("\n   %s :\n", names[t]);
+        printf("   ┌─────────┬────────┬── accès μs ─────┬────────┬────────┬────────┬─────────┐\n");
+        printf("   │ fenêtre │  Go/s  │     p50     p99 │ hits   │ préc.  │ couv.  │ retard  │\n");
+        printf("   ├─────────┼────────┼─────────────────┼────────┼────────┼────────┼─────────┤\n");
+
+        // 0 (cache seul), 1, 4, 16, ... puis max_window
+        for (int w = 0; ; w = w ? w * 4 : 1) {
+            if (w > o->max_window)
+                w = o->max_window;
+            struct page_cache pc;
+            struct prefetcher pf;
+            uint64_t seed = 0x9E3779B97F4A7C15ULL;
+
+            if (pcache_init(&pc, ps, local, frames * RDMA_PAGE_SIZE))
+                return -1;
+            pf_init(&pf, &pc, w);
+
+            hist_init(&h);
+            uint64_t t_start = bench_now();
+            for (long i = 0; i < o->accesses; i++) {
+                uint64_t page = pf_trace_page(t, i, ps->num_pages, &seed);
+                uint64_t id;
+
+                uint64_t t0 = bench_now();
+                const char *p = pf_get(&pf, page, 0);
+                if (!p) {
+                    pcache_destroy(&pc);
+                    return -1;
+                }
+                memcpy(&id, p, sizeof(id));
+                hist_record(&h, bench_ticks_to_ns(bench_now() - t0));
+                if (id != page) {
+                    printf("   ❌ Page %lu : contenu de la page %lu !\n", page, id);
+                    pcache_destroy(&pc);
+                    return -1;
+                }
+            }
+            uint64_t ns = bench_ticks_to_ns(bench_now() - t_start);
+            if (pcache_flush(&pc)) {    // Laisse finir ce qui est en vol
+                pcache_destroy(&pc);
+                return -1;
+            }
+
+            if (w == 0)
+                printf("   │  aucune │ %6.2f │ %7.2f %7.2f │ %5.1f%% │      — │      — │       — │\n",
+                       (double)o->accesses * RDMA_PAGE_SIZE / ns,
+                       hist_percentile(&h, 50.0) / 1000.0,
+                       hist_percentile(&h, 99.0) / 1000.0,
+                       100.0 * pc.hits / o->accesses);
+            else
+                printf("   │ %7d │ %6.2f │ %7.2f %7.2f │ %5.1f%% │ %5.1f%% │ %5.1f%% │ %7lu │\n",
+                       w, (double)o->accesses * RDMA_PAGE_SIZE / ns,
+                       hist_percentile(&h, 50.0) / 1000.0,
+                       hist_percentile(&h, 99.0) / 1000.0,
+                       100.0 * pc.hits / o->accesses,
+                       100.0 * pf_accuracy(&pc), 100.0 * pf_coverage(&pc),
+                       pc.pf_late);
+            pcache_destroy(&pc);
+            if (w == o->max_window)
+                break;
+        }
+        printf("   └─────────┴────────┴─────────────────┴────────┴────────┴────────┴─────────┘\n");
+    }
+    printf("   ✅ Toutes les pages rendues par le cache vérifiées\n");
+    return 0;
+}
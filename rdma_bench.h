@@ -0,0 +1,340 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA BENCH - Outils de mesure côté client
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * Ce module contient :
+ * → Les petites fonctions pour poster un WR / attendre une complétion
+ * → L'horloge des mesures (CLOCK_MONOTONIC ou TSC)
+ * → Le benchmark de débit (façon ib_write_bw) et le benchmark de
+ *   latence (façon ib_read_lat) sur une connexion déjà établie
+ *   par rdma_client.c
+ */
+
+#ifndef RDMA_BENCH_H
+#define RDMA_BENCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include <infiniband/verbs.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC 1
+#else
+#define BENCH_HAVE_TSC 0
+#endif
+
+#include "rdma_hist.h"
+#include "rdma_batch.h"
+#include "rdma_cq.h"
+#include "rdma_page.h"
+#include "rdma_mem.h"
+#include "rdma_mrcache.h"
+#include "rdma_kv.h"
+#include "rdma_ring.h"
+#include "rdma_pcache.h"
+#include "rdma_prefetch.h"
+
+// ═══════════════════════════════════════════════════════
+// CONNEXION VUE PAR LES BENCHMARKS
+// ═══════════════════════════════════════════════════════
+// Tout ce qu'il faut pour parler au serveur, rien de plus :
+// → QP + CQ (et la façon d'y attendre, voir rdma_cq.h)
+// → Buffer local enregistré (+ LKEY)
+// → RAM serveur : adresse, taille, RKEY
+
+struct bench_conn {
+    struct ibv_qp *qp;
+    struct cq_waiter *cqw;
+
+    char *buf;              // Buffer local enregistré
+    size_t buf_size;
+    uint32_t lkey;
+
+    uint64_t remote_addr;   // RAM exposée par le serveur
+    size_t remote_size;
+    uint32_t rkey;
+    size_t max_send;        // Plus grand SEND accepté par le serveur
+    uint32_t max_inline;    // max_inline_data de notre QP (0 = jamais)
+};
+
+// Opérations mesurables
+enum bench_op {
+    BENCH_SEND,
+    BENCH_READ,
+    BENCH_WRITE,
+};
+
+struct bench_opts {
+    enum bench_op op;
+    size_t size;            // Taille d'un message (octets)
+    int queue_depth;        // Opérations en vol (1..MAX_QUEUE_DEPTH)
+    int signal_every;       // Débit : 1 WR signalé sur N (1 = tous)
+    int batch;              // Débit : WR par doorbell (1..WR_BATCH_MAX)
+    int duration_s;         // Durée de la mesure (débit)
+    long iters;             // Échantillons mesurés (latence)
+    long warmup;            // Itérations jetées avant de mesurer
+};
+
+struct bench_result {
+    uint64_t ops;           // Opérations complétées
+    uint64_t bytes;         // Octets transférés
+    uint64_t cqes;          // Complétions récoltées (côté envoi)
+    uint64_t polls;         // Appels à ibv_poll_cq
+    double seconds;         // Durée réelle
+};
+
+const char *bench_op_name(enum bench_op op);
+
+// ─── Helpers verbs ───────────────────────────────────────
+
+// Poste UN WR (SEND / RDMA_READ / RDMA_WRITE), un seul SGE
+// send_flags : IBV_SEND_SIGNALED, ou 0 pour un WR silencieux
+int post_rdma_op(struct ibv_qp *qp, enum ibv_wr_opcode opcode,
+                 uint64_t wr_id, void *local, uint32_t length,
+                 uint32_t lkey, uint64_t remote_addr, uint32_t rkey,
+                 unsigned int send_flags);
+
+// IBV_SEND_INLINE si le message tient dans max_inline, 0 sinon
+static inline unsigned int inline_flag(uint32_t max_inline,
+                                       enum ibv_wr_opcode opcode,
+                                       size_t length) {
+    if (opcode == IBV_WR_RDMA_READ || length == 0 || length > max_inline)
+        return 0;
+    return IBV_SEND_INLINE;
+}
+
+// Poste une commande (SEND_WITH_IMM de 0 octet, voir rdma_common.h)
+int post_cmd(struct ibv_qp *qp, uint64_t wr_id, int cmd, uint32_t arg);
+
+// Attend UNE complétion et vérifie son statut (0 = succès)
+int wait_wc(struct cq_waiter *w, struct ibv_wc *wc, const char *what);
+
+long elapsed_ns(const struct timespec *start, const struct timespec *end);
+
+// ─── Horloge des mesures ─────────────────────────────────
+// CLOCK_MONOTONIC : ~20 ns par lecture (vDSO), partout
+// TSC (rdtsc)     : ~7 ns par lecture, x86 avec TSC invariant
+// → bench_now() renvoie des "ticks", bench_ticks_to_ns() convertit
+
+extern int bench_use_tsc;
+extern double bench_ns_per_tick;
+
+// Choisit l'horloge et calibre le TSC. Retourne 0 si succès.
+int bench_clock_init(int use_tsc);
+
+static inline uint64_t bench_now(void) {
+#if BENCH_HAVE_TSC
+    if (bench_use_tsc)
+        return __rdtsc();
+#endif
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static inline uint64_t bench_ticks_to_ns(uint64_t ticks) {
+    return bench_use_tsc ? (uint64_t)(ticks * bench_ns_per_tick) : ticks;
+}
+
+// ─── Pseudo-aléatoire ────────────────────────────────────
+// Traces des benchmarks, recul des verrous (rapide, graine fixe,
+// jamais 0)
+static inline uint64_t xorshift64(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+// ─── Benchmarks ──────────────────────────────────────────
+
+// Débit soutenu : garde queue_depth opérations en vol pendant
+// duration_s secondes, 1 WR signalé sur signal_every, WR postés
+// par chaînes de batch, complétions récoltées par paquets de
+// POLL_BATCH. Retourne 0 si succès.
+int bench_bw(struct bench_conn *conn, const struct bench_opts *opts,
+             struct bench_result *res);
+
+// Débit pour batch = 1, 2, 4, ... WR_BATCH_MAX (le reste de opts
+// inchangé) : ops/s en fonction du nombre de WR par doorbell.
+int bench_doorbell(struct bench_conn *conn, const struct bench_opts *opts);
+
+void bench_print_bw(const struct bench_opts *opts,
+                    const struct bench_result *res);
+
+// Latence : warmup + iters opérations, UNE à la fois, chaque
+// aller-retour enregistré dans h (ns). Retourne 0 si succès.
+// → SEND : ping-pong (PING de 0 octet → réponse de size octets)
+// → READ / WRITE : jusqu'à la complétion locale (= ACK distant)
+int bench_lat(struct bench_conn *conn, const struct bench_opts *opts,
+              struct hist *h);
+
+void bench_print_lat(const struct bench_opts *opts, const struct hist *h);
+
+// ─── Balayage des tailles ────────────────────────────────
+// Pour chaque puissance de 2 de min_size à max_size, et chaque
+// opération : latence (histogramme) PUIS débit. Une ligne par
+// (opération, taille) dans out, en CSV ou JSON.
+// → Les SEND au-delà de conn->max_send sont sautés
+
+enum sweep_format {
+    SWEEP_CSV,
+    SWEEP_JSON,
+};
+
+struct sweep_opts {
+    const enum bench_op *ops;   // Opérations à mesurer
+    int num_ops;
+    size_t min_size;
+    size_t max_size;
+    struct bench_opts base;     // queue_depth, signal_every, batch,
+                                // duration_s, iters, warmup
+    enum sweep_format format;
+    FILE *out;
+};
+
+int bench_sweep(struct bench_conn *conn, const struct sweep_opts *sw);
+
+// ─── Pagination distante ─────────────────────────────────
+// Rejoue une trace d'accès aux pages : page_out de chaque page de
+// la trace, PUIS page_in de la même trace (contenu vérifié).
+// → pages/s, Mo/s, histogramme de latence par page
+// → local : buffer de la MR de ps, au moins une page
+
+enum page_pattern {
+    PAGE_SEQ,               // 0, 1, 2, ... (reboucle)
+    PAGE_RAND,              // Uniforme sur toutes les pages distantes
+};
+
+struct page_bench_opts {
+    enum page_pattern pattern;
+    long accesses;          // Longueur de la trace
+};
+
+int bench_pages(struct page_store *ps, char *local, size_t local_size,
+                const struct page_bench_opts *o);
+
+// Lots de 4, 8, ... PAGE_IOV_MAX pages locales éparpillées vers une
+// zone distante contiguë (tirée au hasard) : page_out_v puis
+// page_in_v (vérifié), d'abord 1 SGE par WR (N WR), puis avec les
+// max_sge / max_sge_rd de ps. o->accesses pages par mesure.
+// → latence par lot, Go/s, WR par lot
+// → local : 2 * PAGE_IOV_MAX pages au moins
+int bench_pages_vec(struct page_store *ps, char *local, size_t local_size,
+                    const struct page_bench_opts *o);
+
+// ─── Régions 4K / 2M / 1G ────────────────────────────────
+// Pour chaque type de pages : mmap de size octets, temps de
+// ibv_reg_mr / ibv_dereg_mr, puis latence de RDMA_READ de
+// opts->size octets à des offsets ALÉATOIRES (local et distant),
+// une à la fois. Types indisponibles (pas de huge pages) : sautés.
+int bench_region(struct bench_conn *conn, struct ibv_pd *pd, size_t size,
+                 const struct bench_opts *opts);
+
+// ─── Cache d'enregistrements ─────────────────────────────
+// Transferts (opts->op, opts->size) depuis 16 buffers NON
+// enregistrés, tirés au hasard : ibv_reg_mr / dereg à chaque fois,
+// puis via rdma_mrcache.h (plafond large, puis plafond à la moitié).
+// → taux de hits, histogramme de latence, invalidation par munmap
+int bench_mrcache(struct bench_conn *conn, struct ibv_pd *pd,
+                  const struct bench_opts *opts);
+
+// ─── Premier accès / accès chaud ─────────────────────────
+// opts->iters pages distantes distinctes lues (RDMA_READ de
+// opts->size octets) deux fois : le 1er passage paie les fautes
+// ODP du serveur (-O odp / implicit), le 2e non.
+int bench_first_touch(struct bench_conn *conn, const struct bench_opts *opts);
+
+// ─── Loi de Zipf ─────────────────────────────────────────
+// Rangs 0..n-1, le rang 0 le plus demandé (méthode de Gray et al.,
+// celle de YCSB) : P(rang i) ∝ 1 / (i+1)^theta. zipf_init est en
+// O(n) (somme zeta), zipf_next en O(1).
+
+#define ZIPF_THETA  0.99            // Valeur de YCSB
+
+struct zipf {
+    uint64_t n;
+    double theta, alpha, zetan, eta;
+    uint64_t seed;                  // Jamais 0
+};
+
+void zipf_init(struct zipf *z, uint64_t n, double theta, uint64_t seed);
+uint64_t zipf_next(struct zipf *z);
+
+// ─── Table clé-valeur (YCSB) ─────────────────────────────
+// Sur une table déjà ouverte (kv_open, serveur lancé avec -K) :
+// → Pour chaque taille de valeur (8, 64, 512, 4096 ≤ max_value) :
+//   chargement des max_keys clés (PUT), puis YCSB-C (100 % GET,
+//   zipf) sur max_keys / 100, / 10 et max_keys clés
+// → À la plus grande taille : YCSB-B (95 % GET) et YCSB-A (50 %)
+// → Kops/s, latences GET / PUT, READ par GET, relectures ; chaque
+//   valeur lue est vérifiée
+struct kv_bench_opts {
+    uint64_t max_keys;
+    size_t max_value;               // ≤ KV_VALUE_MAX
+    long ops;                       // Requêtes par mesure
+};
+
+int bench_kv(struct kv_client *kv, const struct kv_bench_opts *o);
+
+// ─── Messages : anneau vs SEND/RECV ──────────────────────
+// Écho de messages de size octets, par les deux chemins :
+// → SEND/RECV : SEND_WITH_IMM (CMD_PING) vers le puits du serveur,
+//   réponse par SEND dans un RECV posté ici avec son buffer. La
+//   réponse vient de la RAM exposée du serveur, pas de notre
+//   message : longueur vérifiée, pas le contenu
+// → anneau (rdma_ring.h) : RDMA_WRITE_WITH_IMM dans le slot
+//   suivant, le serveur renvoie le même message dans le nôtre,
+//   chaque écho est vérifié
+// Pour chacun : latence (un message à la fois, -w de chauffe) puis
+// messages/s avec window requêtes en vol.
+// conn->buf : 2 * window slots (envois + réponses SEND/RECV).
+struct echo_opts {
+    size_t size;
+    int window;                     // ≤ ECHO_WINDOW_MAX et ≤ ring->slots
+    long iters;
+    long warmup;
+};
+
+int bench_echo(struct bench_conn *conn, struct ring *ring,
+               const struct echo_opts *o);
+
+// ─── Cache de pages distantes ────────────────────────────
+// Trace zipf sur toutes les pages de ps, en lecture seule, 5 % et
+// 50 % d'écritures : sans cache, puis avec cache_pages / 4, / 2 et
+// cache_pages cadres (rdma_pcache.h), flush à la fin de chaque ligne.
+// → taux de hits, write-backs, octets évités, latence par accès
+//   (p50 des hits et des misses à part) ; pages vérifiées
+// → Puis la trace en lecture seule sur cache_pages / 2 cadres, avec
+//   un second thread en pcache_lookup (sans verrou) en même temps
+// → local : cache_pages + 1 pages de la MR de ps
+struct pcache_bench_opts {
+    uint64_t cache_pages;
+    long accesses;                  // Longueur de la trace
+};
+
+int bench_pcache(struct page_store *ps, char *local, size_t local_size,
+                 const struct pcache_bench_opts *o);
+
+// ─── Préchargement ───────────────────────────────────────
+// Toutes les pages distantes numérotées (page_out_v), puis des
+// balayages de accesses pages (séquentiel, pas de 4, 4 flux
+// entrelacés, aléatoire) à travers un cache de local_size octets
+// (rdma_pcache.h), sans préchargement puis avec une fenêtre de 1,
+// 4, 16, ... max_window pages (rdma_prefetch.h).
+// → Go/s, latence par accès, hits, précision, couverture, retards ;
+//   chaque page lue est vérifiée
+struct prefetch_bench_opts {
+    int max_window;                 // 1..PF_WINDOW_MAX
+    long accesses;
+};
+
+int bench_prefetch(struct page_store *ps, char *local, size_t local_size,
+                   const struct prefetch_bench_opts *o);
+
+#endif /* RDMA_BENCH_H */
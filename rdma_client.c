@@ -22,11 +22,154 @@
  * → Page-in  = RDMA READ depuis machine remote
  * 
  * Compilation :
- *   gcc -Wall -g -o rdma_client rdma_client.c -lrdmacm -libverbs -lpthread
+ *   gcc -Wall -g -o rdma_client rdma_client.c rdma_bench.c rdma_hist.c rdma_batch.c \
+ *       rdma_cq.c rdma_page.c rdma_mem.c rdma_pool.c rdma_mrcache.c \
+ *       rdma_numa.c rdma_mt.c rdma_connrate.c rdma_cmloop.c rdma_atomic.c \
+ *       rdma_kv.c rdma_ring.c rdma_pcache.c rdma_prefetch.c \
+ *       -lrdmacm -libverbs -lpthread -lm
  * 
  * Utilisation :
- *   ./rdma_client <server_ip>
+ *   ./rdma_client [-m send|read|write|all] [-B | -L | -S | -D | -P seq|rand | -V]
+ *                 [-s taille] [-q profondeur] [-c N] [-d N] [-t secondes]
+ *                 [-n itérations]
+ *                 [-w warmup] [-T] [-b taille] [-i octets]
+ *                 [-W poll|event|hybrid] [-u μs] [-H 4k|2m|1g] [-R] [-M] [-F]
+ *                 [-j threads] [-X] [-C connexions] [-A] [-K clés] [-E]
+ *                 [-Z taille] [-Y fenêtre] [-f csv|json] [-o fichier]
+ *                 <server_ip>
  *   Exemple : ./rdma_client 10.10.1.1
+ *             ./rdma_client -m read 10.10.1.1
+ *             ./rdma_client -B -m write -s 4096 -q 256 10.10.1.1
+ *             ./rdma_client -B -m write -s 64 -q 256 -c 32 10.10.1.1
+ *             ./rdma_client -D -m write -s 64 -q 256 10.10.1.1
+ *             ./rdma_client -P rand -n 100000 10.10.1.1
+ *             ./rdma_client -V -n 100000 10.10.1.1
+ *             ./rdma_client -Z 16M -n 1000000 10.10.1.1   (serveur en -b 1G)
+ *             ./rdma_client -Y 64 -b 16M -n 100000 10.10.1.1   (serveur en -b 1G)
+ *             ./rdma_client -R -b 1G -s 64 10.10.1.1
+ *             ./rdma_client -M -s 256K 10.10.1.1
+ *             ./rdma_client -F -n 10000 10.10.1.1   (serveur en -O odp)
+ *             ./rdma_client -j 0 -m write -s 4096 10.10.1.1
+ *             ./rdma_client -B -X -m write -s 4096 10.10.1.1
+ *             ./rdma_client -C 256 10.10.1.1
+ *             ./rdma_client -A -j 8 -t 2 10.10.1.1
+ *             ./rdma_client -K 100000 -n 200000 10.10.1.1   (serveur en -K 64K)
+ *             ./rdma_client -E -s 64 -q 32 10.10.1.1
+ *             ./rdma_client -L -m read -n 1000000 -T 10.10.1.1
+ *             ./rdma_client -S -b 64M -t 1 -f json -o sweep.json 10.10.1.1
+ *
+ * Modes (-m) :
+ *   send  → SEND/RECV classique (le CPU du serveur répond)
+ *   read  → RDMA_READ one-sided  (le CPU du serveur dort)
+ *   write → RDMA_WRITE one-sided + RDMA_READ de vérification
+ *   all   → les trois, sur la MÊME connexion (défaut) pour comparer
+ *
+ * Benchmark de débit (-B), façon ib_write_bw :
+ *   → Garde -q opérations de -s octets en vol pendant -t secondes
+ *   → Affiche GB/s et Mops/s pour chaque opération de -m
+ *   → -c : 1 WR signalé sur N (-c 1 = tous, comme avant : comparer
+ *     les Mops/s en petits messages)
+ *   → -d : WR chaînés par ibv_post_send (un doorbell par chaîne)
+ *
+ * Débit selon le batch (-D) :
+ *   → -B répété pour -d = 1, 2, 4, ... 64 : Mops/s par doorbell
+ *
+ * Benchmark de latence (-L), façon ib_read_lat :
+ *   → -w itérations de chauffe puis -n échantillons, une opération à la fois
+ *   → Histogramme HDR (ns) : min / p50 / p99 / p99.9 / max
+ *   → -T : chronomètre TSC (rdtsc) au lieu de CLOCK_MONOTONIC
+ *
+ * Pagination distante (-P), façon InfiniSwap :
+ *   → La RAM serveur = un tableau de pages de 4 KB (rdma_page.h)
+ *   → Trace de -n accès séquentielle ou aléatoire : page_out de
+ *     chaque accès puis page_in (vérifié), pages/s + latences
+ *
+ * Pagination vectorisée (-V), voir rdma_page.h :
+ *   → Lots de 4 à 64 pages locales éparpillées ↔ une zone distante
+ *     contiguë : N WR d'un SGE contre ⌈N / max_sge⌉ WR à plusieurs
+ *     SGE (max_sge : ibv_query_device), -n pages par mesure
+ *
+ * Cache de pages distantes (-Z taille), voir rdma_pcache.h :
+ *   → Les pages lues / écrites restent dans -Z octets du buffer
+ *     local (-b agrandi si besoin) : CLOCK, write-back des pages sales
+ *   → Trace zipf de -n accès, lecture seule, 5 % et 50 % d'écritures,
+ *     sans cache puis avec 1/4, 1/2 et tout le cache
+ *   → Taux de hits, write-backs, Mo évités, latences (hits / misses)
+ *
+ * Préchargement (-Y fenêtre), voir rdma_prefetch.h :
+ *   → Balayages de -n pages (séquentiel, pas de 4, 4 flux, aléatoire)
+ *     à travers un cache de -b octets ; les flux détectés sont
+ *     préchargés par RDMA_READ asynchrones, jusqu'à fenêtre pages
+ *     d'avance (≤ 64)
+ *   → Go/s et latences pour une fenêtre de 0, 1, 4, ... fenêtre :
+ *     le débit d'un balayage doit s'approcher de celui du lien (-B)
+ *   → Précision, couverture, préchargements arrivés en retard
+ *
+ * Pages du buffer local (-H) et comparaison (-R) :
+ *   → -H 2m / 1g : buffer local en huge pages (voir rdma_mem.h)
+ *   → -R : pour 4K, 2M et 1G, temps de ibv_reg_mr sur -b octets et
+ *     latence de RDMA_READ à des offsets aléatoires
+ *
+ * Cache d'enregistrements (-M), voir rdma_mrcache.h :
+ *   → RDMA_WRITE de -s octets depuis 16 buffers non enregistrés :
+ *     ibv_reg_mr à chaque transfert, puis via le cache (LRU, plafond)
+ *   → Taux de hits + latence, et invalidation par munmap vérifiée
+ *
+ * Premier accès / accès chaud (-F), pour un serveur en ODP (-O) :
+ *   → RDMA_READ dans -n pages distantes jamais touchées, puis les mêmes
+ *   → L'écart = le prix d'une faute de page côté carte du serveur
+ *
+ * Débit multi-threads (-j N), voir rdma_mt.h :
+ *   → N connexions, chacune avec SA QP, SA CQ et SA tranche de -b,
+ *     sur le même PD ; un thread par connexion, épinglé sur un cœur
+ *     du nœud NUMA de la carte (-j 0 : autant que de cœurs)
+ *   → -B avec 1, 2, 4, ... N threads : débit total et par thread
+ *
+ * Connexions par seconde (-C N), voir rdma_connrate.h :
+ *   → N connexions une à une, puis N en même temps sur un seul
+ *     canal CM, PD et CQ partagés
+ *   → connexions/s, temps de connect et jusqu'au 1er octet lu
+ *
+ * Atomiques distants (-A), voir rdma_atomic.h :
+ *   → FETCH_AND_ADD / COMPARE_AND_SWAP exécutés par la carte du
+ *     serveur : compteurs et verrous sans son CPU
+ *   → Avec 1, 2, 4, ... -j threads (une QP chacun) : FAA sur UN
+ *     compteur puis chacun sur le sien, CAS +1, verrou (spinlock)
+ *   → atomiques/s, CAS perdus par opération, compteur vérifié
+ *
+ * Table clé-valeur (-K N), voir rdma_kv.h, serveur lancé avec -K :
+ *   → GET = RDMA_READ du bucket (+ de la valeur si > 32 o), sans le
+ *     CPU du serveur ; PUT = RDMA_WRITE_WITH_IMM + réponse
+ *   → N clés chargées par taille de valeur (8 ... -s), puis YCSB-C
+ *     (zipf) sur N/100, N/10 et N clés, enfin YCSB-B et YCSB-A
+ *   → Kops/s, p50 / p99, READ par GET, relectures ; valeurs vérifiées
+ *
+ * Messages par anneau (-E), voir rdma_ring.h :
+ *   → Chaque côté a un anneau dans la MR de l'autre : messages de -s
+ *     octets par RDMA_WRITE_WITH_IMM, crédits rendus avec le trafic
+ *   → Écho comparé au chemin SEND/RECV (CMD_PING) : latence (-n
+ *     allers-retours) puis messages/s avec -q requêtes en vol (≤ 64)
+ *
+ * Placement NUMA (rdma_numa.h) :
+ *   → Buffers, CQ et thread de polling sur le nœud de la carte
+ *   → -X : sur un AUTRE nœud, exprès, pour mesurer la pénalité
+ *     (à comparer avec la même commande sans -X)
+ *
+ * Attente des complétions (-W) :
+ *   → poll   : spin pur (défaut, ce que mesurent les benchmarks)
+ *   → event  : dort sur le completion channel à chaque attente
+ *   → hybrid : spin pendant -u μs, puis dort (voir rdma_cq.h)
+ *
+ * SEND inline (-i) :
+ *   → Les SEND / RDMA_WRITE de moins de -i octets sont copiés dans
+ *     le WR (IBV_SEND_INLINE) : pas de relecture DMA du buffer
+ *   → -i 0 les désactive : comparer "-L -s 64" avec et sans
+ *
+ * Balayage des tailles (-S) :
+ *   → -L puis -B pour 1, 2, 4, ... octets jusqu'à min(-b, RAM serveur)
+ *   → Tableau CSV ou JSON (-f) dans -o : repérer les "genoux"
+ *     (inline, MTU, saturation du lien)
+ *   → Lancer le serveur avec le même -b pour aller au-delà de 1 MB
  */
 
 #include <stdio.h>
@@ -38,33 +181,409 @@
 #include <time.h>
 #include <rdma/rdma_cma.h>
 
-#define BUFFER_SIZE 1024*1024  // 1 MB
+#include "rdma_common.h"
+#include "rdma_bench.h"
+#include "rdma_pool.h"
+#include "rdma_mrcache.h"
+#include "rdma_mt.h"
+#include "rdma_numa.h"
+#include "rdma_connrate.h"
+#include "rdma_cmloop.h"
+#include "rdma_atomic.h"
+#include "rdma_kv.h"
+#include "rdma_ring.h"
 
-// Buffers statiques - pré-alloués et alignés  
-static char recv_buffer_static[1024*1024] __attribute__((aligned(4096)));
-static char rdma_buffer_static[1024*1024] __attribute__((aligned(4096)));
+// Modes de transfert (combinables)
+#define MODE_SEND  0x1
+#define MODE_READ  0x2
+#define MODE_WRITE 0x4
+#define MODE_ALL   (MODE_SEND | MODE_READ | MODE_WRITE)
 
-// Structure pour recevoir les infos RDMA du serveur
-struct rdma_buffer_info {
-    uint64_t addr;      // Adresse de la RAM serveur
-    uint32_t rkey;      // Clé d'accès RDMA
+// Message écrit dans la RAM serveur par RDMA_WRITE
+#define CLIENT_MSG "Hello from Client! Written with RDMA_WRITE."
+
+// Valeurs par défaut du benchmark de débit (-B)
+#define BW_DEFAULT_SIZE     65536
+#define BW_DEFAULT_DEPTH    128
+#define BW_DEFAULT_DURATION 5
+#define BW_DEFAULT_SIGNAL   16      // 1 WR signalé sur 16
+#define BW_DEFAULT_BATCH    16      // 16 WR par doorbell
+#define DB_DEFAULT_SIZE     64      // -D : petits messages
+
+// Valeurs par défaut du benchmark de latence (-L)
+#define LAT_DEFAULT_SIZE    8
+#define LAT_DEFAULT_ITERS   100000
+#define LAT_DEFAULT_WARMUP  1000
+
+// Correspondance -m → opérations de benchmark
+static const struct { int flag; enum bench_op op; } bench_ops[] = {
+    { MODE_SEND,  BENCH_SEND  },
+    { MODE_READ,  BENCH_READ  },
+    { MODE_WRITE, BENCH_WRITE },
 };
+#define NUM_BENCH_OPS (int)(sizeof(bench_ops) / sizeof(bench_ops[0]))
+
+static void usage(const char *prog) {
+    printf("Usage: %s [-m send|read|write|all] [-B | -L | -S | -D | -P seq|rand | -V]\n"
+           "          [-s taille] [-q profondeur] [-c N] [-d N] [-t secondes]\n"
+           "          [-n itérations]\n"
+           "          [-w warmup] [-T] [-b taille] [-i octets]\n"
+           "          [-W poll|event|hybrid] [-u μs] [-H 4k|2m|1g] [-R] [-M] [-F]\n"
+           "          [-j threads] [-X] [-C connexions] [-A] [-K clés] [-E]\n"
+           "          [-Z taille] [-Y fenêtre] [-f csv|json] [-o fichier]"
+           " <server_ip>\n", prog);
+    printf("  -m  opération(s) à exécuter (défaut : all)\n");
+    printf("  -B  benchmark de débit au lieu de la démo\n");
+    printf("  -L  benchmark de latence (histogramme) au lieu de la démo\n");
+    printf("  -S  balayage des tailles : latence + débit, de 1 o à tout le buffer\n");
+    printf("  -D  débit pour -d = 1, 2, 4, ... %d WR par doorbell\n", WR_BATCH_MAX);
+    printf("  -P  pagination : trace de -n accès seq ou rand, page-out puis page-in\n");
+    printf("  -V  pagination par lots de 4..%d pages : N WR contre un WR à N SGE\n",
+           PAGE_IOV_MAX);
+    printf("  -s  taille des messages en octets (défaut : %d en -B, %d en -L,"
+           " %d en -D)\n", BW_DEFAULT_SIZE, LAT_DEFAULT_SIZE, DB_DEFAULT_SIZE);
+    printf("  -q  opérations en vol, 1..%d (défaut : %d)\n",
+           MAX_QUEUE_DEPTH, BW_DEFAULT_DEPTH);
+    printf("  -c  débit : 1 WR signalé sur N, 1..%d (défaut : %d, 1 = tous)\n",
+           MAX_QUEUE_DEPTH, BW_DEFAULT_SIGNAL);
+    printf("  -d  débit : WR postés par doorbell, 1..%d (défaut : %d)\n",
+           WR_BATCH_MAX, BW_DEFAULT_BATCH);
+    printf("  -t  durée de chaque mesure de débit en secondes (défaut : %d)\n",
+           BW_DEFAULT_DURATION);
+    printf("  -n  échantillons de latence / accès -P (défaut : %d)\n",
+           LAT_DEFAULT_ITERS);
+    printf("  -w  itérations de chauffe non mesurées (défaut : %d)\n",
+           LAT_DEFAULT_WARMUP);
+    printf("  -T  chronométrer avec le TSC (rdtsc) au lieu de CLOCK_MONOTONIC\n");
+    printf("  -b  taille du buffer local (défaut : 1M, suffixes K/M/G)\n");
+    printf("  -i  SEND/WRITE inline jusqu'à N octets (défaut : %d, 0 = jamais)\n",
+           INLINE_DEFAULT);
+    printf("  -W  attente des complétions : poll (défaut), event ou hybrid\n");
+    printf("  -u  hybrid : spin avant de dormir, en μs (défaut : %d)\n",
+           CQ_SPIN_DEFAULT_US);
+    printf("  -H  pages du buffer local : 4k (défaut), 2m ou 1g\n");
+    printf("  -R  compare 4K / 2M / 1G : enregistrement + READ aléatoires\n");
+    printf("  -M  cache d'enregistrements : WRITE depuis des buffers non enregistrés\n");
+    printf("  -F  READ dans -n pages serveur : premier accès puis accès chaud (ODP)\n");
+    printf("  -j  débit avec 1, 2, 4, ... N threads, une QP/CQ chacun"
+           " (0 = cœurs du nœud NUMA de la carte)\n");
+    printf("  -X  buffers, CQ et threads sur un AUTRE nœud NUMA que la carte\n");
+    printf("  -C  connexions/s et 1er octet : N connexions une à une puis"
+           " ensemble (max %d)\n", CONNRATE_MAX);
+    printf("  -A  atomiques : FAA, CAS et verrou avec 1, 2, 4, ... -j threads\n");
+    printf("  -K  table clé-valeur du serveur (-K chez lui aussi) : YCSB sur"
+           " N clés, valeurs jusqu'à -s (défaut : %d)\n", KV_VALUE_MAX);
+    printf("  -E  écho par anneau RDMA_WRITE_WITH_IMM comparé à SEND/RECV"
+           " (-q ≤ %d en vol)\n", ECHO_WINDOW_MAX);
+    printf("  -Z  cache local de pages distantes de N octets (CLOCK, write-back)"
+           " : trace zipf de -n accès\n");
+    printf("  -Y  préchargement séquentiel / à pas devant un cache de -b"
+           " octets, fenêtre 1..%d pages\n", PF_WINDOW_MAX);
+    printf("  -f  format du tableau -S : csv (défaut) ou json\n");
+    printf("  -o  fichier du tableau -S (défaut : sortie standard)\n");
+    printf("Exemple: %s 10.10.1.1\n", prog);
+    printf("         %s -m read 10.10.1.1\n", prog);
+    printf("         %s -B -m write -s 4096 -q 256 10.10.1.1\n", prog);
+    printf("         %s -B -m write -s 64 -q 256 -c 32 10.10.1.1\n", prog);
+    printf("         %s -D -m write -s 64 -q 256 10.10.1.1\n", prog);
+    printf("         %s -P rand -n 100000 10.10.1.1\n", prog);
+    printf("         %s -V -n 100000 10.10.1.1\n", prog);
+    printf("         %s -Z 16M -n 1000000 10.10.1.1\n", prog);
+    printf("         %s -Y 64 -b 16M -n 100000 10.10.1.1\n", prog);
+    printf("         %s -R -b 1G -s 64 10.10.1.1\n", prog);
+    printf("         %s -M -s 256K 10.10.1.1\n", prog);
+    printf("         %s -F -n 10000 10.10.1.1\n", prog);
+    printf("         %s -j 0 -m write -s 4096 10.10.1.1\n", prog);
+    printf("         %s -B -X -m write -s 4096 10.10.1.1\n", prog);
+    printf("         %s -C 256 10.10.1.1\n", prog);
+    printf("         %s -A -j 8 -t 2 10.10.1.1\n", prog);
+    printf("         %s -K 100000 -n 200000 10.10.1.1\n", prog);
+    printf("         %s -E -s 64 -q 32 10.10.1.1\n", prog);
+    printf("         %s -L -m read -n 1000000 -T 10.10.1.1\n", prog);
+    printf("         %s -S -b 64M -t 1 -n 10000 -f json -o sweep.json 10.10.1.1\n", prog);
+}
+
+// Les étapes 4-5 s'enchaînent dans la machine à états (rdma_cmloop.h) :
+// on raconte au passage
+static void on_cm_state(struct cm_conn *c) {
+    switch (c->state) {
+    case CM_ROUTE:
+        printf("   ✅ Adresse résolue\n\n");
+        printf("🗺️  ÉTAPE 5 : Résolution route InfiniBand\n");
+        printf("   (Trouver le chemin physique vers le serveur)\n");
+        break;
+    case CM_ROUTED:
+        printf("   ✅ Route résolue\n\n");
+        break;
+    default:
+        break;
+    }
+}
 
 int main(int argc, char *argv[]) {
     struct rdma_buffer_info server_info;
     struct ibv_wc wc;
+    int mode = MODE_ALL;
+    int bw_mode = 0;
+    int lat_mode = 0;
+    int sweep_mode = 0;
+    int doorbell_mode = 0;
+    int page_mode = 0;
+    int vec_mode = 0;               // -V : pages par lots (multi-SGE)
+    int region_mode = 0;
+    int mrcache_mode = 0;
+    int touch_mode = 0;
+    int max_threads = -1;           // -j : -1 = pas de multi-threads
+    int numa_cross = 0;             // -X : nœud NUMA distant, exprès
+    int conn_count = 0;             // -C : 0 = pas de mesure des connexions
+    int atomic_mode = 0;            // -A : atomiques (threads : -j)
+    uint64_t kv_keys = 0;           // -K : 0 = pas de table clé-valeur
+    int echo_mode = 0;              // -E : anneau vs SEND/RECV
+    size_t cache_size = 0;          // -Z : 0 = pas de cache de pages
+    int pf_window = 0;              // -Y : 0 = pas de préchargement
+    enum mem_pages local_pages = MEM_PAGES_4K;
+    enum page_pattern page_pattern = PAGE_SEQ;
+    size_t msg_size = 0;            // 0 = défaut selon le mode
+    size_t buf_size = BUFFER_SIZE;
+    enum sweep_format sweep_format = SWEEP_CSV;
+    const char *sweep_path = NULL;
+    int queue_depth = BW_DEFAULT_DEPTH;
+    int duration_s = BW_DEFAULT_DURATION;
+    int signal_every = BW_DEFAULT_SIGNAL;
+    int batch = BW_DEFAULT_BATCH;
+    int inline_size = INLINE_DEFAULT;
+    enum cq_mode cq_mode = CQ_MODE_POLL;
+    int spin_us = CQ_SPIN_DEFAULT_US;
+    long iters = LAT_DEFAULT_ITERS;
+    long warmup = LAT_DEFAULT_WARMUP;
+    int use_tsc = 0;
+    int opt;
 
-    
-    if (argc != 2) {
-        printf("Usage: %s <server_ip>\n", argv[0]);
-        printf("Exemple: %s 10.10.1.1\n", argv[0]);
+    while ((opt = getopt(argc, argv, "m:BLSDP:VRMFj:XC:AK:EZ:Y:s:q:c:d:t:n:w:Tb:i:W:u:H:f:o:h")) != -1) {
+        switch (opt) {
+        case 'm':
+            if (!strcmp(optarg, "send"))       mode = MODE_SEND;
+            else if (!strcmp(optarg, "read"))  mode = MODE_READ;
+            else if (!strcmp(optarg, "write")) mode = MODE_WRITE;
+            else if (!strcmp(optarg, "all"))   mode = MODE_ALL;
+            else {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'B':
+            bw_mode = 1;
+            break;
+        case 'L':
+            lat_mode = 1;
+            break;
+        case 'S':
+            sweep_mode = 1;
+            break;
+        case 'D':
+            doorbell_mode = 1;
+            break;
+        case 'P':
+            page_mode = 1;
+            if (!strcmp(optarg, "seq"))       page_pattern = PAGE_SEQ;
+            else if (!strcmp(optarg, "rand")) page_pattern = PAGE_RAND;
+            else {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'V':
+            vec_mode = 1;
+            break;
+        case 'b':
+            buf_size = parse_size(optarg);
+            break;
+        case 'f':
+            if (!strcmp(optarg, "csv"))       sweep_format = SWEEP_CSV;
+            else if (!strcmp(optarg, "json")) sweep_format = SWEEP_JSON;
+            else {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'o':
+            sweep_path = optarg;
+            break;
+        case 'n':
+            iters = atol(optarg);
+            break;
+        case 'w':
+            warmup = atol(optarg);
+            break;
+        case 'c':
+            signal_every = atoi(optarg);
+            break;
+        case 'd':
+            batch = atoi(optarg);
+            break;
+        case 'i':
+            inline_size = atoi(optarg);
+            break;
+        case 'W':
+            if (cq_mode_parse(optarg, &cq_mode)) {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'u':
+            spin_us = atoi(optarg);
+            break;
+        case 'H':
+            if (mem_pages_parse(optarg, &local_pages)) {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'R':
+            region_mode = 1;
+            break;
+        case 'M':
+            mrcache_mode = 1;
+            break;
+        case 'F':
+            touch_mode = 1;
+            break;
+        case 'j':
+            max_threads = atoi(optarg);
+            if (max_threads < 0) {
+                printf("❌ -j : nombre de threads >= 0\n");
+                return 1;
+            }
+            break;
+        case 'X':
+            numa_cross = 1;
+            break;
+        case 'C':
+            conn_count = atoi(optarg);
+            if (conn_count < 1 || conn_count > CONNRATE_MAX) {
+                printf("❌ -C : entre 1 et %d connexions\n", CONNRATE_MAX);
+                return 1;
+            }
+            break;
+        case 'A':
+            atomic_mode = 1;
+            break;
+        case 'K':
+            kv_keys = parse_size(optarg);
+            if (kv_keys == 0) {
+                printf("❌ -K : au moins une clé\n");
+                return 1;
+            }
+            break;
+        case 'E':
+            echo_mode = 1;
+            break;
+        case 'Z':
+            cache_size = parse_size(optarg);
+            if (cache_size < RDMA_PAGE_SIZE) {
+                printf("❌ -Z : au moins une page (%d octets)\n", RDMA_PAGE_SIZE);
+                return 1;
+            }
+            break;
+        case 'Y':
+            pf_window = atoi(optarg);
+            if (pf_window < 1 || pf_window > PF_WINDOW_MAX) {
+                printf("❌ -Y : fenêtre de 1 à %d pages\n", PF_WINDOW_MAX);
+                return 1;
+            }
+            break;
+        case 'T':
+            use_tsc = 1;
+            break;
+        case 's':
+            msg_size = parse_size(optarg);
+            if (msg_size == 0) {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'q':
+            queue_depth = atoi(optarg);
+            break;
+        case 't':
+            duration_s = atoi(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    // -j sans -A : débit multi-threads ; avec -A : ses threads
+    if (bw_mode + lat_mode + sweep_mode + doorbell_mode + page_mode + vec_mode +
+        region_mode + mrcache_mode + touch_mode +
+        (max_threads >= 0 && !atomic_mode) + (conn_count > 0) +
+        atomic_mode + (kv_keys > 0) + echo_mode + (cache_size > 0) +
+        (pf_window > 0) > 1) {
+        printf("❌ -B, -L, -S, -D, -P, -V, -R, -M, -F, -j, -C, -A, -K, -E, -Z"
+               " et -Y sont exclusifs\n");
+        return 1;
+    }
+    if (buf_size < 4096) {
+        printf("❌ Buffer local invalide : au moins 4K\n");
+        return 1;
+    }
+    buf_size = (buf_size + 4095) & ~(size_t)4095;  // Pages de 4 KB au minimum
+    if (cache_size > 0 && buf_size < cache_size + RDMA_PAGE_SIZE)
+        buf_size = (cache_size + 2 * RDMA_PAGE_SIZE - 1) & ~(size_t)4095;
+    if (msg_size == 0 && kv_keys > 0)
+        msg_size = KV_VALUE_MAX;
+    if (msg_size == 0)
+        msg_size = lat_mode || region_mode || touch_mode || atomic_mode ||
+                   echo_mode ?
+                   LAT_DEFAULT_SIZE :
+                   doorbell_mode ? DB_DEFAULT_SIZE  : BW_DEFAULT_SIZE;
+    if (iters < 1 || warmup < 0) {
+        printf("❌ Itérations invalides : -n >= 1, -w >= 0\n");
+        return 1;
+    }
+    if (msg_size > buf_size) {
+        printf("❌ Taille invalide : 1..%zu octets (voir -b)\n", buf_size);
+        return 1;
+    }
+    if (queue_depth < 1 || queue_depth > MAX_QUEUE_DEPTH) {
+        printf("❌ Profondeur invalide : 1..%d\n", MAX_QUEUE_DEPTH);
+        return 1;
+    }
+    if (signal_every < 1 || signal_every > MAX_QUEUE_DEPTH) {
+        printf("❌ Signalisation invalide : 1..%d\n", MAX_QUEUE_DEPTH);
+        return 1;
+    }
+    if (batch < 1 || batch > WR_BATCH_MAX) {
+        printf("❌ Batch invalide : 1..%d\n", WR_BATCH_MAX);
+        return 1;
+    }
+    if (spin_us < 0) {
+        printf("❌ Budget de spin invalide\n");
+        return 1;
+    }
+    if (inline_size < 0) {
+        printf("❌ Taille inline invalide\n");
         return 1;
     }
+    if (duration_s < 1) {
+        printf("❌ Durée invalide : au moins 1 seconde\n");
+        return 1;
+    }
+
+    if (optind != argc - 1) {
+        usage(argv[0]);
+        return 1;
+    }
+    const char *server_ip = argv[optind];
+    
+    if (bench_clock_init(use_tsc))
+        return 1;
     
     printf("═══════════════════════════════════════════════════\n");
     printf("    RDMA CLIENT - HELLO WORLD INFINIBAND\n");
     printf("═══════════════════════════════════════════════════\n\n");
-    printf("Connexion au serveur %s...\n\n", argv[1]);
+    printf("Connexion au serveur %s...\n\n", server_ip);
     
     // CRITICAL: Verrouiller la mémoire pour RDMA
     printf("🔒 Verrouillage mémoire pour RDMA...\n");
@@ -81,16 +600,17 @@ int main(int argc, char *argv[]) {
     
     printf("🔌 ÉTAPE 1-3 : Création infrastructure RDMA\n");
     
+    // Canal non bloquant, surveillé par epoll (rdma_cmloop.h) : un
+    // événement inattendu est rangé dans l'état de la connexion au
+    // lieu de passer pour la réponse attendue
     struct rdma_event_channel *cm_channel = rdma_create_event_channel();
     if (!cm_channel) {
         perror("   ❌ rdma_create_event_channel");
         return 1;
     }
     
-    struct rdma_cm_id *cm_id;
-    int ret = rdma_create_id(cm_channel, &cm_id, NULL, RDMA_PS_TCP);
-    if (ret) {
-        perror("   ❌ rdma_create_id");
+    struct cm_loop cm_loop;
+    if (cm_loop_init(&cm_loop, cm_channel)) {
         rdma_destroy_event_channel(cm_channel);
         return 1;
     }
@@ -98,73 +618,68 @@ int main(int argc, char *argv[]) {
     printf("   ✅ Infrastructure créée\n\n");
     
     // ═══════════════════════════════════════════════════════
-    // ÉTAPE 4 : RÉSOUDRE L'ADRESSE DU SERVEUR
+    // ÉTAPES 4-5 : RÉSOUDRE L'ADRESSE, PUIS LA ROUTE
     // ═══════════════════════════════════════════════════════
     // CONCRÈTEMENT : On cherche comment joindre le serveur
-    // → Résolution DNS/IP
-    // → Trouve la route InfiniBand vers le serveur
+    // → Résolution DNS/IP (ADDR_RESOLVED)
+    // → Chemin InfiniBand : quel port, quel switch (ROUTE_RESOLVED)
+    // La machine à états enchaîne les deux toute seule : on attend
+    // qu'elle arrive en CM_ROUTED (ou échoue, avec l'événement)
     
     printf("📍 ÉTAPE 4 : Résolution adresse serveur\n");
-    printf("   (Trouver comment joindre %s:12345)\n", argv[1]);
+    printf("   (Trouver comment joindre %s:%d)\n", server_ip, RDMA_PORT);
     
     struct sockaddr_in addr;
     memset(&addr, 0, sizeof(addr));
     addr.sin_family = AF_INET;
-    addr.sin_port = htons(12345);
-    inet_pton(AF_INET, argv[1], &addr.sin_addr);
-    
-    ret = rdma_resolve_addr(cm_id, NULL, (struct sockaddr *)&addr, 2000);
-    if (ret) {
-        perror("   ❌ rdma_resolve_addr");
-        rdma_destroy_id(cm_id);
+    addr.sin_port = htons(RDMA_PORT);
+    if (inet_pton(AF_INET, server_ip, &addr.sin_addr) != 1) {
+        printf("   ❌ Adresse IP invalide : %s\n", server_ip);
+        cm_loop_destroy(&cm_loop);
         rdma_destroy_event_channel(cm_channel);
         return 1;
     }
     
-    struct rdma_cm_event *event;
-    ret = rdma_get_cm_event(cm_channel, &event);
-    if (ret || event->event != RDMA_CM_EVENT_ADDR_RESOLVED) {
-        printf("   ❌ Échec résolution adresse\n");
-        if (event) rdma_ack_cm_event(event);
-        rdma_destroy_id(cm_id);
+    struct cm_conn cm = { .on_state = on_cm_state };
+    if (cm_conn_start(&cm_loop, &cm, (struct sockaddr *)&addr) ||
+        cm_conn_wait(&cm_loop, &cm, CM_WAIT_MS) != CM_ROUTED) {
+        printf("   ❌ Échec résolution (%s, état %s)\n",
+               rdma_event_str(cm.why), cm_state_name(cm.state));
+        if (cm.id)
+            rdma_destroy_id(cm.id);
+        cm_loop_destroy(&cm_loop);
         rdma_destroy_event_channel(cm_channel);
         return 1;
     }
-    
-    printf("   ✅ Adresse résolue\n\n");
-    rdma_ack_cm_event(event);
+    struct rdma_cm_id *cm_id = cm.id;
+    int ret;
     
     // ═══════════════════════════════════════════════════════
-    // ÉTAPE 5 : RÉSOUDRE LA ROUTE
+    // PLACEMENT NUMA
     // ═══════════════════════════════════════════════════════
-    // CONCRÈTEMENT : Trouver le chemin InfiniBand vers le serveur
-    // → Sur quel port InfiniBand ?
-    // → Par quel switch ?
-    // → C'est automatique avec rdma_resolve_route()
-    
-    printf("🗺️  ÉTAPE 5 : Résolution route InfiniBand\n");
-    printf("   (Trouver le chemin physique vers le serveur)\n");
-    
-    ret = rdma_resolve_route(cm_id, 2000);
-    if (ret) {
-        perror("   ❌ rdma_resolve_route");
-        rdma_destroy_id(cm_id);
-        rdma_destroy_event_channel(cm_channel);
-        return 1;
-    }
-    
-    ret = rdma_get_cm_event(cm_channel, &event);
-    if (ret || event->event != RDMA_CM_EVENT_ROUTE_RESOLVED) {
-        printf("   ❌ Échec résolution route\n");
-        if (event) rdma_ack_cm_event(event);
-        rdma_destroy_id(cm_id);
-        rdma_destroy_event_channel(cm_channel);
-        return 1;
+    // La route dit enfin QUELLE carte sert : tout ce qui suit (CQ,
+    // QP, pool, buffer, et ce thread qui poll) va sur son nœud.
+    // → numa_prefer : les pages sont prises au premier accès, donc
+    //   AVANT les allocations
+    // → Épinglage sur les cœurs du nœud (pas un seul : -j épingle
+    //   ses propres threads, un par cœur)
+    
+    int dev_node = numa_dev_node(cm_id->verbs->device);
+    int numa_node = numa_pick_node(dev_node, numa_cross);
+    if (numa_node < 0) {
+        printf("🧭 Nœud NUMA de la carte inconnu : pas de placement\n\n");
+    } else {
+        if (numa_prefer(numa_node))
+            perror("   ⚠️  set_mempolicy");
+        if (numa_pin_node(numa_node))
+            printf("   ⚠️  Épinglage sur le nœud %d impossible\n", numa_node);
+        printf("🧭 Carte sur le nœud %d → buffers, CQ et polling sur le nœud %d%s\n",
+               dev_node, numa_node, numa_node != dev_node ? " (DISTANT, -X)" : "");
+        if (numa_cross && numa_node == dev_node)
+            printf("   ⚠️  -X : un seul nœud NUMA, rien à croiser\n");
+        printf("\n");
     }
     
-    printf("   ✅ Route résolue\n\n");
-    rdma_ack_cm_event(event);
-    
     // ═══════════════════════════════════════════════════════
     // ÉTAPES 6-8 : CRÉER PD, CQ, QP
     // ═══════════════════════════════════════════════════════
@@ -177,123 +692,208 @@ int main(int argc, char *argv[]) {
     if (!pd) {
         perror("   ❌ ibv_alloc_pd");
         rdma_destroy_id(cm_id);
+        cm_loop_destroy(&cm_loop);
         rdma_destroy_event_channel(cm_channel);
         return 1;
     }
     
-    struct ibv_cq *cq = ibv_create_cq(cm_id->verbs, 16, NULL, NULL, 0);
-    if (!cq) {
-        perror("   ❌ ibv_create_cq");
+    // Ce que la carte accepte : SGE par WR (pages vectorisées, voir
+    // rdma_page.h), RDMA_READ en vol (ÉTAPE 10)
+    struct ibv_device_attr dev_attr;
+    if (ibv_query_device(cm_id->verbs, &dev_attr)) {
+        memset(&dev_attr, 0, sizeof(dev_attr));
+        dev_attr.max_qp_init_rd_atom = 1;
+        dev_attr.max_qp_rd_atom = 1;
+        dev_attr.max_sge = 1;
+        dev_attr.max_sge_rd = 1;
+    }
+    
+    // Taille des files : assez pour queue_depth opérations en vol
+    // (+ les quelques SEND de contrôle), la CQ couvre les deux files ;
+    // -E attend jusqu'à ECHO_WINDOW_MAX réponses, un RECV chacune ;
+    // un lot vectorisé peut chaîner PAGE_IOV_MAX WR d'un SGE
+    int send_depth = (queue_depth > PAGE_IOV_MAX ? queue_depth : PAGE_IOV_MAX) + 16;
+    int recv_depth = echo_mode ? ECHO_WINDOW_MAX + 16 : 16;
+    
+    // CQ + façon d'y attendre (-W) : spin, sommeil, ou hybride
+    struct cq_waiter cqw;
+    if (cq_waiter_init(&cqw, cm_id->verbs, send_depth + recv_depth,
+                       cq_mode, spin_us)) {
         ibv_dealloc_pd(pd);
         rdma_destroy_id(cm_id);
+        cm_loop_destroy(&cm_loop);
         rdma_destroy_event_channel(cm_channel);
         return 1;
     }
     
+    struct ibv_cq *cq = cqw.cq;
+    
     struct ibv_qp_init_attr qp_attr;
     memset(&qp_attr, 0, sizeof(qp_attr));
     qp_attr.send_cq = cq;
     qp_attr.recv_cq = cq;
     qp_attr.qp_type = IBV_QPT_RC;
-    qp_attr.cap.max_send_wr = 16;
-    qp_attr.cap.max_recv_wr = 16;
-    qp_attr.cap.max_send_sge = 1;
-    qp_attr.cap.max_recv_sge = 1;
+    qp_attr.cap.max_send_wr = send_depth;
+    qp_attr.cap.max_recv_wr = recv_depth;
+    qp_attr.cap.max_send_sge = dev_attr.max_sge < PAGE_IOV_MAX ?
+                               dev_attr.max_sge : PAGE_IOV_MAX;
+    qp_attr.cap.max_recv_sge = 1;       // RECV : un buffer chacun
+    qp_attr.cap.max_inline_data = inline_size;
+    if (qp_attr.cap.max_send_sge < 1)
+        qp_attr.cap.max_send_sge = 1;
     
     ret = rdma_create_qp(cm_id, pd, &qp_attr);
+    if (ret && inline_size > 0) {
+        // Carte trop petite pour -i : on retente sans inline
+        printf("   ⚠️  max_inline_data=%d refusé, inline désactivé\n",
+               inline_size);
+        qp_attr.cap.max_inline_data = 0;
+        ret = rdma_create_qp(cm_id, pd, &qp_attr);
+    }
+    if (ret && qp_attr.cap.max_send_sge > 1) {
+        // WQE trop gros pour la carte : un SGE, comme avant
+        printf("   ⚠️  max_send_sge=%u refusé, un SGE par WR\n",
+               qp_attr.cap.max_send_sge);
+        qp_attr.cap.max_send_sge = 1;
+        ret = rdma_create_qp(cm_id, pd, &qp_attr);
+    }
     if (ret) {
         perror("   ❌ rdma_create_qp");
-        ibv_destroy_cq(cq);
+        cq_waiter_destroy(&cqw);
         ibv_dealloc_pd(pd);
         rdma_destroy_id(cm_id);
+        cm_loop_destroy(&cm_loop);
         rdma_destroy_event_channel(cm_channel);
         return 1;
     }
     
-    printf("   ✅ PD, CQ, QP créés\n\n");
+    // La carte a pu arrondir : on garde ce qu'elle accepte vraiment,
+    // sans dépasser ce qui a été demandé
+    uint32_t max_inline = qp_attr.cap.max_inline_data;
+    if (max_inline > (uint32_t)inline_size)
+        max_inline = inline_size;
+    // Pareil pour les SGE ; un RDMA_READ a sa propre limite
+    int max_sge = qp_attr.cap.max_send_sge;
+    if (max_sge > PAGE_IOV_MAX)
+        max_sge = PAGE_IOV_MAX;
+    int max_sge_rd = dev_attr.max_sge_rd < max_sge ? dev_attr.max_sge_rd : max_sge;
+    
+    printf("   ✅ PD, CQ, QP créés (inline ≤ %u octets, %d SGE par WR, %d en"
+           " lecture, attente : %s)\n\n", max_inline, max_sge, max_sge_rd,
+           cq_mode_name(cq_mode));
     
     // ═══════════════════════════════════════════════════════
     // ÉTAPE 9 : ALLOUER BUFFER LOCAL
     // ═══════════════════════════════════════════════════════
-    // CONCRÈTEMENT : On alloue 1 MB dans notre RAM locale
+    // CONCRÈTEMENT : On mmap -b octets (1 MB par défaut) dans
+    // notre RAM locale, en pages de 4 KB ou en huge pages (-H)
     // → On va stocker les données lues/écrites ici
     // → On enregistre aussi cette RAM pour RDMA (ibv_reg_mr)
+    // → La réponse au PING de démo (ÉTAPE 12) arrive dans un petit
+    //   buffer du pool (rdma_pool.h), JAMAIS au milieu des données
     
     printf("📦 ÉTAPE 9 : Allocation buffers locaux\n");
-    printf("   (Statiques, pré-alignés à 4KB)\n");
+    printf("   (réponses : pool, données : %zu octets en pages de %s)\n",
+           buf_size, mem_pages_name(local_pages));
     
-    // Buffers STATIQUES - plus stables pour RDMA
-    char *recv_buffer = recv_buffer_static;
-    char *rdma_buffer = rdma_buffer_static;
-    
-    memset(recv_buffer, 0, BUFFER_SIZE);
-    memset(rdma_buffer, 0, BUFFER_SIZE);
-    
-    struct ibv_mr *recv_mr = ibv_reg_mr(pd, recv_buffer, BUFFER_SIZE,
-                                         IBV_ACCESS_LOCAL_WRITE);
-    if (!recv_mr) {
-        perror("   ❌ ibv_reg_mr (recv)");
+    struct mem_region local_region;
+    if (mem_region_alloc(&local_region, buf_size, local_pages)) {
         ibv_destroy_qp(cm_id->qp);
-        ibv_destroy_cq(cq);
+        cq_waiter_destroy(&cqw);
         ibv_dealloc_pd(pd);
         rdma_destroy_id(cm_id);
+        cm_loop_destroy(&cm_loop);
         rdma_destroy_event_channel(cm_channel);
         return 1;
     }
     
-    struct ibv_mr *rdma_mr = ibv_reg_mr(pd, rdma_buffer, BUFFER_SIZE,
-                                         IBV_ACCESS_LOCAL_WRITE);
-    if (!rdma_mr) {
-        perror("   ❌ ibv_reg_mr (rdma)");
-        ibv_dereg_mr(recv_mr);
+    char *rdma_buffer = local_region.addr;     // mmap anonyme : à zéro
+    
+    struct mem_pool pool;
+    struct pool_buf *reply_buf = NULL;
+    if (pool_init(&pool, pd, IBV_ACCESS_LOCAL_WRITE) == 0)
+        reply_buf = pool_get(&pool, DATA_SIZE);
+    if (!reply_buf) {
+        printf("   ❌ pool_get (réponses)\n");
+        pool_destroy(&pool);
+        mem_region_free(&local_region);
         ibv_destroy_qp(cm_id->qp);
-        ibv_destroy_cq(cq);
+        cq_waiter_destroy(&cqw);
         ibv_dealloc_pd(pd);
         rdma_destroy_id(cm_id);
+        cm_loop_destroy(&cm_loop);
         rdma_destroy_event_channel(cm_channel);
         return 1;
     }
     
-    printf("   ✅ Buffers créés et enregistrés\n");
-    printf("      - recv_buffer: %p (MR LKEY: 0x%x)\n", recv_buffer, recv_mr->lkey);
-    printf("      - rdma_buffer: %p (MR LKEY: 0x%x)\n\n", rdma_buffer, rdma_mr->lkey);
-    
-    // ═══════════════════════════════════════════════════════
-    // POSTER LE RECV ICI (AVANT CONNEXION) !
-    // ═══════════════════════════════════════════════════════
-    // NOTE: Le serveur met les infos au DÉBUT du recv_buffer
-    
-    //struct rdma_buffer_info server_info;
-    
-    struct ibv_sge recv_sge;
-    recv_sge.addr = (uint64_t)recv_buffer;  // ← Au DÉBUT, pas à la fin !
-    recv_sge.length = sizeof(server_info);
-    recv_sge.lkey = recv_mr->lkey;
-    
-    struct ibv_recv_wr recv_wr, *bad_recv_wr;
-    memset(&recv_wr, 0, sizeof(recv_wr));
-    recv_wr.wr_id = 2;
-    recv_wr.sg_list = &recv_sge;
-    recv_wr.num_sge = 1;
-    
-    ret = ibv_post_recv(cm_id->qp, &recv_wr, &bad_recv_wr);
-    if (ret) {
-        perror("   ❌ ibv_post_recv");
-        ibv_dereg_mr(rdma_mr);
-        ibv_dereg_mr(recv_mr);
+    // Le buffer de données passe par le cache d'enregistrements
+    // (rdma_mrcache.h), comme tout buffer à enregistrer du client
+    struct mr_cache mrc;
+    struct mrc_entry *rdma_ent = NULL;
+    struct timespec reg_t0, reg_t1;
+    clock_gettime(CLOCK_MONOTONIC, &reg_t0);
+    if (mrc_init(&mrc, pd, IBV_ACCESS_LOCAL_WRITE, MRC_DEFAULT_CAP) == 0)
+        rdma_ent = mrc_get(&mrc, rdma_buffer, buf_size);
+    clock_gettime(CLOCK_MONOTONIC, &reg_t1);
+    if (!rdma_ent) {
+        printf("   ❌ Enregistrement du buffer de données impossible\n");
+        mrc_destroy(&mrc);
+        pool_destroy(&pool);
+        mem_region_free(&local_region);
         ibv_destroy_qp(cm_id->qp);
-        ibv_destroy_cq(cq);
+        cq_waiter_destroy(&cqw);
         ibv_dealloc_pd(pd);
         rdma_destroy_id(cm_id);
+        cm_loop_destroy(&cm_loop);
         rdma_destroy_event_channel(cm_channel);
         return 1;
     }
+    struct ibv_mr *rdma_mr = rdma_ent->mr;
+    
+    printf("   ✅ Buffers créés et enregistrés\n");
+    printf("      - reply_buf  : %p (pool LKEY: 0x%x)\n", reply_buf->addr, reply_buf->lkey);
+    printf("      - rdma_buffer: %p (MR LKEY: 0x%x, enregistré en %.2f ms,"
+           " nœud NUMA %d)\n\n", rdma_buffer, rdma_mr->lkey,
+           elapsed_ns(&reg_t0, &reg_t1) / 1e6, numa_node_of_addr(rdma_buffer));
+    
+    // Anneau de messages (-E) : le NÔTRE, que le serveur écrira.
+    // REMOTE_WRITE : enregistré à part (le cache ne donne que
+    // LOCAL_WRITE), et décrit au serveur dans le connect
+    struct ring_desc my_ring = { 0 };
+    char *ring_mem = NULL;
+    struct ibv_mr *ring_mr = NULL;
+    if (echo_mode) {
+        int shift = ring_shift_for(msg_size);
+        size_t ring_bytes = shift < 0 ? 0 : (size_t)RING_DEFAULT_SLOTS << shift;
+        if (shift >= 0)
+            ring_mem = aligned_alloc(4096, (ring_bytes + 4095) & ~(size_t)4095);
+        if (ring_mem)
+            ring_mr = ibv_reg_mr(pd, ring_mem, ring_bytes,
+                                 IBV_ACCESS_LOCAL_WRITE | IBV_ACCESS_REMOTE_WRITE);
+        if (!ring_mr) {
+            printf("   ❌ Anneau de messages : %s\n", shift < 0 ?
+                   "messages de 64 KB - 8 octets au plus" :
+                   "allocation / enregistrement impossible");
+            free(ring_mem);
+            mrc_destroy(&mrc);
+            pool_destroy(&pool);
+            mem_region_free(&local_region);
+            ibv_destroy_qp(cm_id->qp);
+            cq_waiter_destroy(&cqw);
+            ibv_dealloc_pd(pd);
+            rdma_destroy_id(cm_id);
+            cm_loop_destroy(&cm_loop);
+            rdma_destroy_event_channel(cm_channel);
+            return 1;
+        }
+        my_ring.addr = (uint64_t)ring_mem;
+        my_ring.rkey = ring_mr->rkey;
+        my_ring.slots = RING_DEFAULT_SLOTS;
+        my_ring.slot_shift = shift;
+        printf("   ✅ Anneau : %d slots de %d octets (RKEY: 0x%x)\n\n",
+               RING_DEFAULT_SLOTS, 1 << shift, ring_mr->rkey);
+    }
     
-    printf("   ✅ RECV posté (prêt à recevoir du serveur)\n\n");
-
-
-
-
     // ═══════════════════════════════════════════════════════
     // ÉTAPE 10 : SE CONNECTER AU SERVEUR
     // ═══════════════════════════════════════════════════════
@@ -301,244 +901,887 @@ int main(int argc, char *argv[]) {
     
     printf("🤝 ÉTAPE 10 : Connexion au serveur\n");
     
+    // RDMA_READ en vol : limité par ce que la carte accepte
+    // (sinon la carte les sérialise, et le débit READ s'effondre)
     struct rdma_conn_param conn_param;
     memset(&conn_param, 0, sizeof(conn_param));
+    conn_param.initiator_depth = dev_attr.max_qp_init_rd_atom;
+    conn_param.responder_resources = dev_attr.max_qp_rd_atom;
+    conn_param.retry_count = 7;
+    conn_param.rnr_retry_count = 7;  // 7 = réessayer sans fin si le
+                                     // serveur n'a plus de RECV postés
+    if (echo_mode) {
+        conn_param.private_data = &my_ring;
+        conn_param.private_data_len = sizeof(my_ring);
+    }
     
-    ret = rdma_connect(cm_id, &conn_param);
+    ret = cm_conn_connect(&cm, &conn_param);
     if (ret) {
         perror("   ❌ rdma_connect");
-        ibv_dereg_mr(rdma_mr);
-        ibv_dereg_mr(recv_mr);
+        if (ring_mr)
+            ibv_dereg_mr(ring_mr);
+        free(ring_mem);
+        mrc_destroy(&mrc);
+        pool_destroy(&pool);
+        mem_region_free(&local_region);
         ibv_destroy_qp(cm_id->qp);
-        ibv_destroy_cq(cq);
+        cq_waiter_destroy(&cqw);
         ibv_dealloc_pd(pd);
         rdma_destroy_id(cm_id);
+        cm_loop_destroy(&cm_loop);
         rdma_destroy_event_channel(cm_channel);
         return 1;
     }
     
-    ret = rdma_get_cm_event(cm_channel, &event);
-    if (ret || event->event != RDMA_CM_EVENT_ESTABLISHED) {
-        printf("   ❌ Connexion échouée\n");
-        if (event) rdma_ack_cm_event(event);
-        ibv_dereg_mr(rdma_mr);
-        ibv_dereg_mr(recv_mr);
+    // REJECTED : serveur pas lancé, ou backlog plein (redémarrage
+    // de masse) ; ESTABLISHED sans infos : serveur trop ancien
+    if (cm_conn_wait(&cm_loop, &cm, CM_WAIT_MS) != CM_UP) {
+        printf("   ❌ Connexion échouée (%s, état %s)\n",
+               rdma_event_str(cm.why), cm_state_name(cm.state));
+        if (cm.state == CM_CONNECTING || cm.why == RDMA_CM_EVENT_ESTABLISHED)
+            rdma_disconnect(cm_id);
+        if (ring_mr)
+            ibv_dereg_mr(ring_mr);
+        free(ring_mem);
+        mrc_destroy(&mrc);
+        pool_destroy(&pool);
+        mem_region_free(&local_region);
         ibv_destroy_qp(cm_id->qp);
-        ibv_destroy_cq(cq);
+        cq_waiter_destroy(&cqw);
         ibv_dealloc_pd(pd);
         rdma_destroy_id(cm_id);
+        cm_loop_destroy(&cm_loop);
         rdma_destroy_event_channel(cm_channel);
         return 1;
     }
     
-    printf("   ✅ Connecté au serveur\n\n");
-    rdma_ack_cm_event(event);
-    
     // ═══════════════════════════════════════════════════════
-    // ÉTAPE 11 : RECEVOIR LES INFOS DU SERVEUR
+    // ÉTAPE 11 : LES INFOS DU SERVEUR SONT DANS L'ÉVÉNEMENT
     // ═══════════════════════════════════════════════════════
-    // LE RECV A DÉJÀ ÉTÉ POSTÉ À L'ÉTAPE 9 !
-    // ICI ON ATTEND JUSTE LA RÉCEPTION
-    
-    printf("📥 ÉTAPE 11 : Réception infos mémoire serveur\n");
-    printf("   (Le RECV est déjà posté, on attend...)\n\n");
-    
-    // Attendre la complétion du RECV
-    //struct ibv_wc wc;
-    while (ibv_poll_cq(cq, 1, &wc) < 1) {
-        // Polling... attente active
-    }
+    // Le serveur les a mises dans la private_data de son accept :
+    // pas de RECV à poster avant, pas de SEND à attendre après.
+    // La machine à états les a copiées dans cm.info (CM_UP).
     
-    if (wc.status != IBV_WC_SUCCESS) {
-        printf("   ❌ Réception échouée (status: %d)\n", wc.status);
-        ibv_dereg_mr(rdma_mr);
-        ibv_dereg_mr(recv_mr);
-        ibv_destroy_qp(cm_id->qp);
-        ibv_destroy_cq(cq);
-        ibv_dealloc_pd(pd);
-        rdma_disconnect(cm_id);
-        rdma_destroy_id(cm_id);
-        rdma_destroy_event_channel(cm_channel);
-        return 1;
-    }
+    printf("   ✅ Connecté au serveur\n\n");
+    printf("📥 ÉTAPE 11 : Infos mémoire serveur (arrivées avec l'accept)\n");
+    server_info = cm.info;
     
     printf("   ✅ Infos reçues avec succès !\n\n");
 
-    // DEBUG: Afficher les bytes reçus
-    unsigned char *recv_data = (unsigned char *)recv_buffer;
-    printf("   📍 DEBUG RECV - Bytes reçus:\n");
-    for (int i = 0; i < sizeof(server_info); i++) {
-        printf("      [%d] = 0x%02x\n", i, recv_data[i]);
-    }
-
-    memcpy(&server_info, recv_buffer, sizeof(server_info));
-    
     printf("   ┌─────────────────────────────────────────────┐\n");
     printf("   │ INFORMATIONS REÇUES DU SERVEUR :            │\n");
     printf("   ├─────────────────────────────────────────────┤\n");
     printf("   │ Adresse RAM serveur : 0x%016lx  │\n", server_info.addr);
     printf("   │ RKEY (clé accès)    : 0x%08x            │\n", server_info.rkey);
-    printf("   │ recv_buffer addr    : 0x%016lx    │\n", (uint64_t)recv_buffer);
+    printf("   │ Taille RAM serveur  : %-10lu octets     │\n", server_info.size);
+    printf("   │ reply_buf addr      : 0x%016lx    │\n", (uint64_t)reply_buf->addr);
     printf("   │ rdma_buffer addr    : 0x%016lx    │\n", (uint64_t)rdma_buffer);
-    printf("   │ recv_mr LKEY        : 0x%08x            │\n", recv_mr->lkey);
+    printf("   │ pool LKEY           : 0x%08x            │\n", reply_buf->lkey);
     printf("   │ rdma_mr LKEY        : 0x%08x            │\n", rdma_mr->lkey);
     printf("   │                                             │\n");
-    printf("   │ ✅ Connexion établie - attente données...   │\n");
+    printf("   │ ✅ Connexion établie                        │\n");
     printf("   └─────────────────────────────────────────────┘\n\n");
     
-    sleep(1);
+    // Latences mesurées (ns), -1 = mode non exécuté
+    long lat_send_ns = -1, lat_read_ns = -1, lat_write_ns = -1;
+    int status = 0;
+    
+    // La connexion, vue par les benchmarks (-B / -L / -S)
+    struct bench_conn bconn = {
+        .qp = cm_id->qp,
+        .cqw = &cqw,
+        .buf = rdma_buffer,
+        .buf_size = buf_size,
+        .lkey = rdma_mr->lkey,
+        .remote_addr = server_info.addr,
+        .remote_size = server_info.size,
+        .rkey = server_info.rkey,
+        .max_send = server_info.max_send < MAX_SEND_SIZE ?
+                    server_info.max_send : MAX_SEND_SIZE,
+        .max_inline = max_inline,
+    };
+    
+    if ((bw_mode || lat_mode || doorbell_mode || region_mode || mrcache_mode ||
+         max_threads >= 0) &&
+        msg_size > server_info.size) {
+        printf("   ❌ Taille %zu > RAM serveur (%lu octets)\n",
+               msg_size, server_info.size);
+        status = 1;
+        goto cleanup;
+    }
     
     // ═══════════════════════════════════════════════════════
-    // ÉTAPE 12 : RDMA READ - LIRE LA RAM DU SERVEUR
+    // ÉTAPES 12-14 (VARIANTE -B) : BENCHMARK DE DÉBIT
     // ═══════════════════════════════════════════════════════
-    // ✨ LA MAGIE COMMENCE ! ✨
-    //
-    // QU'EST-CE QUI SE PASSE CONCRÈTEMENT ?
-    //
-    // 1. Je prépare une requête RDMA_READ
-    // 2. Je spécifie :
-    //    - Où stocker les données lues (mon buffer local)
-    //    - D'où lire (adresse RAM serveur)
-    //    - La clé d'accès (RKEY)
-    // 3. J'envoie la requête à ma carte InfiniBand
-    // 4. MA CARTE parle à la CARTE SERVEUR
-    // 5. LA CARTE SERVEUR lit sa RAM et envoie les données
-    // 6. MA CARTE reçoit et écrit dans mon buffer local
-    // 7. LE CPU DU SERVEUR N'A JAMAIS ÉTÉ RÉVEILLÉ ! 😴
-    //
-    // Latence totale : 1-5 μs (vs 5 ms pour disque)
+    // Au lieu d'UNE opération par étape, on garde queue_depth
+    // opérations en vol pendant duration_s secondes, pour chaque
+    // opération demandée, sur cette même connexion.
+    // → SEND : le serveur a SRV_SRQ_DEPTH RECV postés et jette
+    //          les données (son CPU travaille, lui)
+    // → READ / WRITE : le CPU serveur ne voit RIEN passer
+    
+    if (bw_mode) {
+        printf("🚀 BENCHMARK DE DÉBIT (%d s par opération)\n", duration_s);
+        
+        for (int i = 0; i < NUM_BENCH_OPS; i++) {
+            if (!(mode & bench_ops[i].flag))
+                continue;
+            
+            struct bench_opts bopts = {
+                .op = bench_ops[i].op,
+                .size = msg_size,
+                .queue_depth = queue_depth,
+                .signal_every = signal_every,
+                .batch = batch,
+                .duration_s = duration_s,
+            };
+            struct bench_result bres;
+            
+            if (bench_bw(&bconn, &bopts, &bres)) {
+                status = 1;
+                goto cleanup;
+            }
+            bench_print_bw(&bopts, &bres);
+        }
+        printf("\n");
+        
+        goto quit;
+    }
     
     // ═══════════════════════════════════════════════════════
-    // ÉTAPE 12 : RECEVOIR LES DONNÉES DU SERVEUR
+    // ÉTAPES 12-14 (VARIANTE -j) : DÉBIT MULTI-THREADS
     // ═══════════════════════════════════════════════════════
-    // Le serveur va nous envoyer le contenu de son buffer via SEND
+    // Même mesure que -B, mais sur N connexions EN PLUS de celle-ci,
+    // une par thread (rdma_mt.h). Elles partagent notre PD et notre
+    // MR : le buffer local est découpé en N tranches.
+    
+    if (max_threads >= 0 && !atomic_mode) {
+        printf("🧵 DÉBIT MULTI-THREADS (%d s par palier)\n", duration_s);
+        
+        for (int i = 0; i < NUM_BENCH_OPS; i++) {
+            if (!(mode & bench_ops[i].flag))
+                continue;
+            
+            struct mt_opts mopts = {
+                .server_ip = server_ip,
+                .pd = pd,
+                .buf = rdma_buffer,
+                .buf_size = buf_size,
+                .lkey = rdma_mr->lkey,
+                .node = numa_node,
+                .max_threads = max_threads,
+                .inline_size = inline_size,
+                .cq_mode = cq_mode,
+                .spin_us = spin_us,
+                .base = {
+                    .op = bench_ops[i].op,
+                    .size = msg_size,
+                    .queue_depth = queue_depth,
+                    .signal_every = signal_every,
+                    .batch = batch,
+                    .duration_s = duration_s,
+                },
+            };
+            if (bench_threads(&mopts)) {
+                status = 1;
+                goto cleanup;
+            }
+        }
+        printf("\n");
+        
+        goto quit;
+    }
     
-    printf("📖 ÉTAPE 12 : Réception données serveur\n");
-    printf("   ┌─────────────────────────────────────────────┐\n");
-    printf("   │ Attente du contenu RAM serveur...           │\n");
-    printf("   └─────────────────────────────────────────────┘\n\n");
+    // ═══════════════════════════════════════════════════════
+    // ÉTAPES 12-14 (VARIANTE -A) : ATOMIQUES DISTANTS
+    // ═══════════════════════════════════════════════════════
+    // Des threads (un par connexion, comme -j) se disputent des mots
+    // de la RAM serveur à coups de FETCH_AND_ADD / COMPARE_AND_SWAP
+    // (rdma_atomic.h). Cette connexion-ci relit les compteurs après
+    // chaque palier : le compte doit être exact.
+    
+    if (atomic_mode) {
+        printf("⚛️  ATOMIQUES DISTANTS (%d s par palier, qd=%d pour les FAA)\n",
+               duration_s, queue_depth);
+        
+        if (!(server_info.flags & INFO_ATOMIC)) {
+            printf("   ❌ La RKEY du serveur n'autorise pas les atomiques\n");
+            status = 1;
+            goto cleanup;
+        }
+        
+        struct mt_opts mopts = {
+            .server_ip = server_ip,
+            .pd = pd,
+            .buf = rdma_buffer,
+            .buf_size = buf_size,
+            .lkey = rdma_mr->lkey,
+            .node = numa_node,
+            .max_threads = max_threads < 0 ? 0 : max_threads,
+            .inline_size = inline_size,
+            .cq_mode = cq_mode,
+            .spin_us = spin_us,
+            .base = {
+                .queue_depth = queue_depth,
+                .duration_s = duration_s,
+            },
+        };
+        if (bench_atomics(&mopts, &bconn)) {
+            status = 1;
+            goto cleanup;
+        }
+        printf("\n");
+        
+        goto quit;
+    }
     
-    // Poster RECV pour recevoir les données du serveur
-    struct ibv_sge recv_data_sge;
-    recv_data_sge.addr = (uint64_t)rdma_buffer;
-    recv_data_sge.length = 100;  // Recevoir 100 octets
-    recv_data_sge.lkey = rdma_mr->lkey;
+    // ═══════════════════════════════════════════════════════
+    // ÉTAPES 12-14 (VARIANTE -C) : CONNEXIONS PAR SECONDE
+    // ═══════════════════════════════════════════════════════
+    // N connexions de plus, comme N clients qui redémarrent
+    // ensemble (rdma_connrate.h). Chacune lit 8 octets dès son
+    // ESTABLISHED : c'est le "1er octet".
+    
+    if (conn_count > 0) {
+        printf("🔗 CONNEXIONS PAR SECONDE (%d par palier)\n", conn_count);
+        
+        struct connrate_opts copts = {
+            .server_ip = server_ip,
+            .pd = pd,
+            .buf = rdma_buffer,
+            .buf_size = buf_size,
+            .lkey = rdma_mr->lkey,
+            .count = conn_count,
+        };
+        if (bench_connect(&copts)) {
+            status = 1;
+            goto cleanup;
+        }
+        printf("\n");
+        
+        goto quit;
+    }
     
-    struct ibv_recv_wr recv_data_wr, *bad_recv_data_wr;
-    memset(&recv_data_wr, 0, sizeof(recv_data_wr));
-    recv_data_wr.wr_id = 10;
-    recv_data_wr.sg_list = &recv_data_sge;
-    recv_data_wr.num_sge = 1;
+    // ═══════════════════════════════════════════════════════
+    // ÉTAPES 12-14 (VARIANTE -L) : BENCHMARK DE LATENCE
+    // ═══════════════════════════════════════════════════════
+    // UNE opération en vol, répétée warmup + iters fois.
+    // → Chaque aller-retour va dans un histogramme (ns)
+    // → On affiche la queue de distribution : p99, p99.9, max
+    //   (c'est elle qui fait mal aux applications, pas la moyenne)
+    
+    if (lat_mode) {
+        printf("⏱️  BENCHMARK DE LATENCE (%ld échantillons, %ld de chauffe, %s,"
+               " inline ≤ %u o)\n", iters, warmup,
+               bench_use_tsc ? "TSC" : "CLOCK_MONOTONIC", max_inline);
+        
+        // ~30 KB : pas sur la pile
+        static struct hist h;
+        
+        for (int i = 0; i < NUM_BENCH_OPS; i++) {
+            if (!(mode & bench_ops[i].flag))
+                continue;
+            
+            struct bench_opts bopts = {
+                .op = bench_ops[i].op,
+                .size = msg_size,
+                .iters = iters,
+                .warmup = warmup,
+            };
+            
+            hist_init(&h);
+            if (bench_lat(&bconn, &bopts, &h)) {
+                status = 1;
+                goto cleanup;
+            }
+            bench_print_lat(&bopts, &h);
+        }
+        printf("\n");
+        
+        goto quit;
+    }
     
-    ret = ibv_post_recv(cm_id->qp, &recv_data_wr, &bad_recv_data_wr);
-    if (ret) {
-        perror("   ❌ ibv_post_recv (données)");
-        ibv_dereg_mr(rdma_mr);
-        ibv_dereg_mr(recv_mr);
-        ibv_destroy_qp(cm_id->qp);
-        ibv_destroy_cq(cq);
-        ibv_dealloc_pd(pd);
-        rdma_disconnect(cm_id);
-        rdma_destroy_id(cm_id);
-        rdma_destroy_event_channel(cm_channel);
-        return 1;
+    // ═══════════════════════════════════════════════════════
+    // ÉTAPES 12-14 (VARIANTE -D) : DÉBIT SELON LE BATCH
+    // ═══════════════════════════════════════════════════════
+    // Même mesure que -B, pour 1, 2, 4, ... WR_BATCH_MAX WR
+    // chaînés par ibv_post_send.
+    // → En petits messages, le débit suit le nombre de doorbells
+    //   économisés, jusqu'à ce que la carte sature
+    
+    if (doorbell_mode) {
+        printf("🔔 DÉBIT SELON LE BATCH (%zu o, qd=%d, %d s par mesure)\n",
+               msg_size, queue_depth, duration_s);
+        
+        for (int i = 0; i < NUM_BENCH_OPS; i++) {
+            if (!(mode & bench_ops[i].flag))
+                continue;
+            
+            struct bench_opts bopts = {
+                .op = bench_ops[i].op,
+                .size = msg_size,
+                .queue_depth = queue_depth,
+                .signal_every = signal_every,
+                .duration_s = duration_s,
+            };
+            
+            if (bench_doorbell(&bconn, &bopts)) {
+                status = 1;
+                goto cleanup;
+            }
+        }
+        printf("\n");
+        
+        goto quit;
     }
     
     // ═══════════════════════════════════════════════════════
-    // ÉTAPE 13 : ENVOYER SIGNAL AU SERVEUR
+    // ÉTAPES 12-14 (VARIANTE -P) : PAGINATION DISTANTE
     // ═══════════════════════════════════════════════════════
-    // Dire au serveur : "Je suis prêt, tu peux envoyer"
+    // La RAM serveur vue comme un tableau de pages de 4 KB :
+    // → page_out = RDMA_WRITE, page_in = RDMA_READ (rdma_page.h)
+    // → Une page à la fois, comme un défaut de page
+    
+    if (page_mode) {
+        struct page_store ps;
+        page_store_init(&ps, cm_id->qp, &cqw, rdma_mr->lkey,
+                        server_info.addr, server_info.size, server_info.rkey);
+        page_store_sge(&ps, max_sge, max_sge_rd);
+        
+        printf("📄 PAGINATION DISTANTE (%lu pages de %d o, trace %s de %ld accès)\n",
+               ps.num_pages, RDMA_PAGE_SIZE,
+               page_pattern == PAGE_SEQ ? "séquentielle" : "aléatoire", iters);
+        
+        struct page_bench_opts popts = {
+            .pattern = page_pattern,
+            .accesses = iters,
+        };
+        if (bench_pages(&ps, rdma_buffer, buf_size, &popts)) {
+            status = 1;
+            goto cleanup;
+        }
+        printf("\n");
+        
+        goto quit;
+    }
     
-    printf("📤 ÉTAPE 13 : Envoi signal au serveur\n");
+    // ═══════════════════════════════════════════════════════
+    // ÉTAPES 12-14 (VARIANTE -V) : PAGINATION VECTORISÉE
+    // ═══════════════════════════════════════════════════════
+    // Des pages locales éparpillées vers une zone distante contiguë
+    // (rdma_page.h) : un WR par page, puis un WR pour max_sge pages
+    
+    if (vec_mode) {
+        struct page_store ps;
+        page_store_init(&ps, cm_id->qp, &cqw, rdma_mr->lkey,
+                        server_info.addr, server_info.size, server_info.rkey);
+        page_store_sge(&ps, max_sge, max_sge_rd);
+        
+        printf("📚 PAGINATION VECTORISÉE (lots de 4 à %d pages, %ld pages"
+               " par mesure)\n", PAGE_IOV_MAX, iters);
+        if (max_sge == 1)
+            printf("   ⚠️  Un seul SGE par WR sur cette carte : rien à gagner\n");
+        
+        struct page_bench_opts popts = {
+            .accesses = iters,
+        };
+        if (bench_pages_vec(&ps, rdma_buffer, buf_size, &popts)) {
+            status = 1;
+            goto cleanup;
+        }
+        printf("\n");
+        
+        goto quit;
+    }
     
-    struct ibv_sge signal_sge;
-    signal_sge.addr = (uint64_t)rdma_buffer;
-    signal_sge.length = 1;  // Juste 1 byte
-    signal_sge.lkey = rdma_mr->lkey;
+    // ═══════════════════════════════════════════════════════
+    // ÉTAPES 12-14 (VARIANTE -Z) : CACHE DE PAGES DISTANTES
+    // ═══════════════════════════════════════════════════════
+    // Les pages chaudes restent dans le buffer local (rdma_pcache.h) :
+    // → hit = un accès en DRAM, miss = page_in (+ page_out du cadre
+    //   évincé s'il était sale)
+    
+    if (cache_size > 0) {
+        struct page_store ps;
+        page_store_init(&ps, cm_id->qp, &cqw, rdma_mr->lkey,
+                        server_info.addr, server_info.size, server_info.rkey);
+        page_store_sge(&ps, max_sge, max_sge_rd);
+        
+        printf("🗃️  CACHE DE PAGES DISTANTES (%zu pages locales pour %lu"
+               " distantes, %ld accès par mesure)\n",
+               cache_size / RDMA_PAGE_SIZE, ps.num_pages, iters);
+        
+        struct pcache_bench_opts copts = {
+            .cache_pages = cache_size / RDMA_PAGE_SIZE,
+            .accesses = iters,
+        };
+        if (bench_pcache(&ps, rdma_buffer, buf_size, &copts)) {
+            status = 1;
+            goto cleanup;
+        }
+        printf("\n");
+        
+        goto quit;
+    }
     
-    struct ibv_send_wr signal_wr, *bad_signal_wr;
-    memset(&signal_wr, 0, sizeof(signal_wr));
-    signal_wr.wr_id = 20;
-    signal_wr.sg_list = &signal_sge;
-    signal_wr.num_sge = 1;
-    signal_wr.opcode = IBV_WR_SEND;
-    signal_wr.send_flags = IBV_SEND_SIGNALED;
+    // ═══════════════════════════════════════════════════════
+    // ÉTAPES 12-14 (VARIANTE -Y) : PRÉCHARGEMENT
+    // ═══════════════════════════════════════════════════════
+    // Tout le buffer local sert de cache (rdma_pcache.h) ; le
+    // préchargeur (rdma_prefetch.h) y fait arriver les pages des
+    // flux qu'il reconnaît avant qu'on les demande
+    
+    if (pf_window > 0) {
+        struct page_store ps;
+        page_store_init(&ps, cm_id->qp, &cqw, rdma_mr->lkey,
+                        server_info.addr, server_info.size, server_info.rkey);
+        page_store_sge(&ps, max_sge, max_sge_rd);
+        
+        printf("⏩ PRÉCHARGEMENT (fenêtre jusqu'à %d pages, %ld accès par"
+               " mesure)\n", pf_window, iters);
+        
+        struct prefetch_bench_opts fopts = {
+            .max_window = pf_window,
+            .accesses = iters,
+        };
+        if (bench_prefetch(&ps, rdma_buffer, buf_size, &fopts)) {
+            status = 1;
+            goto cleanup;
+        }
+        printf("\n");
+        
+        goto quit;
+    }
     
-    ret = ibv_post_send(cm_id->qp, &signal_wr, &bad_signal_wr);
-    if (ret) {
-        perror("   ❌ ibv_post_send (signal)");
-        ibv_dereg_mr(rdma_mr);
-        ibv_dereg_mr(recv_mr);
-        ibv_destroy_qp(cm_id->qp);
-        ibv_destroy_cq(cq);
-        ibv_dealloc_pd(pd);
-        rdma_disconnect(cm_id);
-        rdma_destroy_id(cm_id);
-        rdma_destroy_event_channel(cm_channel);
-        return 1;
+    // ═══════════════════════════════════════════════════════
+    // ÉTAPES 12-14 (VARIANTE -K) : TABLE CLÉ-VALEUR
+    // ═══════════════════════════════════════════════════════
+    // La RAM serveur formatée en table (rdma_kv.h) :
+    // → GET = RDMA_READ seulement, le CPU du serveur dort
+    // → PUT = RDMA_WRITE_WITH_IMM dans notre boîte aux lettres
+    //   (server_info.mbox), appliqué et acquitté par le serveur
+    
+    if (kv_keys > 0) {
+        printf("🗄️  TABLE CLÉ-VALEUR (%lu clés, valeurs ≤ %zu o, %ld requêtes"
+               " par mesure)\n", kv_keys, msg_size, iters);
+        
+        if (!(server_info.flags & INFO_KV)) {
+            printf("   ❌ Le serveur n'expose pas de table (le lancer avec -K)\n");
+            status = 1;
+            goto cleanup;
+        }
+        if (msg_size > KV_VALUE_MAX) {
+            printf("   ❌ -s : valeurs de %d octets au plus\n", KV_VALUE_MAX);
+            status = 1;
+            goto cleanup;
+        }
+        
+        struct kv_client kv;
+        if (kv_open(&kv, cm_id->qp, &cqw, rdma_buffer, buf_size,
+                    rdma_mr->lkey, server_info.addr, server_info.size,
+                    server_info.rkey, server_info.mbox)) {
+            status = 1;
+            goto cleanup;
+        }
+        
+        struct kv_bench_opts kopts = {
+            .max_keys = kv_keys,
+            .max_value = msg_size,
+            .ops = iters,
+        };
+        if (bench_kv(&kv, &kopts)) {
+            status = 1;
+            goto cleanup;
+        }
+        printf("\n");
+        
+        goto quit;
     }
     
-    // Attendre complétion du signal
-    while (ibv_poll_cq(cq, 1, &wc) < 1);
+    // ═══════════════════════════════════════════════════════
+    // ÉTAPES 12-14 (VARIANTE -E) : ANNEAU DE MESSAGES
+    // ═══════════════════════════════════════════════════════
+    // Notre anneau est parti dans le connect, celui du serveur est
+    // arrivé avec l'accept (server_info.ring) : on s'écrit l'un
+    // chez l'autre (rdma_ring.h), puis on compare à SEND/RECV
+    
+    if (echo_mode) {
+        printf("💌 ANNEAU DE MESSAGES vs SEND/RECV (%ld allers-retours par"
+               " mesure)\n", iters);
+        
+        if (!(server_info.flags & INFO_RING) ||
+            server_info.ring.slots != my_ring.slots ||
+            server_info.ring.slot_shift != my_ring.slot_shift) {
+            printf("   ❌ Le serveur n'a pas créé d'anneau (serveur trop ancien ?)\n");
+            status = 1;
+            goto cleanup;
+        }
+        
+        struct ring ring;
+        ring_init(&ring, cm_id->qp, ring_mem, my_ring.slots,
+                  my_ring.slot_shift, max_inline);
+        ring_set_peer(&ring, &server_info.ring);
+        
+        struct echo_opts eopts = {
+            .size = msg_size,
+            .window = queue_depth,
+            .iters = iters,
+            .warmup = warmup,
+        };
+        if (bench_echo(&bconn, &ring, &eopts)) {
+            status = 1;
+            goto cleanup;
+        }
+        printf("\n");
+        
+        goto quit;
+    }
     
-    if (wc.status != IBV_WC_SUCCESS) {
-        printf("   ❌ Signal échoué (code: %d)\n", wc.status);
-        ibv_dereg_mr(rdma_mr);
-        ibv_dereg_mr(recv_mr);
-        ibv_destroy_qp(cm_id->qp);
-        ibv_destroy_cq(cq);
-        ibv_dealloc_pd(pd);
-        rdma_disconnect(cm_id);
-        rdma_destroy_id(cm_id);
-        rdma_destroy_event_channel(cm_channel);
-        return 1;
+    // ═══════════════════════════════════════════════════════
+    // ÉTAPES 12-14 (VARIANTE -R) : PAGES DE 4K / 2M / 1G
+    // ═══════════════════════════════════════════════════════
+    // Une région de -b octets par type de pages, enregistrée sur le
+    // même PD : coût de ibv_reg_mr, puis READ à des offsets
+    // aléatoires (la carte traduit chaque adresse locale).
+    
+    if (region_mode) {
+        printf("🧱 PAGES 4K / 2M / 1G (%zu octets, READ de %zu o, %ld échantillons)\n",
+               buf_size, msg_size, iters);
+        
+        struct bench_opts bopts = {
+            .op = BENCH_READ,
+            .size = msg_size,
+            .iters = iters,
+            .warmup = warmup,
+        };
+        if (bench_region(&bconn, pd, buf_size, &bopts)) {
+            status = 1;
+            goto cleanup;
+        }
+        printf("\n");
+        
+        goto quit;
     }
     
-    printf("   ✅ Signal envoyé - attente données...\n\n");
+    // ═══════════════════════════════════════════════════════
+    // ÉTAPES 12-14 (VARIANTE -M) : CACHE D'ENREGISTREMENTS
+    // ═══════════════════════════════════════════════════════
+    // Zéro-copie depuis des buffers "de l'application" : le coût de
+    // ibv_reg_mr à chaque transfert, puis ce qu'il en reste avec
+    // le cache (rdma_mrcache.h).
+    
+    if (mrcache_mode) {
+        printf("🗂️  CACHE D'ENREGISTREMENTS (RDMA_WRITE de %zu o, %ld échantillons)\n",
+               msg_size, iters);
+        
+        struct bench_opts bopts = {
+            .op = BENCH_WRITE,
+            .size = msg_size,
+            .iters = iters,
+            .warmup = warmup,
+        };
+        if (bench_mrcache(&bconn, pd, &bopts)) {
+            status = 1;
+            goto cleanup;
+        }
+        printf("\n");
+        
+        goto quit;
+    }
     
     // ═══════════════════════════════════════════════════════
-    // ÉTAPE 14 : MESURER LA LATENCE RÉELLE
+    // ÉTAPES 12-14 (VARIANTE -F) : PREMIER ACCÈS / ACCÈS CHAUD
     // ═══════════════════════════════════════════════════════
-    struct timespec latency_start, latency_end;
-    clock_gettime(CLOCK_MONOTONIC, &latency_start);
+    // Utile face à un serveur en ODP (-O odp / implicit) : ce que
+    // coûte une page que la carte du serveur doit d'abord fauter.
+    
+    if (touch_mode) {
+        printf("👆 PREMIER ACCÈS / ACCÈS CHAUD (RDMA_READ de %zu o, %ld pages)\n",
+               msg_size, iters);
+        
+        struct bench_opts bopts = {
+            .op = BENCH_READ,
+            .size = msg_size,
+            .iters = iters,
+        };
+        if (bench_first_touch(&bconn, &bopts)) {
+            status = 1;
+            goto cleanup;
+        }
+        printf("\n");
+        
+        goto quit;
+    }
     
-    printf("📖 ÉTAPE 14 : Réception données serveur\n");
+    // ═══════════════════════════════════════════════════════
+    // ÉTAPES 12-14 (VARIANTE -S) : BALAYAGE DES TAILLES
+    // ═══════════════════════════════════════════════════════
+    // Latence PUIS débit pour 1, 2, 4, ... octets, jusqu'au plus
+    // petit des deux buffers (local -b, RAM serveur).
+    // → Tableau CSV / JSON dans -o (ou sur la sortie standard)
+    // → Progression sur stderr
+    
+    if (sweep_mode) {
+        size_t max_size = buf_size < server_info.size ? buf_size : server_info.size;
+        
+        printf("📈 BALAYAGE DES TAILLES : 1 → %zu octets\n", max_size);
+        
+        enum bench_op ops[NUM_BENCH_OPS];
+        int num_ops = 0;
+        for (int i = 0; i < NUM_BENCH_OPS; i++) {
+            if (mode & bench_ops[i].flag)
+                ops[num_ops++] = bench_ops[i].op;
+        }
+        
+        FILE *out = stdout;
+        if (sweep_path) {
+            out = fopen(sweep_path, "w");
+            if (!out) {
+                perror("   ❌ fopen (-o)");
+                status = 1;
+                goto cleanup;
+            }
+        }
+        fflush(stdout);
+        
+        struct sweep_opts sw = {
+            .ops = ops,
+            .num_ops = num_ops,
+            .min_size = 1,
+            .max_size = max_size,
+            .base = {
+                .queue_depth = queue_depth,
+                .signal_every = signal_every,
+                .batch = batch,
+                .duration_s = duration_s,
+                .iters = iters,
+                .warmup = warmup,
+            },
+            .format = sweep_format,
+            .out = out,
+        };
+        
+        ret = bench_sweep(&bconn, &sw);
+        if (out != stdout)
+            fclose(out);
+        if (ret) {
+            status = 1;
+            goto cleanup;
+        }
+        if (sweep_path)
+            printf("   ✅ Tableau écrit dans %s\n", sweep_path);
+        printf("\n");
+        
+        goto quit;
+    }
     
-    // Attendre la réception des données
-    while (ibv_poll_cq(cq, 1, &wc) < 1);
+    // ═══════════════════════════════════════════════════════
+    // ÉTAPE 12 : SEND/RECV - LE CHEMIN "CLASSIQUE" (TWO-SIDED)
+    // ═══════════════════════════════════════════════════════
+    // CONCRÈTEMENT :
+    // 1. Je poste un RECV pour la réponse
+    // 2. J'envoie CMD_PING (0 octet, tout dans l'immediate data)
+    // 3. LE CPU DU SERVEUR se réveille, poste un SEND de DATA_SIZE octets
+    // 4. Mon RECV se complète
+    //
+    // → C'est la référence : même principe qu'un aller-retour TCP
+    // → Latence mesurée = aller-retour complet (PING → données)
+    
+    if (mode & MODE_SEND) {
+        printf("📨 ÉTAPE 12 : SEND/RECV (le CPU serveur répond)\n");
+        
+        char *reply = reply_buf->addr;
+        memset(reply, 0, DATA_SIZE);
+        
+        struct ibv_sge recv_data_sge;
+        recv_data_sge.addr = (uint64_t)reply;
+        recv_data_sge.length = DATA_SIZE;
+        recv_data_sge.lkey = reply_buf->lkey;
+        
+        struct ibv_recv_wr recv_data_wr, *bad_recv_data_wr;
+        memset(&recv_data_wr, 0, sizeof(recv_data_wr));
+        recv_data_wr.wr_id = 10;
+        recv_data_wr.sg_list = &recv_data_sge;
+        recv_data_wr.num_sge = 1;
+        
+        ret = ibv_post_recv(cm_id->qp, &recv_data_wr, &bad_recv_data_wr);
+        if (ret) {
+            perror("   ❌ ibv_post_recv (données)");
+            status = 1;
+            goto cleanup;
+        }
+        
+        struct timespec t0, t1;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        
+        ret = post_cmd(cm_id->qp, 20, CMD_PING, DATA_SIZE);
+        if (ret) {
+            perror("   ❌ ibv_post_send (ping)");
+            status = 1;
+            goto cleanup;
+        }
+        
+        // Deux complétions attendues : SEND (ping) + RECV (données)
+        // L'ordre d'arrivée dans la CQ n'est pas garanti
+        int got_recv = 0, got_send = 0;
+        while (!got_recv || !got_send) {
+            if (wait_wc(&cqw, &wc, "SEND/RECV")) {
+                status = 1;
+                goto cleanup;
+            }
+            if (wc.opcode == IBV_WC_RECV) {
+                clock_gettime(CLOCK_MONOTONIC, &t1);
+                got_recv = 1;
+            } else {
+                got_send = 1;
+            }
+        }
+        lat_send_ns = elapsed_ns(&t0, &t1);
+        
+        reply[DATA_SIZE - 1] = '\0';        // Terminer la chaîne
+        printf("   ✅ Reçu : '%s'\n", reply);
+        printf("   ⏱️  Aller-retour : %.2f μs\n\n", lat_send_ns / 1000.0);
+    }
     
-    clock_gettime(CLOCK_MONOTONIC, &latency_end);
+    // ═══════════════════════════════════════════════════════
+    // ÉTAPE 13 : RDMA READ - LIRE LA RAM DU SERVEUR
+    // ═══════════════════════════════════════════════════════
+    // ✨ LA MAGIE COMMENCE ! ✨
+    //
+    // QU'EST-CE QUI SE PASSE CONCRÈTEMENT ?
+    //
+    // 1. Je prépare une requête RDMA_READ
+    // 2. Je spécifie :
+    //    - Où stocker les données lues (mon buffer local)
+    //    - D'où lire (server_info.addr)
+    //    - La clé d'accès (server_info.rkey)
+    // 3. J'envoie la requête à ma carte InfiniBand
+    // 4. MA CARTE parle à la CARTE SERVEUR
+    // 5. LA CARTE SERVEUR lit sa RAM et envoie les données
+    // 6. MA CARTE reçoit et écrit dans mon buffer local
+    // 7. LE CPU DU SERVEUR N'A JAMAIS ÉTÉ RÉVEILLÉ ! 😴
     
-    // Calculer la latence en microsecondes
-    long latency_us = (latency_end.tv_sec - latency_start.tv_sec) * 1000000 +
-                      (latency_end.tv_nsec - latency_start.tv_nsec) / 1000;
+    if (mode & MODE_READ) {
+        printf("📖 ÉTAPE 13 : RDMA_READ (one-sided)\n");
+        
+        memset(rdma_buffer, 0, DATA_SIZE);
+        
+        struct timespec t0, t1;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        
+        ret = post_rdma_op(cm_id->qp, IBV_WR_RDMA_READ, 30,
+                           rdma_buffer, DATA_SIZE, rdma_mr->lkey,
+                           server_info.addr, server_info.rkey,
+                           IBV_SEND_SIGNALED);
+        if (ret) {
+            perror("   ❌ ibv_post_send (RDMA_READ)");
+            status = 1;
+            goto cleanup;
+        }
+        if (wait_wc(&cqw, &wc, "RDMA_READ")) {
+            status = 1;
+            goto cleanup;
+        }
+        
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        lat_read_ns = elapsed_ns(&t0, &t1);
+        
+        rdma_buffer[DATA_SIZE - 1] = '\0';
+        printf("   ✅ Lu dans la RAM serveur : '%s'\n", rdma_buffer);
+        printf("   ⏱️  Latence : %.2f μs\n\n", lat_read_ns / 1000.0);
+    }
     
-    if (wc.status != IBV_WC_SUCCESS) {
-        printf("   ❌ Réception données échouée (code: %d)\n", wc.status);
-        ibv_dereg_mr(rdma_mr);
-        ibv_dereg_mr(recv_mr);
-        ibv_destroy_qp(cm_id->qp);
-        ibv_destroy_cq(cq);
-        ibv_dealloc_pd(pd);
-        rdma_disconnect(cm_id);
-        rdma_destroy_id(cm_id);
-        rdma_destroy_event_channel(cm_channel);
-        return 1;
+    // ═══════════════════════════════════════════════════════
+    // ÉTAPE 14 : RDMA WRITE + RDMA READ DE VÉRIFICATION
+    // ═══════════════════════════════════════════════════════
+    // CONCRÈTEMENT :
+    // 1. RDMA_WRITE : ma carte écrit CLIENT_MSG dans la RAM serveur
+    // 2. RDMA_READ  : je relis la même zone dans un AUTRE buffer local
+    // 3. Je compare → si identique, l'écriture a bien atterri
+    //
+    // → Page-out InfiniSwap = exactement ce RDMA_WRITE
+    
+    if (mode & MODE_WRITE) {
+        printf("✍️  ÉTAPE 14 : RDMA_WRITE (one-sided) + vérification\n");
+        
+        char *write_src = rdma_buffer;
+        char *verify_dst = rdma_buffer + DATA_SIZE;
+        
+        memset(write_src, 0, DATA_SIZE);
+        memset(verify_dst, 0, DATA_SIZE);
+        strcpy(write_src, CLIENT_MSG);
+        
+        struct timespec t0, t1;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        
+        ret = post_rdma_op(cm_id->qp, IBV_WR_RDMA_WRITE, 40,
+                           write_src, DATA_SIZE, rdma_mr->lkey,
+                           server_info.addr, server_info.rkey,
+                           IBV_SEND_SIGNALED |
+                           inline_flag(max_inline, IBV_WR_RDMA_WRITE, DATA_SIZE));
+        if (ret) {
+            perror("   ❌ ibv_post_send (RDMA_WRITE)");
+            status = 1;
+            goto cleanup;
+        }
+        if (wait_wc(&cqw, &wc, "RDMA_WRITE")) {
+            status = 1;
+            goto cleanup;
+        }
+        
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        lat_write_ns = elapsed_ns(&t0, &t1);
+        
+        ret = post_rdma_op(cm_id->qp, IBV_WR_RDMA_READ, 41,
+                           verify_dst, DATA_SIZE, rdma_mr->lkey,
+                           server_info.addr, server_info.rkey,
+                           IBV_SEND_SIGNALED);
+        if (ret) {
+            perror("   ❌ ibv_post_send (RDMA_READ vérif)");
+            status = 1;
+            goto cleanup;
+        }
+        if (wait_wc(&cqw, &wc, "RDMA_READ (vérif)")) {
+            status = 1;
+            goto cleanup;
+        }
+        
+        if (memcmp(write_src, verify_dst, DATA_SIZE) != 0) {
+            printf("   ❌ Vérification échouée : relu '%.*s'\n",
+                   DATA_SIZE, verify_dst);
+            status = 1;
+            goto cleanup;
+        }
+        
+        printf("   ✅ Écrit puis relu : '%s'\n", verify_dst);
+        printf("   ⏱️  Latence WRITE : %.2f μs\n\n", lat_write_ns / 1000.0);
     }
     
-    rdma_buffer[99] = '\0';  // Terminer la chaîne
+    // ═══════════════════════════════════════════════════════
+    // ÉTAPE 15 : COMPARAISON + FIN DE SESSION
+    // ═══════════════════════════════════════════════════════
+    // CMD_QUIT prévient le serveur qu'il peut libérer la connexion
+    // (sinon il ne sait pas quand nos RDMA_READ/WRITE sont finis)
     
-    printf("   ✨ DONNÉES REÇUES ! ✨\n");
     printf("   ┌─────────────────────────────────────────────┐\n");
-    printf("   │ Contenu reçu du serveur :                   │\n");
-    printf("   │ '%s'    │\n", rdma_buffer);
-    printf("   │                                             │\n");
-    printf("   │ ✓ Le serveur ne s'est PAS réveillé !        │\n");
-    printf("   │ ✓ Sa carte InfiniBand a géré seule !        │\n");
-    printf("   │ ✓ Latence RÉELLE mesurée : %ld μs          │\n", latency_us);
-    printf("   │ ✓ (vs ~500 μs pour TCP/IP)                │\n");
+    printf("   │ LATENCES (même connexion, %3d octets)       │\n", DATA_SIZE);
+    printf("   ├─────────────────────────────────────────────┤\n");
+    if (lat_send_ns >= 0)
+        printf("   │ SEND/RECV  (CPU serveur) : %10.2f μs    │\n", lat_send_ns / 1000.0);
+    if (lat_read_ns >= 0)
+        printf("   │ RDMA_READ  (one-sided)   : %10.2f μs    │\n", lat_read_ns / 1000.0);
+    if (lat_write_ns >= 0)
+        printf("   │ RDMA_WRITE (one-sided)   : %10.2f μs    │\n", lat_write_ns / 1000.0);
+    printf("   │ (1 seule mesure : -L pour p50/p99/p99.9)    │\n");
     printf("   └─────────────────────────────────────────────┘\n\n");
     
+quit:
+    ret = post_cmd(cm_id->qp, 50, CMD_QUIT, 0);
+    if (ret || wait_wc(&cqw, &wc, "SEND (quit)")) {
+        printf("   ⚠️  CMD_QUIT non envoyé (le serveur verra la déconnexion)\n");
+    }
+    
+cleanup:
     // Cleanup - ORDRE CRITIQUE POUR RDMA !
     // 1. Disconnect RDMA en premier (avant destruction QP)
     rdma_disconnect(cm_id);
@@ -552,23 +1795,33 @@ int main(int argc, char *argv[]) {
         drain_count++;
     }
     
-    // 4. Destroy CQ
-    ibv_destroy_cq(cq);
-    
-    // 5. Deregister MRs
-    ibv_dereg_mr(rdma_mr);
-    ibv_dereg_mr(recv_mr);
+    // 4. Destroy CQ (+ completion channel)
+    if (cq_mode != CQ_MODE_POLL)
+        printf("💤 CQ : endormi %lu fois (mode %s)\n", cqw.sleeps,
+               cq_mode_name(cq_mode));
+    cq_waiter_destroy(&cqw);
+    
+    // 5. Deregister MRs (+ chunks du pool)
+    if (ring_mr)
+        ibv_dereg_mr(ring_mr);
+    free(ring_mem);
+    mrc_put(&mrc, rdma_ent);
+    mrc_destroy(&mrc);
+    pool_put(&pool, reply_buf);
+    pool_destroy(&pool);
+    mem_region_free(&local_region);
     
     // 6. Deallocate PD
     ibv_dealloc_pd(pd);
     
     // 7-9. RDMA cleanup
     rdma_destroy_id(cm_id);
+    cm_loop_destroy(&cm_loop);
     rdma_destroy_event_channel(cm_channel);
     
     printf("═══════════════════════════════════════════════════\n");
     printf("    FIN DU CLIENT\n");
     printf("═══════════════════════════════════════════════════\n");
     
-    return 0;
+    return status;
 }
\ No newline at end of file
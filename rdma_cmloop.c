@@ -0,0 +1,206 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA CMLOOP - Boucle d'événements CM non bloquante (epoll)
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * Voir rdma_cmloop.h
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+
+#include "rdma_cmloop.h"
+
+int cm_loop_init(struct cm_loop *l, struct rdma_event_channel *ch) {
+    l->ch = ch;
+    l->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (l->epfd < 0) {
+        perror("   ❌ epoll_create1");
+        return -1;
+    }
+    int flags = fcntl(ch->fd, F_GETFL);
+    if (fcntl(ch->fd, F_SETFL, flags | O_NONBLOCK) ||
+        cm_loop_add(l, ch->fd, CM_LOOP_TAG_CM)) {
+        perror("   ❌ Canal CM non bloquant");
+        cm_loop_destroy(l);
+        return -1;
+    }
+    return 0;
+}
+
+int cm_loop_add(struct cm_loop *l, int fd, int tag) {
+    struct epoll_event ev = { .events = EPOLLIN, .data.u32 = tag };
+    return epoll_ctl(l->epfd, EPOLL_CTL_ADD, fd, &ev);
+}
+
+int64_t cm_loop_wait(struct cm_loop *l, int timeout_ms) {
+    struct epoll_event evs[8];
+    int64_t ready = 0;
+
+    int n = epoll_wait(l->epfd, evs, 8, timeout_ms);
+    if (n < 0)
+        return errno == EINTR ? 0 : -1;
+    for (int i = 0; i < n; i++)
+        ready |= 1LL << evs[i].data.u32;
+    return ready;
+}
+
+int cm_loop_next(struct cm_loop *l, struct rdma_cm_event **event) {
+    if (rdma_get_cm_event(l->ch, event) == 0)
+        return 1;
+    return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+}
+
+void cm_loop_destroy(struct cm_loop *l) {
+    if (l->epfd >= 0)
+        close(l->epfd);
+    l->epfd = -1;
+}
+
+// ═══════════════════════════════════════════════════════
+// MACHINE À ÉTATS D'UNE CONNEXION ACTIVE
+// ═══════════════════════════════════════════════════════
+// Un événement ne fait JAMAIS échouer une autre connexion que la
+// sienne ; un événement qui n'a pas de sens dans l'état courant
+// (un DISCONNECTED tardif après un échec...) est ignoré.
+
+static void set_state(struct cm_conn *c, enum cm_state state) {
+    c->state = state;
+    if (c->on_state)
+        c->on_state(c);
+}
+
+static void cm_conn_event(struct cm_conn *c, const struct rdma_cm_event *event) {
+    c->why = event->event;
+
+    switch (event->event) {
+    case RDMA_CM_EVENT_ADDR_RESOLVED:
+        if (c->state != CM_ADDR)
+            break;
+        if (rdma_resolve_route(c->id, CM_TIMEOUT_MS))
+            set_state(c, CM_FAILED);
+        else
+            set_state(c, CM_ROUTE);
+        break;
+    case RDMA_CM_EVENT_ROUTE_RESOLVED:
+        if (c->state == CM_ROUTE)
+            set_state(c, CM_ROUTED);
+        break;
+    case RDMA_CM_EVENT_ESTABLISHED:
+        if (c->state != CM_CONNECTING)
+            break;
+        // Lues AVANT l'ACK, qui libère l'événement
+        if (conn_info_parse(event->param.conn.private_data,
+                            event->param.conn.private_data_len, &c->info))
+            set_state(c, CM_FAILED);
+        else
+            set_state(c, CM_UP);
+        break;
+    case RDMA_CM_EVENT_DISCONNECTED:
+        if (c->state == CM_UP)
+            set_state(c, CM_DOWN);
+        break;
+    case RDMA_CM_EVENT_TIMEWAIT_EXIT:
+        if (c->state == CM_UP || c->state == CM_DOWN)
+            set_state(c, CM_CLOSED);
+        break;
+    case RDMA_CM_EVENT_ADDR_ERROR:
+    case RDMA_CM_EVENT_ROUTE_ERROR:
+    case RDMA_CM_EVENT_CONNECT_ERROR:
+    case RDMA_CM_EVENT_UNREACHABLE:
+    case RDMA_CM_EVENT_REJECTED:
+    case RDMA_CM_EVENT_DEVICE_REMOVAL:
+        if (c->state < CM_UP)
+            set_state(c, CM_FAILED);
+        else if (c->state == CM_UP)
+            set_state(c, CM_DOWN);
+        break;
+    default:
+        break;
+    }
+}
+
+int64_t cm_loop_run(struct cm_loop *l, int timeout_ms) {
+    int64_t ready = cm_loop_wait(l, timeout_ms);
+    if (ready < 0)
+        return -1;
+
+    // Pas seulement si le canal CM est prêt : un hook a pu lancer
+    // une étape dont l'événement est déjà là
+    struct rdma_cm_event *event;
+    int ret;
+    while ((ret = cm_loop_next(l, &event)) > 0) {
+        struct cm_conn *c = event->id->context;
+        if (c)
+            cm_conn_event(c, event);
+        rdma_ack_cm_event(event);
+    }
+    if (ret < 0)
+        return -1;
+    return ready & ~(1LL << CM_LOOP_TAG_CM);
+}
+
+int cm_conn_start(struct cm_loop *l, struct cm_conn *c,
+                  const struct sockaddr *dst) {
+    if (rdma_create_id(l->ch, &c->id, c, RDMA_PS_TCP)) {
+        c->id = NULL;
+        c->state = CM_FAILED;
+        return -1;
+    }
+    c->state = CM_ADDR;
+    if (rdma_resolve_addr(c->id, NULL, (struct sockaddr *)dst, CM_TIMEOUT_MS)) {
+        c->state = CM_FAILED;
+        return -1;
+    }
+    return 0;
+}
+
+int cm_conn_connect(struct cm_conn *c, struct rdma_conn_param *param) {
+    if (c->state != CM_ROUTED)
+        return -1;
+    c->state = CM_CONNECTING;
+    if (rdma_connect(c->id, param)) {
+        c->state = CM_FAILED;
+        return -1;
+    }
+    return 0;
+}
+
+static long now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000;
+}
+
+enum cm_state cm_conn_wait(struct cm_loop *l, struct cm_conn *c,
+                           int timeout_ms) {
+    long deadline = now_ms() + timeout_ms;
+
+    while (c->state == CM_ADDR || c->state == CM_ROUTE ||
+           c->state == CM_CONNECTING) {
+        long left = deadline - now_ms();
+        if (left <= 0 || cm_loop_run(l, left) < 0)
+            break;
+    }
+    return c->state;
+}
+
+const char *cm_state_name(enum cm_state state) {
+    switch (state) {
+    case CM_IDLE:       return "idle";
+    case CM_ADDR:       return "addr";
+    case CM_ROUTE:      return "route";
+    case CM_ROUTED:     return "routed";
+    case CM_CONNECTING: return "connecting";
+    case CM_UP:         return "up";
+    case CM_DOWN:       return "down";
+    case CM_CLOSED:     return "closed";
+    case CM_FAILED:     return "failed";
+    }
+    return "?";
+}
@@ -0,0 +1,114 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA CMLOOP - Boucle d'événements CM non bloquante (epoll)
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * AVANT : rdma_get_cm_event bloquant, un événement attendu à la fois
+ * ("pas ESTABLISHED ? → return 1").
+ * → Un pair lent bloque tout le monde derrière lui
+ * → REJECTED, DISCONNECTED, TIMEWAIT_EXIT d'une AUTRE connexion
+ *   arrivent au milieu et passent pour des erreurs
+ *
+ * MAINTENANT :
+ * → Le canal CM est non bloquant, surveillé par epoll avec d'autres
+ *   fd (completion channel d'une CQ, par exemple) : un seul endroit
+ *   où dormir
+ * → Chaque réveil vide TOUS les événements prêts ; chacun va à SA
+ *   connexion (event->id->context)
+ * → Côté client, chaque connexion est une machine à états :
+ *
+ *   ADDR ──ADDR_RESOLVED──▶ ROUTE ──ROUTE_RESOLVED──▶ ROUTED
+ *                                          (QP + cm_conn_connect)
+ *   CONNECTING ──ESTABLISHED──▶ UP ──DISCONNECTED──▶ DOWN
+ *                                   ──TIMEWAIT_EXIT──▶ CLOSED
+ *   *_ERROR, UNREACHABLE, REJECTED ──▶ FAILED (why = l'événement)
+ *
+ * Le serveur (côté passif) se sert seulement de la boucle :
+ * cm_loop_wait puis cm_loop_next, et trie lui-même ses événements.
+ */
+
+#ifndef RDMA_CMLOOP_H
+#define RDMA_CMLOOP_H
+
+#include <stdint.h>
+#include <rdma/rdma_cma.h>
+
+#include "rdma_common.h"
+
+#define CM_TIMEOUT_MS   2000    // rdma_resolve_addr / rdma_resolve_route
+#define CM_WAIT_MS      10000   // Une connexion qui n'avance plus
+#define CM_LOOP_TAG_CM  0       // Tag du canal CM dans cm_loop_wait
+
+struct cm_loop {
+    struct rdma_event_channel *ch;
+    int epfd;
+};
+
+enum cm_state {
+    CM_IDLE,
+    CM_ADDR,                    // rdma_resolve_addr en cours
+    CM_ROUTE,                   // rdma_resolve_route en cours
+    CM_ROUTED,                  // Route connue : QP à créer, puis connect
+    CM_CONNECTING,              // rdma_connect en cours
+    CM_UP,                      // ESTABLISHED : info valide
+    CM_DOWN,                    // DISCONNECTED : plus rien ne passe
+    CM_CLOSED,                  // TIMEWAIT_EXIT : QP destructible
+    CM_FAILED,                  // Échec, why = événement responsable
+};
+
+struct cm_conn {
+    struct rdma_cm_id *id;
+    enum cm_state state;
+    enum rdma_cm_event_type why;    // Dernier événement reçu
+    struct rdma_buffer_info info;   // Infos serveur (private_data), en UP
+    // Appelé après chaque changement d'état (NULL : rien). En
+    // CM_ROUTED, c'est là qu'on crée la QP et qu'on appelle
+    // cm_conn_connect ; sinon cm_conn_wait rend la main.
+    void (*on_state)(struct cm_conn *c);
+    void *ctx;
+};
+
+// ─── Boucle ──────────────────────────────────────────────
+
+// Rend ch non bloquant et le surveille (tag CM_LOOP_TAG_CM).
+// Retourne 0 si succès.
+int cm_loop_init(struct cm_loop *l, struct rdma_event_channel *ch);
+
+// Surveille aussi fd (lecture), signalé par le bit tag (1..63)
+int cm_loop_add(struct cm_loop *l, int fd, int tag);
+
+// Dort jusqu'à ce qu'un fd soit prêt (timeout_ms < 0 : sans limite).
+// Retourne le masque des tags prêts (0 si timeout ou signal), -1
+// si erreur.
+int64_t cm_loop_wait(struct cm_loop *l, int timeout_ms);
+
+// Événement suivant, sans attendre. Retourne 1 (à ACK par
+// l'appelant), 0 si plus rien, -1 si erreur.
+int cm_loop_next(struct cm_loop *l, struct rdma_cm_event **event);
+
+// Attend (cm_loop_wait), puis fait avancer chaque cm_conn concernée
+// par les événements prêts (tous ACK). Retourne le masque des autres
+// tags prêts, -1 si erreur.
+int64_t cm_loop_run(struct cm_loop *l, int timeout_ms);
+
+// Ferme epoll (le canal reste à l'appelant)
+void cm_loop_destroy(struct cm_loop *l);
+
+// ─── Connexion active (client) ───────────────────────────
+
+// Crée l'ID (context = c) et lance la résolution d'adresse.
+// Retourne 0 si lancée (sinon c->state = CM_FAILED).
+int cm_conn_start(struct cm_loop *l, struct cm_conn *c,
+                  const struct sockaddr *dst);
+
+// En CM_ROUTED, QP créée : lance rdma_connect. Retourne 0 si lancé.
+int cm_conn_connect(struct cm_conn *c, struct rdma_conn_param *param);
+
+// Fait tourner la boucle tant que c est en transition (ADDR, ROUTE,
+// CONNECTING), au plus timeout_ms. Retourne l'état atteint.
+enum cm_state cm_conn_wait(struct cm_loop *l, struct cm_conn *c,
+                           int timeout_ms);
+
+const char *cm_state_name(enum cm_state state);
+
+#endif /* RDMA_CMLOOP_H */
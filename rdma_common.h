@@ -0,0 +1,165 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA COMMON - Définitions partagées client / serveur
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * Tout ce que le client ET le serveur doivent voir de la même façon :
+ * → Port d'écoute, taille de la RAM exposée
+ * → Format des messages de contrôle échangés par SEND/RECV
+ */
+
+#ifndef RDMA_COMMON_H
+#define RDMA_COMMON_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RDMA_PORT   12345
+#define BUFFER_SIZE (1024*1024)  // RAM exposée / buffer local par défaut (-b)
+#define DATA_SIZE   100          // Taille du message de démo
+#define RDMA_PAGE_SIZE 4096      // Une page distante (rdma_page.h)
+
+// Un anneau de messages (rdma_ring.h), décrit pour celui qui y
+// ÉCRIT : le client envoie le sien dans la private_data de
+// rdma_connect (16 octets, les 56 d'un REQ suffisent), le serveur
+// répond avec le sien dans l'accept
+struct ring_desc {
+    uint64_t addr;
+    uint32_t rkey;
+    uint16_t slots;         // Nombre de slots (≤ RING_SLOTS_MAX)
+    uint16_t slot_shift;    // Un slot = 1 << slot_shift octets
+};
+
+// Structure pour transmettre les infos RDMA au client
+// → Voyage dans la private_data de rdma_accept : le client l'a dans
+//   son événement ESTABLISHED, sans SEND ni RECV posté d'avance
+//   (un aller-retour de moins avant le premier octet)
+// → 48 octets : tient dans les 196 octets d'un REP InfiniBand
+struct rdma_buffer_info {
+    uint64_t addr;      // Adresse virtuelle de la RAM serveur
+    uint32_t rkey;      // Clé d'accès RDMA (Remote Key)
+    uint32_t max_send;  // Plus grand SEND accepté / renvoyé (octets)
+    uint64_t size;      // Taille de la RAM exposée (octets)
+    uint32_t flags;     // INFO_* : ce que la RKEY permet en plus
+    uint32_t mbox;      // Boîte aux lettres PUT de CETTE connexion
+                        // (rdma_kv.h), KV_NO_MBOX si aucune
+    struct ring_desc ring;  // Anneau du serveur pour CETTE connexion
+                            // (si INFO_RING)
+};
+
+// La RAM serveur accepte FETCH_AND_ADD / COMPARE_AND_SWAP
+// (IBV_ACCESS_REMOTE_ATOMIC, voir rdma_atomic.h)
+#define INFO_ATOMIC 0x1
+// La RAM serveur est une table clé-valeur (serveur lancé avec -K,
+// voir rdma_kv.h)
+#define INFO_KV     0x2
+// Le serveur a un anneau pour nous (le client en a demandé un dans
+// son connect, voir rdma_ring.h)
+#define INFO_RING   0x4
+
+// private_data d'un ESTABLISHED → info. La carte peut compléter
+// avec des zéros (longueur >= ce qu'on a envoyé), jamais tronquer.
+// Retourne 0 si succès, -1 si trop court (serveur trop ancien).
+static inline int conn_info_parse(const void *data, size_t len,
+                                  struct rdma_buffer_info *info) {
+    if (!data || len < sizeof(*info))
+        return -1;
+    memcpy(info, data, sizeof(*info));
+    return info->rkey || info->size ? 0 : -1;
+}
+
+// ═══════════════════════════════════════════════════════
+// COMMANDES CLIENT → SERVEUR (SEND_WITH_IMM, 0 octet)
+// ═══════════════════════════════════════════════════════
+// La commande voyage ENTIÈREMENT dans l'immediate data (32 bits) :
+//   [31..24] = commande   [23..0] = argument
+//
+// CMD_PING : "renvoie-moi <arg> octets" (chemin SEND/RECV)
+//            arg = 0 → DATA_SIZE octets
+// CMD_QUIT : "j'ai fini" → le serveur peut libérer la connexion
+// CMD_KV_PUT : arrive par RDMA_WRITE_WITH_IMM, pas par SEND : la
+//            requête (arg octets) est déjà dans la boîte aux
+//            lettres de la connexion (rdma_kv.h) ; le serveur
+//            répond par un SEND_WITH_IMM de 0 octet (arg = statut)
+// CMD_RING_MSG / CMD_RING_CREDIT : RDMA_WRITE_WITH_IMM dans
+//            l'anneau du pair, dans les DEUX sens (rdma_ring.h)
+//
+// POURQUOI 0 OCTET ?
+// → Les RECV sont consommés dans l'ordre, quel que soit le message
+// → Une commande de 0 octet tient dans n'importe quel RECV
+// → Un SEND SANS immediate = données "puits" (benchmark SEND) :
+//   le serveur les compte et les jette
+//
+// Les opérations RDMA_READ / RDMA_WRITE n'ont PAS de commande :
+// le CPU du serveur n'est jamais prévenu.
+
+enum rdma_cmd {
+    CMD_PING = 1,
+    CMD_QUIT = 2,
+    CMD_KV_PUT = 3,
+    CMD_RING_MSG = 4,
+    CMD_RING_CREDIT = 5,
+};
+
+#define CMD_ARG_MAX         0xFFFFFF
+#define CMD_IMM(cmd, arg)   (((uint32_t)(cmd) << 24) | ((uint32_t)(arg) & CMD_ARG_MAX))
+#define CMD_IMM_CMD(imm)    ((imm) >> 24)
+#define CMD_IMM_ARG(imm)    ((imm) & CMD_ARG_MAX)
+
+// ═══════════════════════════════════════════════════════
+// PROFONDEURS DE FILES
+// ═══════════════════════════════════════════════════════
+// MAX_QUEUE_DEPTH : opérations en vol max côté client (benchmark)
+// SRV_SRQ_DEPTH   : RECV postés par le serveur, PAR CARTE, dans un
+//                   Shared Receive Queue commun à tous ses clients
+// SRV_SRQ_LIMIT   : seuil bas du SRQ ; en dessous, le serveur le
+//                   re-remplit (IBV_EVENT_SRQ_LIMIT_REACHED)
+// → Un client à pleine profondeur ne descend jamais sous le seuil
+// ECHO_WINDOW_MAX : requêtes (PING, anneau) en vol par connexion ;
+//                   le serveur a autant de réponses à poster
+
+#define MAX_QUEUE_DEPTH 1024
+#define ECHO_WINDOW_MAX 64
+#define SRV_SRQ_DEPTH   (4 * MAX_QUEUE_DEPTH)
+#define SRV_SRQ_LIMIT   MAX_QUEUE_DEPTH
+
+// Complétions récoltées par appel à ibv_poll_cq (client ET serveur)
+// → Un appel coûte ~50-100 ns : à plusieurs Mops/s, un CQE par
+//   appel devient LE goulot
+#define POLL_BATCH      32
+
+// ═══════════════════════════════════════════════════════
+// SEND INLINE
+// ═══════════════════════════════════════════════════════
+// IBV_SEND_INLINE : le CPU copie les données DANS le WR.
+// → La carte n'a plus à relire le buffer par DMA : un aller-retour
+//   PCIe en moins, ~0.2-0.5 μs gagnées sur les petits messages
+// → Pas besoin de MR (la LKEY est ignorée), buffer réutilisable
+//   dès le retour de ibv_post_send
+// → SEND / RDMA_WRITE seulement (jamais RDMA_READ)
+//
+// max_inline_data est demandé à la création de la QP ; la carte
+// répond avec ce qu'elle accepte vraiment (souvent 2xx-9xx octets).
+#define INLINE_DEFAULT  220
+
+// Les SEND (dans les deux sens) sont plafonnés par :
+// → l'argument de CMD_PING (24 bits : 16 MB - 1, 0 voulant dire
+//   DATA_SIZE)
+// → la taille du puits du serveur, qui ne grossit PAS avec -b
+#define MAX_SEND_SIZE   CMD_ARG_MAX         // 16 MB - 1
+
+// "4096", "64K", "1M", "4G" → octets (0 si invalide)
+static inline size_t parse_size(const char *str) {
+    char *end;
+    unsigned long long v = strtoull(str, &end, 0);
+
+    switch (*end) {
+    case 'k': case 'K': v <<= 10; end++; break;
+    case 'm': case 'M': v <<= 20; end++; break;
+    case 'g': case 'G': v <<= 30; end++; break;
+    }
+    return (*end == '\0' && end != str) ? v : 0;
+}
+
+#endif /* RDMA_COMMON_H */
@@ -0,0 +1,311 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA CONNRATE - Connexions par seconde et temps jusqu'au 1er octet
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * Voir rdma_connrate.h
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <arpa/inet.h>
+#include <rdma/rdma_cma.h>
+
+#include "rdma_common.h"
+#include "rdma_bench.h"
+#include "rdma_hist.h"
+#include "rdma_connrate.h"
+#include "rdma_cmloop.h"
+
+#define CR_SEND_DEPTH  4            // Le 1er READ, et de la marge
+#define CR_DEADLINE_S  30           // Palier abandonné s'il n'avance plus
+#define CR_TAG_CQ      1            // Completion channel dans la boucle
+
+struct cr_round;
+
+struct cr_conn {
+    int idx;
+    struct cm_conn cm;              // Machine à états (rdma_cmloop.h)
+    struct cr_round *r;
+    uint64_t t0;                    // Ticks au rdma_resolve_addr
+    int done;                       // 1er octet lu, ou échec
+};
+
+struct cr_round {
+    const struct connrate_opts *o;
+    struct cm_loop loop;
+    struct ibv_comp_channel *cc;
+    struct ibv_cq *cq;              // UNE CQ pour toutes les QP
+    struct cr_conn *conns;
+    int started, finished, established, failed;
+    struct hist connect, first;     // ns depuis rdma_resolve_addr
+};
+
+static void cr_fail(struct cr_round *r, struct cr_conn *c, const char *why) {
+    if (c->done)
+        return;
+    c->done = 1;
+    r->failed++;
+    r->finished++;
+    if (r->failed == 1)             // Le premier suffit à comprendre
+        printf("   ⚠️  [connexion %d] %s\n", c->idx, why);
+}
+
+// ═══════════════════════════════════════════════════════
+// UN CHANGEMENT D'ÉTAT = UNE CONNEXION QUI AVANCE D'UN CRAN
+// ═══════════════════════════════════════════════════════
+// Les étapes du client, sans attendre entre elles : pendant qu'une
+// connexion résout sa route, les autres se connectent.
+
+static void cr_on_route(struct cr_round *r, struct cr_conn *c) {
+    const struct connrate_opts *o = r->o;
+
+    if (c->cm.id->verbs != o->pd->context) {
+        cr_fail(r, c, "route par une autre carte que le PD");
+        return;
+    }
+
+    // Rien à créer que la QP : PD et CQ sont déjà là
+    struct ibv_qp_init_attr qp_attr;
+    memset(&qp_attr, 0, sizeof(qp_attr));
+    qp_attr.send_cq = r->cq;
+    qp_attr.recv_cq = r->cq;
+    qp_attr.qp_type = IBV_QPT_RC;
+    qp_attr.cap.max_send_wr = CR_SEND_DEPTH;
+    qp_attr.cap.max_recv_wr = 1;
+    qp_attr.cap.max_send_sge = 1;
+    qp_attr.cap.max_recv_sge = 1;
+    if (rdma_create_qp(c->cm.id, o->pd, &qp_attr)) {
+        cr_fail(r, c, "rdma_create_qp");
+        return;
+    }
+
+    struct rdma_conn_param conn_param;
+    memset(&conn_param, 0, sizeof(conn_param));
+    conn_param.initiator_depth = 1;     // Un seul READ en vol
+    conn_param.responder_resources = 1;
+    conn_param.retry_count = 7;
+    conn_param.rnr_retry_count = 7;
+    if (cm_conn_connect(&c->cm, &conn_param))
+        cr_fail(r, c, "rdma_connect");
+}
+
+// Infos du serveur dans l'événement : le 1er RDMA_READ part tout
+// de suite (8 octets au début de la RAM serveur)
+static void cr_on_up(struct cr_round *r, struct cr_conn *c) {
+    const struct connrate_opts *o = r->o;
+
+    hist_record(&r->connect, bench_ticks_to_ns(bench_now() - c->t0));
+    r->established++;
+
+    struct ibv_sge sge = {
+        .addr = (uint64_t)(o->buf + ((size_t)c->idx * 64) % (o->buf_size & ~(size_t)63)),
+        .length = 8,
+        .lkey = o->lkey,
+    };
+    struct ibv_send_wr wr, *bad_wr;
+    memset(&wr, 0, sizeof(wr));
+    wr.wr_id = c->idx;
+    wr.sg_list = &sge;
+    wr.num_sge = 1;
+    wr.opcode = IBV_WR_RDMA_READ;
+    wr.send_flags = IBV_SEND_SIGNALED;
+    wr.wr.rdma.remote_addr = c->cm.info.addr;
+    wr.wr.rdma.rkey = c->cm.info.rkey;
+    if (ibv_post_send(c->cm.id->qp, &wr, &bad_wr))
+        cr_fail(r, c, "ibv_post_send (1er READ)");
+}
+
+static void cr_on_state(struct cm_conn *cm) {
+    struct cr_conn *c = cm->ctx;
+    struct cr_round *r = c->r;
+
+    switch (cm->state) {
+    case CM_ROUTED:
+        cr_on_route(r, c);
+        break;
+    case CM_UP:
+        cr_on_up(r, c);
+        break;
+    case CM_FAILED:
+    case CM_DOWN:
+        cr_fail(r, c, cm->why == RDMA_CM_EVENT_ESTABLISHED ?
+                "pas d'infos serveur dans l'accept" : rdma_event_str(cm->why));
+        break;
+    default:
+        break;
+    }
+}
+
+// 1ers READ terminés : wr_id = numéro de la connexion. Réveil par
+// le completion channel : ACK, ré-armer, PUIS vider (une complétion
+// arrivée entre les deux n'est pas perdue)
+static void cr_poll(struct cr_round *r) {
+    struct ibv_wc wcs[POLL_BATCH];
+    struct ibv_cq *ev_cq;
+    void *ev_ctx;
+
+    if (ibv_get_cq_event(r->cc, &ev_cq, &ev_ctx) == 0)
+        ibv_ack_cq_events(ev_cq, 1);
+    ibv_req_notify_cq(r->cq, 0);
+
+    int n;
+    while ((n = ibv_poll_cq(r->cq, POLL_BATCH, wcs)) > 0) {
+        uint64_t now = bench_now();
+        for (int i = 0; i < n; i++) {
+            struct cr_conn *c = &r->conns[wcs[i].wr_id];
+            if (c->done)
+                continue;
+            if (wcs[i].status != IBV_WC_SUCCESS) {
+                cr_fail(r, c, ibv_wc_status_str(wcs[i].status));
+                continue;
+            }
+            hist_record(&r->first, bench_ticks_to_ns(now - c->t0));
+            c->done = 1;
+            r->finished++;
+        }
+    }
+}
+
+// ═══════════════════════════════════════════════════════
+// UN PALIER : count CONNEXIONS, concurrency EN VOL À LA FOIS
+// ═══════════════════════════════════════════════════════
+// Une seule boucle epoll (rdma_cmloop.h) dort sur le canal CM ET
+// sur le completion channel de la CQ partagée : événements CM et
+// 1ers READ sont traités dès qu'ils arrivent, sans spin.
+// Retourne les connexions/s (0 si aucune n'a abouti).
+
+static double cr_round_run(const struct connrate_opts *o, int concurrency,
+                           const char *label) {
+    struct rdma_event_channel *ch = NULL;
+    double rate = 0;
+
+    struct cr_round *r = calloc(1, sizeof(*r));
+    if (!r)
+        return 0;
+    r->o = o;
+    r->loop.epfd = -1;
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(RDMA_PORT);
+    if (inet_pton(AF_INET, o->server_ip, &addr.sin_addr) != 1)
+        goto out;
+    hist_init(&r->connect);
+    hist_init(&r->first);
+
+    r->conns = calloc(o->count, sizeof(*r->conns));
+    ch = rdma_create_event_channel();
+    if (!r->conns || !ch || cm_loop_init(&r->loop, ch)) {
+        perror("   ❌ rdma_create_event_channel");
+        goto out;
+    }
+
+    uint64_t t0 = bench_now();
+    r->cc = ibv_create_comp_channel(o->pd->context);
+    if (r->cc)
+        r->cq = ibv_create_cq(o->pd->context, o->count * CR_SEND_DEPTH, NULL,
+                              r->cc, 0);
+    if (!r->cq) {
+        perror("   ❌ ibv_create_cq");
+        goto out;
+    }
+    double cq_us = bench_ticks_to_ns(bench_now() - t0) / 1000.0;
+    int flags = fcntl(r->cc->fd, F_GETFL);
+    fcntl(r->cc->fd, F_SETFL, flags | O_NONBLOCK);
+    if (cm_loop_add(&r->loop, r->cc->fd, CR_TAG_CQ) ||
+        ibv_req_notify_cq(r->cq, 0)) {
+        perror("   ❌ Completion channel");
+        goto out;
+    }
+
+    t0 = bench_now();
+    uint64_t deadline = CR_DEADLINE_S * 1000000000ULL;
+    while (r->finished < o->count) {
+        while (r->started < o->count &&
+               r->started - r->finished < concurrency) {
+            struct cr_conn *c = &r->conns[r->started];
+            c->idx = r->started++;
+            c->r = r;
+            c->cm.on_state = cr_on_state;
+            c->cm.ctx = c;
+            c->t0 = bench_now();
+            if (cm_conn_start(&r->loop, &c->cm, (struct sockaddr *)&addr))
+                cr_fail(r, c, "rdma_resolve_addr");
+        }
+
+        int64_t ready = cm_loop_run(&r->loop, 100);
+        if (ready < 0) {
+            perror("   ❌ Boucle CM");
+            break;
+        }
+        if (ready & (1LL << CR_TAG_CQ))
+            cr_poll(r);
+
+        if (bench_ticks_to_ns(bench_now() - t0) > deadline) {
+            printf("   ⚠️  Plus rien ne bouge après %d s : palier abandonné\n",
+                   CR_DEADLINE_S);
+            break;
+        }
+    }
+    double ms = bench_ticks_to_ns(bench_now() - t0) / 1e6;
+
+    rate = r->established / (ms / 1000.0);
+    printf("   📊 %-14s : %d/%d établies en %.1f ms → %.0f connexions/s"
+           " (%d échec(s), CQ partagée créée en %.1f μs)\n", label,
+           r->established, o->count, ms, rate, r->failed, cq_us);
+    if (r->connect.total)
+        printf("      connect   : p50 %8.1f μs  p99 %8.1f μs  max %8.1f μs\n",
+               hist_percentile(&r->connect, 50.0) / 1000.0,
+               hist_percentile(&r->connect, 99.0) / 1000.0,
+               r->connect.max / 1000.0);
+    if (r->first.total)
+        printf("      1er octet : p50 %8.1f μs  p99 %8.1f μs  max %8.1f μs\n",
+               hist_percentile(&r->first, 50.0) / 1000.0,
+               hist_percentile(&r->first, 99.0) / 1000.0,
+               r->first.max / 1000.0);
+
+out:
+    // Les événements lus sont tous ACK : rdma_destroy_id ne bloque pas
+    for (int i = 0; r->conns && i < r->started; i++) {
+        struct rdma_cm_id *id = r->conns[i].cm.id;
+        if (!id)
+            continue;
+        if (id->qp) {
+            rdma_disconnect(id);
+            rdma_destroy_qp(id);
+        }
+        rdma_destroy_id(id);
+    }
+    if (r->cq)
+        ibv_destroy_cq(r->cq);
+    if (r->cc)
+        ibv_destroy_comp_channel(r->cc);
+    cm_loop_destroy(&r->loop);
+    if (ch)
+        rdma_destroy_event_channel(ch);
+    free(r->conns);
+    free(r);
+    return rate;
+}
+
+int bench_connect(const struct connrate_opts *o) {
+    if (o->count < 1 || o->count > CONNRATE_MAX) {
+        printf("   ❌ Entre 1 et %d connexions\n", CONNRATE_MAX);
+        return -1;
+    }
+    if (o->buf_size < 64) {
+        printf("   ❌ Buffer local trop petit\n");
+        return -1;
+    }
+
+    double serial = cr_round_run(o, 1, "une à la fois");
+    double burst = cr_round_run(o, o->count, "toutes ensemble");
+    if (serial == 0 || burst == 0)
+        return -1;
+
+    printf("   🚀 En même temps : x%.2f connexions/s\n", burst / serial);
+    return 0;
+}
@@ -0,0 +1,55 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA CONNRATE - Connexions par seconde et temps jusqu'au 1er octet
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * POURQUOI ?
+ * → Des centaines de nœuds de calcul qui redémarrent ensemble
+ *   arrivent tous sur le serveur mémoire en même temps : le temps
+ *   d'établissement devient LE temps de démarrage
+ * → Le chemin classique est en série : adresse, route, PD, CQ, QP,
+ *   connect, puis un SEND d'infos à attendre
+ *
+ * CE QUI EST MESURÉ :
+ * → connect : de rdma_resolve_addr jusqu'à ESTABLISHED
+ * → 1er octet : de rdma_resolve_addr jusqu'à la complétion du
+ *   premier RDMA_READ (les infos arrivent DANS l'accept, voir
+ *   rdma_common.h : rien d'autre à attendre)
+ * → connexions/s : toutes établies / durée du palier
+ *
+ * LE CHEMIN RAPIDE :
+ * → UN canal CM, N demandes en vol à la fois : chaque événement
+ *   fait avancer SA connexion (rdma_cmloop.h), personne n'attend
+ *   personne ; epoll dort sur ce canal ET sur le completion
+ *   channel de la CQ
+ * → PD partagé (celui du client) et UNE CQ pour toutes les QP :
+ *   rien d'autre à créer par connexion que la QP elle-même
+ *
+ * Deux paliers : une connexion à la fois (le chemin série), puis
+ * toutes en même temps.
+ */
+
+#ifndef RDMA_CONNRATE_H
+#define RDMA_CONNRATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <infiniband/verbs.h>
+
+#define CONNRATE_MAX 4096           // Connexions par palier, au plus
+
+struct connrate_opts {
+    const char *server_ip;
+    struct ibv_pd *pd;              // Partagé : toutes les QP sur cette carte
+    char *buf;                      // Cible des 1ers RDMA_READ (8 o chacun)
+    size_t buf_size;
+    uint32_t lkey;
+    int count;                      // Connexions par palier
+};
+
+// Établit count connexions une à une, puis toutes en même temps ;
+// affiche connexions/s et la distribution connect / 1er octet.
+// Retourne 0 si succès.
+int bench_connect(const struct connrate_opts *o);
+
+#endif /* RDMA_CONNRATE_H */
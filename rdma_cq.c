@@ -0,0 +1,200 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA CQ - Attendre des complétions : spin, sommeil, ou les deux
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * Voir rdma_cq.h
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/epoll.h>
+
+#include "rdma_cq.h"
+
+#define CQ_ACK_BATCH    64      // ibv_ack_cq_events prend un mutex
+#define CQ_SPIN_CHECK   256     // Polls entre deux lectures d'horloge
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+int cq_mode_parse(const char *str, enum cq_mode *mode) {
+    if (!strcmp(str, "poll"))        *mode = CQ_MODE_POLL;
+    else if (!strcmp(str, "event"))  *mode = CQ_MODE_EVENT;
+    else if (!strcmp(str, "hybrid")) *mode = CQ_MODE_HYBRID;
+    else return -1;
+    return 0;
+}
+
+const char *cq_mode_name(enum cq_mode mode) {
+    switch (mode) {
+    case CQ_MODE_POLL:   return "poll";
+    case CQ_MODE_EVENT:  return "event";
+    case CQ_MODE_HYBRID: return "hybrid";
+    }
+    return "?";
+}
+
+// ═══════════════════════════════════════════════════════
+// CRÉATION / DESTRUCTION
+// ═══════════════════════════════════════════════════════
+
+int cq_waiter_init(struct cq_waiter *w, struct ibv_context *verbs,
+                   int cqe, enum cq_mode mode, int spin_us) {
+    memset(w, 0, sizeof(*w));
+    w->epfd = -1;
+    w->mode = mode;
+    w->spin_ns = mode == CQ_MODE_HYBRID ? (uint64_t)spin_us * 1000 : 0;
+
+    if (mode != CQ_MODE_POLL) {
+        w->channel = ibv_create_comp_channel(verbs);
+        if (!w->channel) {
+            perror("   ❌ ibv_create_comp_channel");
+            return -1;
+        }
+        // Non bloquant : après un réveil, on vide sans jamais bloquer
+        int flags = fcntl(w->channel->fd, F_GETFL);
+        fcntl(w->channel->fd, F_SETFL, flags | O_NONBLOCK);
+
+        w->epfd = epoll_create1(EPOLL_CLOEXEC);
+        if (w->epfd < 0) {
+            perror("   ❌ epoll_create1");
+            cq_waiter_destroy(w);
+            return -1;
+        }
+        struct epoll_event ev = { .events = EPOLLIN };
+        if (epoll_ctl(w->epfd, EPOLL_CTL_ADD, w->channel->fd, &ev)) {
+            perror("   ❌ epoll_ctl");
+            cq_waiter_destroy(w);
+            return -1;
+        }
+    }
+
+    w->cq = ibv_create_cq(verbs, cqe, NULL, w->channel, 0);
+    if (!w->cq) {
+        perror("   ❌ ibv_create_cq");
+        cq_waiter_destroy(w);
+        return -1;
+    }
+    return 0;
+}
+
+void cq_waiter_destroy(struct cq_waiter *w) {
+    if (w->cq) {
+        // Tout événement reçu doit être ack AVANT ibv_destroy_cq
+        if (w->unacked)
+            ibv_ack_cq_events(w->cq, w->unacked);
+        ibv_destroy_cq(w->cq);
+        w->cq = NULL;
+    }
+    if (w->epfd >= 0) {
+        close(w->epfd);
+        w->epfd = -1;
+    }
+    if (w->channel) {
+        ibv_destroy_comp_channel(w->channel);
+        w->channel = NULL;
+    }
+    w->unacked = 0;
+}
+
+// ═══════════════════════════════════════════════════════
+// S'ENDORMIR JUSQU'À LA PROCHAINE COMPLÉTION
+// ═══════════════════════════════════════════════════════
+// Retourne n > 0 si des complétions sont là (trouvées au
+// re-poll), 0 si réveillé (ou timeout), < 0 si erreur.
+
+static int cq_sleep(struct cq_waiter *w, struct ibv_wc *wc, int max,
+                    int timeout_ms) {
+    if (ibv_req_notify_cq(w->cq, 0)) {
+        printf("   ❌ ibv_req_notify_cq échoué\n");
+        return -1;
+    }
+
+    // Complétion arrivée avant l'armement : pas d'événement pour elle
+    int n = ibv_poll_cq(w->cq, max, wc);
+    if (n != 0)
+        return n;
+
+    w->sleeps++;
+    struct epoll_event ev;
+    int r = epoll_wait(w->epfd, &ev, 1, timeout_ms);
+    if (r < 0 && errno != EINTR) {
+        perror("   ❌ epoll_wait");
+        return -1;
+    }
+    if (r <= 0)
+        return 0;
+
+    struct ibv_cq *ev_cq;
+    void *ev_ctx;
+    while (ibv_get_cq_event(w->channel, &ev_cq, &ev_ctx) == 0) {
+        if (++w->unacked >= CQ_ACK_BATCH) {
+            ibv_ack_cq_events(w->cq, w->unacked);
+            w->unacked = 0;
+        }
+    }
+    return 0;
+}
+
+// ═══════════════════════════════════════════════════════
+// ATTENDRE
+// ═══════════════════════════════════════════════════════
+
+int cq_wait(struct cq_waiter *w, struct ibv_wc *wc, int max, int timeout_ms) {
+    uint64_t start = 0, deadline = UINT64_MAX;
+    int n;
+
+    // Cas courant sous charge : déjà là, sans lire l'horloge
+    n = ibv_poll_cq(w->cq, max, wc);
+    if (n != 0)
+        return n;
+
+    if (timeout_ms >= 0 || w->mode == CQ_MODE_HYBRID) {
+        start = now_ns();
+        if (timeout_ms >= 0)
+            deadline = start + (uint64_t)timeout_ms * 1000000;
+    }
+
+    // 1. Spin (POLL : jusqu'au timeout, HYBRID : pendant spin_ns)
+    if (w->mode != CQ_MODE_EVENT) {
+        uint64_t spin_end = w->mode == CQ_MODE_POLL ? deadline
+                                                    : start + w->spin_ns;
+        for (unsigned int i = 1; ; i++) {
+            n = ibv_poll_cq(w->cq, max, wc);
+            if (n != 0)
+                return n;
+            if (i % CQ_SPIN_CHECK == 0 && spin_end != UINT64_MAX &&
+                now_ns() >= spin_end)
+                break;
+        }
+        if (w->mode == CQ_MODE_POLL)
+            return 0;   // Timeout
+    }
+
+    // 2. Dormir jusqu'à une complétion (ou au timeout)
+    for (;;) {
+        int left = -1;
+        if (deadline != UINT64_MAX) {
+            uint64_t t = now_ns();
+            if (t >= deadline)
+                return 0;
+            left = (deadline - t + 999999) / 1000000;
+        }
+
+        n = cq_sleep(w, wc, max, left);
+        if (n != 0)
+            return n;
+
+        n = ibv_poll_cq(w->cq, max, wc);
+        if (n != 0)
+            return n;
+    }
+}
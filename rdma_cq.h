@@ -0,0 +1,69 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA CQ - Attendre des complétions : spin, sommeil, ou les deux
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * POURQUOI ?
+ * → "while (ibv_poll_cq(...) < 1);" = un cœur à 100 % POUR TOUJOURS,
+ *   même quand personne ne parle au serveur
+ * → Un nœud mémoire partage ses cœurs avec d'autres services
+ *
+ * TROIS MODES :
+ * → CQ_MODE_POLL   : spin pur (latence minimale, un cœur brûlé)
+ * → CQ_MODE_EVENT  : dort tout de suite (completion channel + epoll),
+ *                    ~5-10 μs de réveil par attente
+ * → CQ_MODE_HYBRID : spin pendant spin_us, PUIS dort
+ *   → Sous charge, les complétions arrivent pendant le spin :
+ *     même latence que POLL
+ *   → Au repos, le thread dort : 0 % CPU
+ *
+ * COMMENT ON DORT (sans rater de complétion) :
+ * 1. ibv_req_notify_cq : "préviens-moi à la PROCHAINE complétion"
+ * 2. ibv_poll_cq ENCORE : une complétion a pu arriver entre le
+ *    dernier poll et l'armement → elle ne déclencherait rien
+ * 3. epoll_wait sur le fd du completion channel
+ * 4. ibv_get_cq_event, puis retour en 1 (ack par paquets de 64)
+ */
+
+#ifndef RDMA_CQ_H
+#define RDMA_CQ_H
+
+#include <stdint.h>
+#include <infiniband/verbs.h>
+
+#define CQ_SPIN_DEFAULT_US  50      // Budget de spin du mode hybride
+
+enum cq_mode {
+    CQ_MODE_POLL,
+    CQ_MODE_EVENT,
+    CQ_MODE_HYBRID,
+};
+
+struct cq_waiter {
+    struct ibv_cq *cq;
+    struct ibv_comp_channel *channel;   // NULL en CQ_MODE_POLL
+    int epfd;                           // -1 en CQ_MODE_POLL
+    enum cq_mode mode;
+    uint64_t spin_ns;                   // Budget de spin (hybride)
+    unsigned int unacked;               // Événements pas encore ack
+    uint64_t sleeps;                    // Fois où on s'est endormi
+};
+
+// "poll" / "event" / "hybrid" → mode. Retourne 0 si reconnu.
+int cq_mode_parse(const char *str, enum cq_mode *mode);
+const char *cq_mode_name(enum cq_mode mode);
+
+// Crée la CQ (et son completion channel hors CQ_MODE_POLL).
+// Retourne 0 si succès.
+int cq_waiter_init(struct cq_waiter *w, struct ibv_context *verbs,
+                   int cqe, enum cq_mode mode, int spin_us);
+
+// Ack les événements en attente, détruit CQ + channel + epoll
+void cq_waiter_destroy(struct cq_waiter *w);
+
+// Récolte jusqu'à max complétions, en attendant selon le mode.
+// timeout_ms < 0 : attend indéfiniment.
+// Retourne le nombre de complétions, 0 si timeout, < 0 si erreur.
+int cq_wait(struct cq_waiter *w, struct ibv_wc *wc, int max, int timeout_ms);
+
+#endif /* RDMA_CQ_H */
@@ -0,0 +1,63 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA HIST - Histogramme de latences (style HDR)
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * Voir rdma_hist.h
+ */
+
+#include <string.h>
+
+#include "rdma_hist.h"
+
+void hist_init(struct hist *h) {
+    memset(h, 0, sizeof(*h));
+    h->min = UINT64_MAX;
+}
+
+uint64_t hist_bucket_high(int idx) {
+    if (idx < HIST_SUB)
+        return (uint64_t)idx;
+
+    int shift = (idx - HIST_SUB) / HIST_SUB;
+    uint64_t sub = (idx - HIST_SUB) % HIST_SUB + HIST_SUB;
+
+    // Dernier bucket possible : (128 << 57) déborderait
+    if (sub + 1 == 2 * HIST_SUB && shift + HIST_SUB_BITS + 1 >= 64)
+        return UINT64_MAX;
+    return ((sub + 1) << shift) - 1;
+}
+
+// ═══════════════════════════════════════════════════════
+// PERCENTILE
+// ═══════════════════════════════════════════════════════
+// On parcourt les buckets en cumulant jusqu'au rang voulu.
+// → Le résultat est la borne HAUTE du bucket (jamais optimiste)
+// → Plafonné par le max exact
+
+uint64_t hist_percentile(const struct hist *h, double p) {
+    if (h->total == 0)
+        return 0;
+    if (p <= 0.0)
+        return h->min;
+
+    uint64_t rank = (uint64_t)(p / 100.0 * h->total + 0.5);
+    if (rank < 1)
+        rank = 1;
+    if (rank > h->total)
+        rank = h->total;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        seen += h->counts[i];
+        if (seen >= rank) {
+            uint64_t v = hist_bucket_high(i);
+            return v < h->max ? v : h->max;
+        }
+    }
+    return h->max;
+}
+
+double hist_mean(const struct hist *h) {
+    return h->total ? h->sum / h->total : 0.0;
+}
@@ -0,0 +1,64 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA HIST - Histogramme de latences (style HDR)
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * POURQUOI ?
+ * → Une seule mesure ne dit rien de la latence de queue (p99, p99.9)
+ * → Stocker des millions d'échantillons puis trier : trop lent,
+ *   trop de mémoire
+ *
+ * COMMENT ?
+ * → Buckets "log-linéaires" : chaque puissance de 2 est découpée
+ *   en HIST_SUB sous-buckets de même largeur
+ * → Précision relative constante : 1/64 ≈ 1.6 %
+ * → Résolution de 1 ns jusqu'à 128 ns, puis 2 ns, 4 ns, ...
+ * → Enregistrer = un clz + un incrément (pas de division, pas de malloc)
+ * → Taille fixe (~30 KB) quelle que soit le nombre d'échantillons
+ */
+
+#ifndef RDMA_HIST_H
+#define RDMA_HIST_H
+
+#include <stdint.h>
+
+#define HIST_SUB_BITS 6
+#define HIST_SUB      (1 << HIST_SUB_BITS)
+#define HIST_BUCKETS  (HIST_SUB + (64 - HIST_SUB_BITS) * HIST_SUB)
+
+struct hist {
+    uint64_t counts[HIST_BUCKETS];
+    uint64_t total;         // Nombre d'échantillons
+    uint64_t min, max;      // Valeurs exactes (ns)
+    double sum;             // Pour la moyenne
+};
+
+void hist_init(struct hist *h);
+
+// Index du bucket d'une valeur
+static inline int hist_index(uint64_t v) {
+    if (v < HIST_SUB)
+        return (int)v;                          // Zone linéaire
+
+    int msb = 63 - __builtin_clzll(v);          // Puissance de 2
+    int shift = msb - HIST_SUB_BITS;            // Largeur = 2^shift
+    return HIST_SUB + shift * HIST_SUB + (int)(v >> shift) - HIST_SUB;
+}
+
+static inline void hist_record(struct hist *h, uint64_t v) {
+    h->counts[hist_index(v)]++;
+    h->total++;
+    h->sum += v;
+    if (v < h->min) h->min = v;
+    if (v > h->max) h->max = v;
+}
+
+// Plus grande valeur du bucket idx (arrondi "pessimiste")
+uint64_t hist_bucket_high(int idx);
+
+// Valeur au percentile p (0..100), en ns
+uint64_t hist_percentile(const struct hist *h, double p);
+
+double hist_mean(const struct hist *h);
+
+#endif /* RDMA_HIST_H */
@@ -0,0 +1,432 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA KV - Table clé-valeur dans la RAM exposée du serveur
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * Voir rdma_kv.h
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <arpa/inet.h>
+
+#include "rdma_common.h"
+#include "rdma_kv.h"
+
+#define KV_BUCKET_BYTES  (KV_BUCKET_SLOTS * KV_SLOT_SIZE)
+
+_Static_assert(sizeof(struct kv_slot) == KV_SLOT_SIZE, "un slot = une ligne de cache");
+_Static_assert(sizeof(struct kv_header) == KV_SLOT_SIZE, "en-tête de 64 octets");
+
+// FNV-1a 32 bits : quelques ns pour un slot, et un READ déchiré
+// (moitié ancienne, moitié nouvelle) ne retombe pas sur le même
+uint32_t kv_crc(uint64_t key, uint64_t value_off, uint32_t len,
+                const void *value) {
+    uint32_t h = 2166136261u;
+    const uint8_t *p;
+
+    p = (const uint8_t *)&key;
+    for (size_t i = 0; i < sizeof(key); i++)
+        h = (h ^ p[i]) * 16777619u;
+    p = (const uint8_t *)&value_off;
+    for (size_t i = 0; i < sizeof(value_off); i++)
+        h = (h ^ p[i]) * 16777619u;
+    p = (const uint8_t *)&len;
+    for (size_t i = 0; i < sizeof(len); i++)
+        h = (h ^ p[i]) * 16777619u;
+    p = value;
+    for (uint32_t i = 0; i < len; i++)
+        h = (h ^ p[i]) * 16777619u;
+    return h;
+}
+
+const char *kv_status_name(int status) {
+    switch (status) {
+    case KV_OK:          return "ok";
+    case KV_FULL:        return "table pleine";
+    case KV_NO_SPACE:    return "tas plein";
+    case KV_BAD_REQUEST: return "requête invalide";
+    }
+    return "?";
+}
+
+// ═══════════════════════════════════════════════════════
+// SERVEUR : FORMATER LA RÉGION
+// ═══════════════════════════════════════════════════════
+
+int kv_format(struct kv_store *kv, void *base, size_t size,
+              uint64_t num_buckets) {
+    uint64_t mbox_off = sizeof(struct kv_header);
+    uint64_t buckets_off = mbox_off + KV_MBOXES * KV_MBOX_SIZE;
+    uint64_t heap_off = buckets_off + num_buckets * KV_BUCKET_BYTES;
+
+    heap_off = (heap_off + 4095) & ~4095ULL;
+    if (num_buckets == 0 || heap_off + KV_VALUE_MAX > size)
+        return -1;
+
+    memset(kv, 0, sizeof(*kv));
+    kv->base = base;
+    kv->size = size;
+    kv->hdr = base;
+    pthread_mutex_init(&kv->lock, NULL);
+
+    // Buckets vides (clé 0, version 0) ; le tas n'a pas besoin
+    // d'être à zéro (toujours écrit avant d'être désigné)
+    memset(base, 0, heap_off);
+    kv->hdr->num_buckets = num_buckets;
+    kv->hdr->buckets_off = buckets_off;
+    kv->hdr->mbox_off = mbox_off;
+    kv->hdr->heap_off = heap_off;
+    kv->hdr->heap_size = size - heap_off;
+    kv->hdr->magic = KV_MAGIC;
+    return 0;
+}
+
+// ═══════════════════════════════════════════════════════
+// SERVEUR : LE TAS DES VALEURS
+// ═══════════════════════════════════════════════════════
+// Tranches de 64 << classe octets, prises en bout de tas ou dans la
+// liste de la classe (chaînée DANS les tranches libres : le 1er mot
+// est l'offset de la suivante). Rien n'est jamais rendu au tas.
+
+static int kv_class(uint32_t len) {
+    int cls = 0;
+    while ((64u << cls) < len)
+        cls++;
+    return cls;
+}
+
+static uint64_t kv_alloc(struct kv_store *kv, int cls) {
+    uint64_t off = kv->free_list[cls];
+    if (off) {
+        kv->free_list[cls] = *(uint64_t *)(kv->base + off);
+        return off;
+    }
+    if (kv->heap_used + (64u << cls) > kv->hdr->heap_size)
+        return 0;
+    off = kv->hdr->heap_off + kv->heap_used;
+    kv->heap_used += 64u << cls;
+    return off;
+}
+
+static void kv_free(struct kv_store *kv, uint64_t off, int cls) {
+    *(uint64_t *)(kv->base + off) = kv->free_list[cls];
+    kv->free_list[cls] = off;
+}
+
+static struct kv_slot *kv_bucket(struct kv_store *kv, uint64_t b) {
+    return (struct kv_slot *)(kv->base + kv->hdr->buckets_off +
+                              (b % kv->hdr->num_buckets) * KV_BUCKET_BYTES);
+}
+
+// ═══════════════════════════════════════════════════════
+// SERVEUR : APPLIQUER UN PUT
+// ═══════════════════════════════════════════════════════
+// Même protocole que le lecteur, à l'envers : version impaire, PUIS
+// les données, PUIS version paire (barrières entre les trois). Pas
+// de suppression : une clé absente s'arrête au 1er slot libre, le
+// lecteur fait pareil.
+
+int kv_apply_put(struct kv_store *kv, uint32_t mbox, uint32_t len) {
+    if (mbox >= KV_MBOXES)
+        return KV_BAD_REQUEST;
+
+    const struct kv_put_req *req = kv_mbox(kv, mbox);
+    uint64_t key = req->key;
+    uint32_t vlen = req->len;
+    if (key == 0 || vlen > KV_VALUE_MAX ||
+        len != offsetof(struct kv_put_req, value) + vlen)
+        return KV_BAD_REQUEST;
+
+    pthread_mutex_lock(&kv->lock);
+
+    struct kv_slot *slot = NULL, *free_slot = NULL;
+    uint64_t b = kv_hash(key);
+    for (int p = 0; p < KV_MAX_PROBE && !slot && !free_slot; p++) {
+        struct kv_slot *s = kv_bucket(kv, b + p);
+        for (int i = 0; i < KV_BUCKET_SLOTS && !slot; i++) {
+            if (s[i].key == key)
+                slot = &s[i];
+            else if (s[i].key == 0 && !free_slot)
+                free_slot = &s[i];
+        }
+    }
+    int is_new = slot == NULL;
+    if (is_new)
+        slot = free_slot;
+    if (!slot) {
+        pthread_mutex_unlock(&kv->lock);
+        return KV_FULL;
+    }
+
+    // Même classe de tranche : réécrite sur place ; sinon une autre
+    uint64_t old_off = is_new ? 0 : slot->value_off;
+    uint32_t old_len = is_new ? 0 : slot->value_len;
+    uint64_t off = 0;
+    if (vlen > KV_INLINE) {
+        if (old_off && kv_class(old_len) == kv_class(vlen))
+            off = old_off;
+        else
+            off = kv_alloc(kv, kv_class(vlen));
+        if (!off) {
+            pthread_mutex_unlock(&kv->lock);
+            return KV_NO_SPACE;
+        }
+    }
+
+    uint64_t version = slot->version;
+    __atomic_store_n(&slot->version, version + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    void *dst = off ? (void *)(kv->base + off) : (void *)slot->value;
+    memcpy(dst, req->value, vlen);
+    slot->key = key;
+    slot->value_off = off;
+    slot->value_len = vlen;
+    slot->crc = kv_crc(key, off, vlen, dst);
+
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&slot->version, version + 2, __ATOMIC_RELAXED);
+
+    // Plus aucun slot ne la désigne : recyclable
+    if (old_off && old_off != off)
+        kv_free(kv, old_off, kv_class(old_len));
+    kv->keys += is_new;
+    kv->puts++;
+
+    pthread_mutex_unlock(&kv->lock);
+    return KV_OK;
+}
+
+// ═══════════════════════════════════════════════════════
+// CLIENT : UN RDMA_READ SYNCHRONE
+// ═══════════════════════════════════════════════════════
+
+static int kv_read(struct kv_client *kv, void *local, uint32_t len,
+                   uint64_t remote_off) {
+    struct ibv_sge sge;
+    sge.addr = (uint64_t)local;
+    sge.length = len;
+    sge.lkey = kv->lkey;
+
+    struct ibv_send_wr wr, *bad_wr;
+    memset(&wr, 0, sizeof(wr));
+    wr.wr_id = remote_off;
+    wr.sg_list = &sge;
+    wr.num_sge = 1;
+    wr.opcode = IBV_WR_RDMA_READ;
+    wr.send_flags = IBV_SEND_SIGNALED;
+    wr.wr.rdma.remote_addr = kv->remote_addr + remote_off;
+    wr.wr.rdma.rkey = kv->rkey;
+
+    int ret = ibv_post_send(kv->qp, &wr, &bad_wr);
+    if (ret) {
+        printf("   ❌ ibv_post_send (KV) : %s\n", strerror(ret));
+        return -1;
+    }
+
+    struct ibv_wc wc;
+    if (cq_wait(kv->cqw, &wc, 1, -1) < 0)
+        return -1;
+    if (wc.status != IBV_WC_SUCCESS) {
+        printf("   ❌ RDMA_READ (KV, offset %lu) échoué (status: %s)\n",
+               wc.wr_id, ibv_wc_status_str(wc.status));
+        return -1;
+    }
+    return 0;
+}
+
+int kv_open(struct kv_client *kv, struct ibv_qp *qp, struct cq_waiter *cqw,
+            char *buf, size_t buf_size, uint32_t lkey,
+            uint64_t remote_addr, uint64_t remote_size, uint32_t rkey,
+            uint32_t mbox) {
+    memset(kv, 0, sizeof(*kv));
+    kv->qp = qp;
+    kv->cqw = cqw;
+    kv->buf = buf;
+    kv->lkey = lkey;
+    kv->remote_addr = remote_addr;
+    kv->rkey = rkey;
+    kv->mbox = mbox;
+
+    if (buf_size < KV_CLIENT_BUF) {
+        printf("   ❌ Buffer local trop petit pour la table : %zu octets au moins\n",
+               (size_t)KV_CLIENT_BUF);
+        return -1;
+    }
+    if (kv_read(kv, buf, sizeof(kv->hdr), 0))
+        return -1;
+    memcpy(&kv->hdr, buf, sizeof(kv->hdr));
+
+    if (kv->hdr.magic != KV_MAGIC) {
+        printf("   ❌ Pas de table clé-valeur chez le serveur (lancé sans -K ?)\n");
+        return -1;
+    }
+    if (kv->hdr.heap_off + kv->hdr.heap_size > remote_size ||
+        kv->hdr.num_buckets == 0) {
+        printf("   ❌ En-tête de la table incohérent\n");
+        return -1;
+    }
+    return 0;
+}
+
+// ═══════════════════════════════════════════════════════
+// CLIENT : GET ONE-SIDED
+// ═══════════════════════════════════════════════════════
+// Cherche key dans un bucket déjà lu :
+// → 0 : trouvée (valeur copiée), 1 : absente (slot libre vu),
+//   2 : pas là, bucket plein (voir le suivant), 3 : à relire
+
+static int kv_scan(struct kv_client *kv, const struct kv_slot *bucket,
+                   uint64_t key, void *value, uint32_t *len) {
+    int saw_free = 0;
+
+    for (int i = 0; i < KV_BUCKET_SLOTS; i++) {
+        const struct kv_slot *s = &bucket[i];
+
+        if (s->version & 1)
+            return 3;
+        if (s->key == 0) {
+            saw_free = 1;
+            continue;
+        }
+        if (s->key != key)
+            continue;
+
+        uint32_t vlen = s->value_len;
+        const void *src = s->value;
+        if (vlen > KV_VALUE_MAX || (s->value_off == 0 && vlen > KV_INLINE))
+            return 3;                           // Slot déchiré
+        if (s->value_off) {
+            char *vbuf = kv->buf + KV_BUCKET_BYTES;
+            if (s->value_off + vlen > kv->hdr.heap_off + kv->hdr.heap_size ||
+                s->value_off < kv->hdr.heap_off)
+                return 3;
+            if (kv_read(kv, vbuf, vlen, s->value_off))
+                return -1;
+            kv->reads++;
+            src = vbuf;
+        }
+        if (kv_crc(key, s->value_off, vlen, src) != s->crc)
+            return 3;                           // Croisé une écriture
+        memcpy(value, src, vlen);
+        *len = vlen;
+        return 0;
+    }
+    return saw_free ? 1 : 2;
+}
+
+int kv_get(struct kv_client *kv, uint64_t key, void *value, uint32_t *len) {
+    struct kv_slot *bucket = (struct kv_slot *)kv->buf;
+    uint64_t b = kv_hash(key);
+    int retries = 0;
+
+    kv->gets++;
+    for (int p = 0; p < KV_MAX_PROBE; ) {
+        uint64_t off = kv->hdr.buckets_off +
+                       ((b + p) % kv->hdr.num_buckets) * KV_BUCKET_BYTES;
+        if (kv_read(kv, bucket, KV_BUCKET_BYTES, off))
+            return -1;
+        kv->reads++;
+
+        int ret = kv_scan(kv, bucket, key, value, len);
+        if (ret < 0)
+            return -1;
+        if (ret == 0) {
+            kv->hits++;
+            return 0;
+        }
+        if (ret == 1)
+            return 1;
+        if (ret == 2) {
+            p++;
+            continue;
+        }
+        kv->retries++;
+        if (++retries > KV_MAX_RETRY) {
+            printf("   ❌ GET %lu : %d relectures, la clé change sans arrêt\n",
+                   key, KV_MAX_RETRY);
+            return -1;
+        }
+    }
+    return 1;
+}
+
+// ═══════════════════════════════════════════════════════
+// CLIENT : PUT TWO-SIDED
+// ═══════════════════════════════════════════════════════
+// 1. RECV de la réponse posté AVANT (0 octet : tout est dans
+//    l'immediate data)
+// 2. RDMA_WRITE_WITH_IMM de la requête dans notre boîte
+// 3. Deux complétions : notre WRITE, puis la réponse
+
+int kv_put(struct kv_client *kv, uint64_t key, const void *value,
+           uint32_t len) {
+    if (kv->mbox == KV_NO_MBOX) {
+        printf("   ❌ PUT impossible : pas de boîte aux lettres (plus de %d"
+               " connexions chez le serveur ?)\n", KV_MBOXES);
+        return -1;
+    }
+    if (key == 0 || len > KV_VALUE_MAX) {
+        printf("   ❌ PUT invalide : clé %lu, %u octets\n", key, len);
+        return -1;
+    }
+
+    struct kv_put_req *req = (struct kv_put_req *)(kv->buf + KV_BUCKET_BYTES +
+                                                   KV_VALUE_MAX);
+    req->key = key;
+    req->len = len;
+    memcpy(req->value, value, len);
+    uint32_t bytes = offsetof(struct kv_put_req, value) + len;
+
+    struct ibv_recv_wr rwr, *bad_rwr;
+    memset(&rwr, 0, sizeof(rwr));
+    rwr.wr_id = key;
+    rwr.num_sge = 0;
+    int ret = ibv_post_recv(kv->qp, &rwr, &bad_rwr);
+    if (ret) {
+        printf("   ❌ ibv_post_recv (réponse PUT) : %s\n", strerror(ret));
+        return -1;
+    }
+
+    struct ibv_sge sge;
+    sge.addr = (uint64_t)req;
+    sge.length = bytes;
+    sge.lkey = kv->lkey;
+
+    struct ibv_send_wr wr, *bad_wr;
+    memset(&wr, 0, sizeof(wr));
+    wr.wr_id = key;
+    wr.sg_list = &sge;
+    wr.num_sge = 1;
+    wr.opcode = IBV_WR_RDMA_WRITE_WITH_IMM;
+    wr.send_flags = IBV_SEND_SIGNALED;
+    wr.imm_data = htonl(CMD_IMM(CMD_KV_PUT, bytes));
+    wr.wr.rdma.remote_addr = kv->remote_addr + kv->hdr.mbox_off +
+                             (uint64_t)kv->mbox * KV_MBOX_SIZE;
+    wr.wr.rdma.rkey = kv->rkey;
+    ret = ibv_post_send(kv->qp, &wr, &bad_wr);
+    if (ret) {
+        printf("   ❌ ibv_post_send (PUT) : %s\n", strerror(ret));
+        return -1;
+    }
+
+    int status = -1, sent = 0;
+    while (!sent || status < 0) {
+        struct ibv_wc wc;
+        if (cq_wait(kv->cqw, &wc, 1, -1) < 0)
+            return -1;
+        if (wc.status != IBV_WC_SUCCESS) {
+            printf("   ❌ PUT %lu échoué (status: %s)\n", key,
+                   ibv_wc_status_str(wc.status));
+            return -1;
+        }
+        if (wc.opcode == IBV_WC_RECV)
+            status = CMD_IMM_ARG(ntohl(wc.imm_data));
+        else
+            sent = 1;
+    }
+    kv->puts++;
+    return status;
+}
@@ -0,0 +1,193 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA KV - Table clé-valeur dans la RAM exposée du serveur
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * POURQUOI ?
+ * → Les lectures dominent (95-100 % des requêtes en YCSB B / C) :
+ *   si un GET n'est que des RDMA_READ, le CPU du serveur ne le voit
+ *   jamais passer, et aucun cœur serveur ne plafonne le débit
+ * → Les écritures restent two-sided : UN seul écrivain (le serveur)
+ *   pour la table, pas de verrou distant à prendre
+ *
+ * LA RÉGION (serveur lancé avec -K buckets) :
+ *
+ *   0        ┌──────────────────────┐
+ *            │ kv_header (64 o)     │ formats, offsets (lu une fois)
+ *   mbox_off ├──────────────────────┤
+ *            │ KV_MBOXES boîtes PUT │ une par connexion (info.mbox)
+ *   buckets  ├──────────────────────┤
+ *            │ bucket 0 │ bucket 1 …│ KV_BUCKET_SLOTS slots de 64 o
+ *   heap_off ├──────────────────────┤
+ *            │ valeurs > KV_INLINE  │ tranches de 64, 128, … 4096 o
+ *            └──────────────────────┘
+ *
+ * UN SLOT = UNE LIGNE DE CACHE :
+ *   version │ key │ value_off │ value_len │ crc │ valeur (≤ 32 o)
+ * → version impaire : le serveur est en train d'écrire
+ * → crc : somme de contrôle de la clé, de l'emplacement ET de la
+ *   valeur ; un READ qui croise une écriture (slot ou valeur à
+ *   moitié écrits) ne peut pas passer la vérification
+ *
+ * GET (client, one-sided) :
+ * 1. RDMA_READ du bucket (KV_BUCKET_SLOTS slots = 256 o, UN READ)
+ * 2. Valeur ≤ KV_INLINE : déjà là → 1 aller-retour
+ *    Sinon RDMA_READ de la valeur → 2 allers-retours
+ * 3. crc faux ou version impaire : on relit (compté dans retries)
+ * → Bucket plein sans la clé : le suivant (sondage linéaire, au
+ *   plus KV_MAX_PROBE buckets)
+ *
+ * PUT (two-sided) :
+ * → RDMA_WRITE_WITH_IMM de la requête dans SA boîte aux lettres
+ *   (imm = CMD_KV_PUT, longueur) : un RECV du SRQ est consommé, le
+ *   thread serveur de la connexion l'applique et répond par un SEND
+ *   de 0 octet (imm = CMD_KV_PUT, statut)
+ * → Côté serveur : version impaire, valeur, champs, crc, version
+ *   paire ; une valeur qui change de taille part dans une autre
+ *   tranche (l'ancienne est recyclée : un lecteur en retard le voit
+ *   au crc et relit)
+ *
+ * Clé : 64 bits, jamais 0 (0 = slot libre).
+ */
+
+#ifndef RDMA_KV_H
+#define RDMA_KV_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <infiniband/verbs.h>
+
+#include "rdma_cq.h"
+
+#define KV_MAGIC         0x3130305453564b52ULL  // "RKVST001"
+#define KV_SLOT_SIZE     64
+#define KV_BUCKET_SLOTS  4          // Un bucket = 256 octets = UN READ
+#define KV_INLINE        32         // Valeurs jusque-là : dans le slot
+#define KV_VALUE_MAX     4096
+#define KV_MAX_PROBE     4          // Buckets visités au plus
+#define KV_MAX_RETRY     100        // Relectures avant d'abandonner un GET
+#define KV_MBOXES        64         // Connexions qui peuvent faire des PUT
+#define KV_NO_MBOX       0xFFFFFFFFu
+
+// Statuts d'un PUT (argument de la réponse)
+enum kv_status {
+    KV_OK = 0,
+    KV_FULL = 1,                    // Pas de slot libre (KV_MAX_PROBE buckets)
+    KV_NO_SPACE = 2,                // Tas des valeurs plein
+    KV_BAD_REQUEST = 3,             // Clé 0, taille invalide, pas de boîte
+};
+
+struct kv_header {
+    uint64_t magic;
+    uint64_t num_buckets;
+    uint64_t buckets_off;
+    uint64_t mbox_off;
+    uint64_t heap_off;
+    uint64_t heap_size;
+    uint64_t reserved[2];
+};
+
+struct kv_slot {
+    uint64_t version;               // Impaire : écriture en cours
+    uint64_t key;                   // 0 = libre
+    uint64_t value_off;             // Valeur hors slot (0 = dans le slot)
+    uint32_t value_len;
+    uint32_t crc;
+    uint8_t value[KV_INLINE];
+};
+
+// Une requête PUT, telle qu'écrite dans la boîte aux lettres
+struct kv_put_req {
+    uint64_t key;
+    uint32_t len;
+    uint32_t reserved;
+    uint8_t value[KV_VALUE_MAX];
+};
+
+#define KV_MBOX_SIZE     ((sizeof(struct kv_put_req) + 63) & ~(size_t)63)
+
+// Somme de contrôle d'un slot : clé, emplacement, longueur, valeur
+uint32_t kv_crc(uint64_t key, uint64_t value_off, uint32_t len,
+                const void *value);
+
+static inline uint64_t kv_hash(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+}
+
+// ─── Côté serveur : la table elle-même ───────────────────
+
+#define KV_CLASSES       7          // Tranches de 64, 128, ... 4096 octets
+
+struct kv_store {
+    char *base;                     // Début de la RAM exposée
+    size_t size;
+    struct kv_header *hdr;
+    pthread_mutex_t lock;           // Un PUT à la fois (threads clients)
+    uint64_t heap_used;             // Tas consommé (jamais rendu)
+    uint64_t free_list[KV_CLASSES]; // Tranches recyclées (offset, 0 = vide)
+    uint64_t keys;                  // Statistiques
+    uint64_t puts;
+};
+
+// Prépare la région : en-tête, boîtes, buckets vides, tas.
+// Retourne 0 si succès, -1 si la région est trop petite.
+int kv_format(struct kv_store *kv, void *base, size_t size,
+              uint64_t num_buckets);
+
+// Adresse de la boîte aux lettres mbox (requête déposée par le client)
+static inline struct kv_put_req *kv_mbox(struct kv_store *kv, uint32_t mbox) {
+    return (struct kv_put_req *)(kv->base + kv->hdr->mbox_off +
+                                 (uint64_t)mbox * KV_MBOX_SIZE);
+}
+
+// Applique le PUT déposé dans la boîte mbox (len = imm). Retourne
+// un enum kv_status.
+int kv_apply_put(struct kv_store *kv, uint32_t mbox, uint32_t len);
+
+// ─── Côté client ─────────────────────────────────────────
+
+// Le buffer local (MR) doit contenir un bucket, une valeur et une
+// requête PUT
+#define KV_CLIENT_BUF    (KV_BUCKET_SLOTS * KV_SLOT_SIZE + KV_VALUE_MAX + \
+                          KV_MBOX_SIZE)
+
+struct kv_client {
+    struct ibv_qp *qp;
+    struct cq_waiter *cqw;
+    char *buf;                      // Bucket, valeur, requête PUT
+    uint32_t lkey;
+    uint64_t remote_addr;           // RAM serveur (= kv_header)
+    uint32_t rkey;
+    uint32_t mbox;                  // Notre boîte (info.mbox)
+    struct kv_header hdr;           // Copie, lue par kv_open
+
+    uint64_t gets, hits;            // Statistiques
+    uint64_t reads;                 // RDMA_READ des GET (allers-retours)
+    uint64_t retries;               // Relectures (version / crc)
+    uint64_t puts;
+};
+
+// Lit l'en-tête (un RDMA_READ). Retourne 0 si la RAM serveur est
+// bien une table (serveur lancé avec -K).
+int kv_open(struct kv_client *kv, struct ibv_qp *qp, struct cq_waiter *cqw,
+            char *buf, size_t buf_size, uint32_t lkey,
+            uint64_t remote_addr, uint64_t remote_size, uint32_t rkey,
+            uint32_t mbox);
+
+// GET one-sided. value : au moins KV_VALUE_MAX octets.
+// Retourne 0 si trouvée (*len = sa taille), 1 si absente, -1 si erreur.
+int kv_get(struct kv_client *kv, uint64_t key, void *value, uint32_t *len);
+
+// PUT two-sided, synchrone. Retourne un enum kv_status, -1 si erreur.
+int kv_put(struct kv_client *kv, uint64_t key, const void *value,
+           uint32_t len);
+
+const char *kv_status_name(int status);
+
+#endif /* RDMA_KV_H */
@@ -0,0 +1,117 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA MEM - Régions de RAM à enregistrer : mmap, pages de 4K/2M/1G
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * Voir rdma_mem.h
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <sys/mman.h>
+
+#include "rdma_mem.h"
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#ifndef MAP_HUGE_1GB
+#define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif
+
+int mem_pages_parse(const char *str, enum mem_pages *pages) {
+    if (!strcasecmp(str, "4k"))      *pages = MEM_PAGES_4K;
+    else if (!strcasecmp(str, "2m")) *pages = MEM_PAGES_2M;
+    else if (!strcasecmp(str, "1g")) *pages = MEM_PAGES_1G;
+    else return -1;
+    return 0;
+}
+
+const char *mem_pages_name(enum mem_pages pages) {
+    switch (pages) {
+    case MEM_PAGES_4K: return "4K";
+    case MEM_PAGES_2M: return "2M";
+    case MEM_PAGES_1G: return "1G";
+    }
+    return "?";
+}
+
+// ═══════════════════════════════════════════════════════
+// ALLOCATION
+// ═══════════════════════════════════════════════════════
+// → MAP_POPULATE : toutes les pages sont fautées ICI, pas au
+//   premier accès ni pendant ibv_reg_mr (temps mesuré honnête)
+// → MAP_HUGETLB + MAP_HUGE_xx : pris dans le pool hugetlbfs
+// → mem_region_reserve : MAP_NORESERVE, rien n'est fauté (ODP)
+
+static int region_map(struct mem_region *r, size_t size, enum mem_pages pages,
+                      int extra) {
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | extra;
+
+    memset(r, 0, sizeof(*r));
+    r->pages = pages;
+    switch (pages) {
+    case MEM_PAGES_4K:
+        r->page_size = 4096;
+        break;
+    case MEM_PAGES_2M:
+        r->page_size = 2UL << 20;
+        flags |= MAP_HUGETLB | MAP_HUGE_2MB;
+        break;
+    case MEM_PAGES_1G:
+        r->page_size = 1UL << 30;
+        flags |= MAP_HUGETLB | MAP_HUGE_1GB;
+        break;
+    }
+    r->size = (size + r->page_size - 1) & ~(r->page_size - 1);
+
+    void *addr = mmap(NULL, r->size, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (addr == MAP_FAILED) {
+        printf("   ❌ mmap de %zu octets en pages de %s : %s\n",
+               r->size, mem_pages_name(pages), strerror(errno));
+        if (pages != MEM_PAGES_4K)
+            printf("      (huge pages réservées ? voir /proc/meminfo)\n");
+        r->size = 0;
+        return -1;
+    }
+    r->addr = addr;
+    return 0;
+}
+
+int mem_region_alloc(struct mem_region *r, size_t size, enum mem_pages pages) {
+    return region_map(r, size, pages, MAP_POPULATE);
+}
+
+int mem_region_reserve(struct mem_region *r, size_t size, enum mem_pages pages) {
+    return region_map(r, size, pages, MAP_NORESERVE);
+}
+
+// mincore : un octet par page de 4 KB, bit 0 = résidente
+long mem_region_resident(const struct mem_region *r) {
+    size_t n = r->size / 4096;
+    unsigned char *vec = malloc(n);
+    if (!vec)
+        return -1;
+
+    long resident = -1;
+    if (mincore(r->addr, r->size, vec) == 0) {
+        resident = 0;
+        for (size_t i = 0; i < n; i++)
+            resident += vec[i] & 1;
+    }
+    free(vec);
+    return resident;
+}
+
+void mem_region_free(struct mem_region *r) {
+    if (r->addr)
+        munmap(r->addr, r->size);
+    r->addr = NULL;
+    r->size = 0;
+}
@@ -0,0 +1,56 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA MEM - Régions de RAM à enregistrer : mmap, pages de 4K/2M/1G
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * POURQUOI DES HUGE PAGES ?
+ * → ibv_reg_mr épingle la région PAGE PAR PAGE et la carte garde
+ *   une traduction (MTT) par page :
+ *     64 GB en pages de 4 KB = 16 millions d'entrées
+ *     64 GB en pages de 2 MB = 32 768 entrées
+ *     64 GB en pages de 1 GB = 64 entrées
+ * → Enregistrement beaucoup plus rapide
+ * → Accès aléatoires : la carte rate beaucoup moins son cache de
+ *   traductions (un raté = un aller-retour PCIe vers la RAM hôte)
+ *
+ * PRÉREQUIS (sinon mem_region_alloc échoue, pas de repli discret) :
+ *   2 MB : echo 1024 > /proc/sys/vm/nr_hugepages
+ *   1 GB : hugepagesz=1G hugepages=N sur la ligne de commande du noyau
+ */
+
+#ifndef RDMA_MEM_H
+#define RDMA_MEM_H
+
+#include <stddef.h>
+
+enum mem_pages {
+    MEM_PAGES_4K,
+    MEM_PAGES_2M,
+    MEM_PAGES_1G,
+};
+
+struct mem_region {
+    void *addr;
+    size_t size;            // Arrondie à un multiple de page_size
+    size_t page_size;
+    enum mem_pages pages;
+};
+
+// "4k" / "2m" / "1g" → type de pages. Retourne 0 si reconnu.
+int mem_pages_parse(const char *str, enum mem_pages *pages);
+const char *mem_pages_name(enum mem_pages pages);
+
+// mmap anonyme de size octets (arrondis), pré-fautés (MAP_POPULATE).
+// Retourne 0 si succès.
+int mem_region_alloc(struct mem_region *r, size_t size, enum mem_pages pages);
+
+// Même chose SANS rien fauter (MAP_NORESERVE) : les pages arrivent
+// au premier accès, CPU ou carte (ODP). Retourne 0 si succès.
+int mem_region_reserve(struct mem_region *r, size_t size, enum mem_pages pages);
+
+// Pages de 4 KB de la région présentes en RAM (-1 si erreur)
+long mem_region_resident(const struct mem_region *r);
+
+void mem_region_free(struct mem_region *r);
+
+#endif /* RDMA_MEM_H */
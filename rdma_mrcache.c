@@ -0,0 +1,303 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA MRCACHE - Cache d'enregistrements (MR) pour buffers quelconques
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * Voir rdma_mrcache.h
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "rdma_mrcache.h"
+
+int mrc_init(struct mr_cache *c, struct ibv_pd *pd, int access,
+             size_t max_pinned) {
+    memset(c, 0, sizeof(*c));
+    c->pd = pd;
+    c->access = access;
+    c->max_pinned = max_pinned;
+    c->seed = 0x2545F491;
+    return pthread_mutex_init(&c->lock, NULL);
+}
+
+// ═══════════════════════════════════════════════════════
+// ARBRE D'INTERVALLES (TREAP)
+// ═══════════════════════════════════════════════════════
+// → Trié par début (puis par adresse de l'entrée : ordre total,
+//   deux MR peuvent commencer au même endroit)
+// → Tas sur prio (aléatoire) : profondeur O(log n) en moyenne
+// → max_end : plus grande fin du sous-arbre, pour élaguer
+
+static uint32_t mrc_rand(struct mr_cache *c) {
+    c->seed ^= c->seed << 13;
+    c->seed ^= c->seed >> 17;
+    c->seed ^= c->seed << 5;
+    return c->seed;
+}
+
+static uintptr_t sub_max(const struct mrc_entry *n) {
+    return n ? n->max_end : 0;
+}
+
+static void fix(struct mrc_entry *n) {
+    uintptr_t m = n->end;
+    if (sub_max(n->left) > m)  m = sub_max(n->left);
+    if (sub_max(n->right) > m) m = sub_max(n->right);
+    n->max_end = m;
+}
+
+static int before(const struct mrc_entry *a, const struct mrc_entry *b) {
+    return a->start < b->start || (a->start == b->start && a < b);
+}
+
+static struct mrc_entry *rot_right(struct mrc_entry *n) {
+    struct mrc_entry *l = n->left;
+    n->left = l->right;
+    l->right = n;
+    fix(n);
+    fix(l);
+    return l;
+}
+
+static struct mrc_entry *rot_left(struct mrc_entry *n) {
+    struct mrc_entry *r = n->right;
+    n->right = r->left;
+    r->left = n;
+    fix(n);
+    fix(r);
+    return r;
+}
+
+static struct mrc_entry *tree_insert(struct mrc_entry *n, struct mrc_entry *e) {
+    if (!n) {
+        e->left = e->right = NULL;
+        e->max_end = e->end;
+        return e;
+    }
+    if (before(e, n)) {
+        n->left = tree_insert(n->left, e);
+        if (n->left->prio > n->prio)
+            return rot_right(n);
+    } else {
+        n->right = tree_insert(n->right, e);
+        if (n->right->prio > n->prio)
+            return rot_left(n);
+    }
+    fix(n);
+    return n;
+}
+
+static struct mrc_entry *tree_remove(struct mrc_entry *n, struct mrc_entry *e) {
+    if (!n)
+        return NULL;
+    if (n == e) {
+        if (!n->left)
+            return n->right;
+        if (!n->right)
+            return n->left;
+        // Descendre e sous l'enfant le plus prioritaire, recommencer
+        if (n->left->prio > n->right->prio) {
+            n = rot_right(n);
+            n->right = tree_remove(n->right, e);
+        } else {
+            n = rot_left(n);
+            n->left = tree_remove(n->left, e);
+        }
+    } else if (before(e, n)) {
+        n->left = tree_remove(n->left, e);
+    } else {
+        n->right = tree_remove(n->right, e);
+    }
+    fix(n);
+    return n;
+}
+
+// Une entrée qui CONTIENT [start, end)
+// → Sous-arbre dont max_end < end : personne ne va assez loin
+// → À droite d'une entrée qui commence après start : pareil
+static struct mrc_entry *tree_find(struct mrc_entry *n, uintptr_t start,
+                                   uintptr_t end) {
+    while (n && n->max_end >= end) {
+        struct mrc_entry *l = tree_find(n->left, start, end);
+        if (l)
+            return l;
+        if (n->start > start)
+            return NULL;
+        if (n->end >= end)
+            return n;
+        n = n->right;
+    }
+    return NULL;
+}
+
+// Toutes les entrées qui CHEVAUCHENT [start, end), chaînées par
+// inval_next en tête de *list
+static void tree_overlaps(struct mrc_entry *n, uintptr_t start, uintptr_t end,
+                          struct mrc_entry **list) {
+    if (!n || n->max_end <= start)
+        return;
+    tree_overlaps(n->left, start, end, list);
+    if (n->start < end) {
+        if (n->end > start) {
+            n->inval_next = *list;
+            *list = n;
+        }
+        tree_overlaps(n->right, start, end, list);
+    }
+}
+
+// ═══════════════════════════════════════════════════════
+// LRU
+// ═══════════════════════════════════════════════════════
+
+static void lru_unlink(struct mr_cache *c, struct mrc_entry *e) {
+    if (e->lru_prev) e->lru_prev->lru_next = e->lru_next;
+    else             c->lru_head = e->lru_next;
+    if (e->lru_next) e->lru_next->lru_prev = e->lru_prev;
+    else             c->lru_tail = e->lru_prev;
+    e->lru_prev = e->lru_next = NULL;
+}
+
+static void lru_push(struct mr_cache *c, struct mrc_entry *e) {
+    e->lru_prev = NULL;
+    e->lru_next = c->lru_head;
+    if (c->lru_head)
+        c->lru_head->lru_prev = e;
+    else
+        c->lru_tail = e;
+    c->lru_head = e;
+}
+
+static void entry_free(struct mr_cache *c, struct mrc_entry *e) {
+    ibv_dereg_mr(e->mr);
+    c->pinned -= e->end - e->start;
+    c->entries--;
+    free(e);
+}
+
+// Retire e de l'arbre et de la LRU ; la libère si personne ne
+// s'en sert, sinon le dernier mrc_put s'en chargera
+static void entry_drop(struct mr_cache *c, struct mrc_entry *e) {
+    c->root = tree_remove(c->root, e);
+    lru_unlink(c, e);
+    if (e->refs == 0)
+        entry_free(c, e);
+    else
+        e->stale = 1;
+}
+
+// Évince les entrées libres les plus anciennes jusqu'à ce que
+// need octets de plus tiennent sous le plafond
+static void evict(struct mr_cache *c, size_t need) {
+    struct mrc_entry *e = c->lru_tail;
+    while (e && c->pinned + need > c->max_pinned) {
+        struct mrc_entry *prev = e->lru_prev;
+        if (e->refs == 0) {
+            entry_drop(c, e);
+            c->evictions++;
+        }
+        e = prev;
+    }
+}
+
+// ═══════════════════════════════════════════════════════
+// GET / PUT
+// ═══════════════════════════════════════════════════════
+
+struct mrc_entry *mrc_get(struct mr_cache *c, void *addr, size_t len) {
+    uintptr_t start = (uintptr_t)addr & ~(uintptr_t)(MRC_ALIGN - 1);
+    uintptr_t end = ((uintptr_t)addr + len + MRC_ALIGN - 1) &
+                    ~(uintptr_t)(MRC_ALIGN - 1);
+
+    pthread_mutex_lock(&c->lock);
+
+    struct mrc_entry *e = tree_find(c->root, start, end);
+    if (e) {
+        c->hits++;
+        e->refs++;
+        lru_unlink(c, e);
+        lru_push(c, e);
+        pthread_mutex_unlock(&c->lock);
+        return e;
+    }
+
+    c->misses++;
+    evict(c, end - start);
+
+    e = calloc(1, sizeof(*e));
+    if (!e) {
+        pthread_mutex_unlock(&c->lock);
+        return NULL;
+    }
+    e->mr = ibv_reg_mr(c->pd, (void *)start, end - start, c->access);
+    if (!e->mr) {
+        perror("   ❌ ibv_reg_mr (cache)");
+        free(e);
+        pthread_mutex_unlock(&c->lock);
+        return NULL;
+    }
+    e->start = start;
+    e->end = end;
+    e->refs = 1;
+    e->prio = mrc_rand(c);
+    c->root = tree_insert(c->root, e);
+    lru_push(c, e);
+    c->pinned += end - start;
+    c->entries++;
+
+    pthread_mutex_unlock(&c->lock);
+    return e;
+}
+
+void mrc_put(struct mr_cache *c, struct mrc_entry *e) {
+    if (!e)
+        return;
+
+    pthread_mutex_lock(&c->lock);
+    if (--e->refs == 0) {
+        if (e->stale)
+            entry_free(c, e);
+        else
+            evict(c, 0);        // Plafond dépassé pendant l'utilisation
+    }
+    pthread_mutex_unlock(&c->lock);
+}
+
+// ═══════════════════════════════════════════════════════
+// INVALIDATION
+// ═══════════════════════════════════════════════════════
+
+void mrc_invalidate(struct mr_cache *c, void *addr, size_t len) {
+    struct mrc_entry *list = NULL;
+
+    pthread_mutex_lock(&c->lock);
+    tree_overlaps(c->root, (uintptr_t)addr, (uintptr_t)addr + len, &list);
+    while (list) {
+        struct mrc_entry *next = list->inval_next;
+        entry_drop(c, list);
+        c->invalidations++;
+        list = next;
+    }
+    pthread_mutex_unlock(&c->lock);
+}
+
+int mrc_munmap(struct mr_cache *c, void *addr, size_t len) {
+    mrc_invalidate(c, addr, len);
+    return munmap(addr, len);
+}
+
+void mrc_destroy(struct mr_cache *c) {
+    // Toutes les entrées de l'arbre sont dans la LRU ; les entrées
+    // "stale" encore utilisées n'y sont plus, leur mrc_put manquant
+    // est une fuite de l'appelant
+    while (c->lru_head) {
+        struct mrc_entry *e = c->lru_head;
+        lru_unlink(c, e);
+        entry_free(c, e);
+    }
+    c->root = NULL;
+    pthread_mutex_destroy(&c->lock);
+}
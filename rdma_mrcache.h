@@ -0,0 +1,104 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA MRCACHE - Cache d'enregistrements (MR) pour buffers quelconques
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * LE PROBLÈME :
+ * → Zéro-copie depuis un buffer de l'application = la carte doit
+ *   connaître ce buffer = ibv_reg_mr AVANT le transfert
+ * → ibv_reg_mr + ibv_dereg_mr à chaque transfert : des dizaines de
+ *   μs (appels noyau, épinglage, MTT), bien plus que le transfert
+ *
+ * LA SOLUTION : NE PAS DÉ-ENREGISTRER
+ * → mrc_get(addr, len) : une MR qui COUVRE déjà [addr, addr+len) ?
+ *   → oui (hit)  : réutilisée, aucun appel noyau
+ *   → non (miss) : ibv_reg_mr des pages entières qui la contiennent
+ * → mrc_put : l'entrée reste enregistrée, prête pour la prochaine fois
+ *
+ * STRUCTURES :
+ * → Arbre d'intervalles (treap trié par début, augmenté de la plus
+ *   grande fin du sous-arbre) : "qui contient [a, b) ?" en O(log n)
+ * → Liste LRU : les entrées LIBRES (refs = 0) les plus anciennes
+ *   sont dé-enregistrées quand les octets épinglés dépassent le
+ *   plafond. Une entrée utilisée n'est jamais évincée : le plafond
+ *   peut être dépassé tant qu'elle l'est.
+ *
+ * LE PIÈGE : munmap
+ * → Une MR épingle des pages PHYSIQUES. Après munmap + mmap à la
+ *   même adresse, un hit enverrait les ANCIENNES pages : corruption
+ *   silencieuse.
+ * → rdma-core ne prévient pas l'application : toute libération d'un
+ *   buffer mis en cache DOIT passer par mrc_munmap (ou être précédée
+ *   de mrc_invalidate). Une entrée invalidée encore utilisée est
+ *   retirée de l'arbre et dé-enregistrée à son dernier mrc_put.
+ *   (Sans cette discipline : ODP, voir la carte / le noyau.)
+ *
+ * Thread-safe (un mutex par cache).
+ */
+
+#ifndef RDMA_MRCACHE_H
+#define RDMA_MRCACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <infiniband/verbs.h>
+
+#define MRC_ALIGN       4096                // Enregistrement par pages entières
+#define MRC_DEFAULT_CAP (256UL * 1024 * 1024)  // Octets épinglés max
+
+struct mrc_entry {
+    uintptr_t start, end;           // [start, end), alignés sur MRC_ALIGN
+    struct ibv_mr *mr;
+    int refs;                       // mrc_get sans mrc_put
+    int stale;                      // Invalidée, encore utilisée
+
+    struct mrc_entry *left, *right; // Arbre d'intervalles
+    uintptr_t max_end;              // Plus grande fin du sous-arbre
+    uint32_t prio;                  // Priorité de tas (treap)
+
+    struct mrc_entry *lru_prev, *lru_next;
+    struct mrc_entry *inval_next;   // Liste temporaire (mrc_invalidate)
+};
+
+struct mr_cache {
+    struct ibv_pd *pd;
+    int access;                     // Droits des MR (IBV_ACCESS_*)
+    size_t max_pinned;
+    size_t pinned;                  // Octets enregistrés en ce moment
+    pthread_mutex_t lock;
+
+    struct mrc_entry *root;
+    struct mrc_entry *lru_head;     // Plus récemment utilisée
+    struct mrc_entry *lru_tail;     // Première évincée
+    uint32_t seed;
+
+    long entries;
+    long hits, misses;
+    long evictions, invalidations;
+};
+
+int mrc_init(struct mr_cache *c, struct ibv_pd *pd, int access,
+             size_t max_pinned);
+
+// Une MR couvrant [addr, addr+len) (NULL si ibv_reg_mr échoue).
+// lkey = e->mr->lkey. À rendre par mrc_put.
+struct mrc_entry *mrc_get(struct mr_cache *c, void *addr, size_t len);
+
+void mrc_put(struct mr_cache *c, struct mrc_entry *e);
+
+// Oublie toutes les entrées qui chevauchent [addr, addr+len)
+void mrc_invalidate(struct mr_cache *c, void *addr, size_t len);
+
+// mrc_invalidate + munmap (retourne le résultat de munmap)
+int mrc_munmap(struct mr_cache *c, void *addr, size_t len);
+
+// Dé-enregistre TOUT (utilisé ou non : plus aucun WR en vol)
+void mrc_destroy(struct mr_cache *c);
+
+static inline double mrc_hit_rate(const struct mr_cache *c) {
+    long n = c->hits + c->misses;
+    return n ? 100.0 * c->hits / n : 0.0;
+}
+
+#endif /* RDMA_MRCACHE_H */
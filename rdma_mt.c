@@ -0,0 +1,317 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA MT - Débit multi-threads : une QP et une CQ par thread
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * Voir rdma_mt.h
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+#include <rdma/rdma_cma.h>
+
+#include "rdma_common.h"
+#include "rdma_mt.h"
+#include "rdma_numa.h"
+#include "rdma_cmloop.h"
+
+struct mt_worker {
+    int idx;
+    int cpu;                        // Cœur où épingler le thread
+    const struct mt_opts *o;
+    char *slice;                    // Tranche du buffer local
+    size_t slice_size;
+    struct cm_conn cm;              // Sur le canal commun (rdma_cmloop.h)
+    struct cq_waiter cqw;
+    uint32_t max_inline;
+    struct bench_conn conn;
+
+    pthread_t thread;
+    int *go;                        // 0 = attendre, 1 = partir, -1 = annulé
+    struct bench_opts opts;
+    struct bench_result res;
+    int ret;
+};
+
+static void mt_disconnect(struct mt_worker *w) {
+    struct rdma_cm_id *id = w->cm.id;
+    struct ibv_wc wc;
+
+    if (id && id->qp) {
+        if (w->cm.state == CM_UP &&
+            post_cmd(id->qp, 50, CMD_QUIT, 0) == 0)
+            wait_wc(&w->cqw, &wc, "SEND (quit)");
+        rdma_disconnect(id);
+        rdma_destroy_qp(id);
+    }
+    if (w->cqw.cq) {
+        while (ibv_poll_cq(w->cqw.cq, 1, &wc) > 0);
+        cq_waiter_destroy(&w->cqw);
+    }
+    if (id)
+        rdma_destroy_id(id);
+}
+
+// ═══════════════════════════════════════════════════════
+// UNE CONNEXION PAR THREAD, TOUTES EN MÊME TEMPS
+// ═══════════════════════════════════════════════════════
+// Les étapes 1-11 du client, en silence, sur le PD partagé, pour
+// max_threads connexions lancées d'un coup sur UN canal CM : la
+// boucle fait avancer chacune à son rythme (rdma_cmloop.h).
+// → La route doit passer par la carte du PD (sinon la MR ne vaut rien)
+// → Les infos du serveur arrivent avec l'ESTABLISHED
+
+static int mt_create_qp(struct mt_worker *w) {
+    const struct mt_opts *o = w->o;
+    struct rdma_cm_id *id = w->cm.id;
+
+    if (id->verbs != o->pd->context) {
+        printf("   ❌ [thread %d] Route par une autre carte que le PD\n", w->idx);
+        return -1;
+    }
+
+    int send_depth = o->base.queue_depth + 16;
+    if (cq_waiter_init(&w->cqw, id->verbs, send_depth + 16,
+                       o->cq_mode, o->spin_us))
+        return -1;
+
+    struct ibv_qp_init_attr qp_attr;
+    memset(&qp_attr, 0, sizeof(qp_attr));
+    qp_attr.send_cq = w->cqw.cq;
+    qp_attr.recv_cq = w->cqw.cq;
+    qp_attr.qp_type = IBV_QPT_RC;
+    qp_attr.cap.max_send_wr = send_depth;
+    qp_attr.cap.max_recv_wr = 16;
+    qp_attr.cap.max_send_sge = 1;
+    qp_attr.cap.max_recv_sge = 1;
+    qp_attr.cap.max_inline_data = o->inline_size;
+    if (rdma_create_qp(id, o->pd, &qp_attr)) {
+        qp_attr.cap.max_inline_data = 0;
+        if (rdma_create_qp(id, o->pd, &qp_attr)) {
+            perror("   ❌ rdma_create_qp");
+            return -1;
+        }
+    }
+    w->max_inline = qp_attr.cap.max_inline_data;
+    if (w->max_inline > (uint32_t)o->inline_size)
+        w->max_inline = o->inline_size;
+    return 0;
+}
+
+// Route connue : QP puis connect, sans attendre les autres
+static void mt_on_state(struct cm_conn *c) {
+    struct mt_worker *w = c->ctx;
+
+    if (c->state != CM_ROUTED)
+        return;
+    if (mt_create_qp(w)) {
+        c->state = CM_FAILED;
+        return;
+    }
+
+    struct ibv_device_attr dev_attr;
+    if (ibv_query_device(c->id->verbs, &dev_attr)) {
+        memset(&dev_attr, 0, sizeof(dev_attr));
+        dev_attr.max_qp_init_rd_atom = 1;
+        dev_attr.max_qp_rd_atom = 1;
+    }
+    struct rdma_conn_param conn_param;
+    memset(&conn_param, 0, sizeof(conn_param));
+    conn_param.initiator_depth = dev_attr.max_qp_init_rd_atom;
+    conn_param.responder_resources = dev_attr.max_qp_rd_atom;
+    conn_param.retry_count = 7;
+    conn_param.rnr_retry_count = 7;
+    cm_conn_connect(c, &conn_param);
+}
+
+// Connexion établie : sa part de la RAM serveur
+static int mt_finish(struct mt_worker *w) {
+    const struct mt_opts *o = w->o;
+    const struct rdma_buffer_info *info = &w->cm.info;
+
+    if (w->cm.state != CM_UP) {
+        printf("   ❌ [thread %d] Connexion échouée (%s, état %s)\n", w->idx,
+               rdma_event_str(w->cm.why), cm_state_name(w->cm.state));
+        return -1;
+    }
+
+    // Tranche de la RAM serveur : les threads n'écrivent jamais au
+    // même endroit
+    size_t remote_slice = info->size / o->max_threads;
+    if (remote_slice < o->base.size) {
+        printf("   ❌ RAM serveur trop petite : %d tranches de moins de %zu"
+               " octets\n", o->max_threads, o->base.size);
+        return -1;
+    }
+    w->conn = (struct bench_conn) {
+        .qp = w->cm.id->qp,
+        .cqw = &w->cqw,
+        .buf = w->slice,
+        .buf_size = w->slice_size,
+        .lkey = o->lkey,
+        .remote_addr = info->addr + w->idx * remote_slice,
+        .remote_size = remote_slice,
+        .rkey = info->rkey,
+        .max_send = info->max_send,
+        .max_inline = w->max_inline,
+    };
+    return 0;
+}
+
+static void *mt_run(void *arg) {
+    struct mt_worker *w = arg;
+
+    if (numa_pin_cpu(w->cpu))
+        printf("   ⚠️  [thread %d] Épinglage sur le cœur %d impossible\n",
+               w->idx, w->cpu);
+
+    // Tous les threads partent ensemble (départ donné quand le
+    // dernier est créé)
+    int go;
+    while ((go = __atomic_load_n(w->go, __ATOMIC_ACQUIRE)) == 0);
+    if (go > 0 && w->o->body)
+        w->ret = w->o->body(&w->conn, w->idx, &w->opts, &w->res, w->o->arg);
+    else if (go > 0)
+        w->ret = bench_bw(&w->conn, &w->opts, &w->res);
+    return NULL;
+}
+
+// ═══════════════════════════════════════════════════════
+// MONTÉE EN CHARGE : 1, 2, 4, ... max_threads
+// ═══════════════════════════════════════════════════════
+// Les connexions sont établies UNE fois ; à chaque palier, les k
+// premières servent. Débit total = octets de tous les threads /
+// durée du plus lent.
+
+int bench_threads(const struct mt_opts *o) {
+    static int cpus[NUMA_MAX_CPUS];
+    int num_cpus = numa_cpus_of_node(o->node, cpus, NUMA_MAX_CPUS);
+    int status = -1;
+
+    if (num_cpus == 0) {
+        printf("   ❌ Liste des cœurs illisible (sysfs)\n");
+        return -1;
+    }
+
+    struct mt_opts opts = *o;
+    if (opts.max_threads <= 0)
+        opts.max_threads = num_cpus;
+
+    // Tranches alignées sur une ligne de cache
+    size_t slice = (o->buf_size / opts.max_threads) & ~(size_t)63;
+    if (slice < o->base.size) {
+        printf("   ❌ -b trop petit : %d tranches de moins de %zu octets\n",
+               opts.max_threads, o->base.size);
+        return -1;
+    }
+
+    printf("   🧭 Threads sur le nœud NUMA %d : %d cœur(s), %d thread(s) max\n",
+           o->node, num_cpus, opts.max_threads);
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(RDMA_PORT);
+    if (inet_pton(AF_INET, o->server_ip, &addr.sin_addr) != 1)
+        return -1;
+
+    struct rdma_event_channel *ch = rdma_create_event_channel();
+    struct cm_loop loop;
+    if (!ch || cm_loop_init(&loop, ch)) {
+        perror("   ❌ rdma_create_event_channel");
+        if (ch)
+            rdma_destroy_event_channel(ch);
+        return -1;
+    }
+
+    struct mt_worker *workers = calloc(opts.max_threads, sizeof(*workers));
+    if (!workers) {
+        cm_loop_destroy(&loop);
+        rdma_destroy_event_channel(ch);
+        return -1;
+    }
+
+    // Toutes lancées d'un coup ; attendre la 1re fait aussi avancer
+    // les autres (même boucle)
+    int connected = opts.max_threads;
+    for (int i = 0; i < connected; i++) {
+        struct mt_worker *w = &workers[i];
+        w->idx = i;
+        w->cpu = cpus[i % num_cpus];
+        w->o = &opts;
+        w->slice = o->buf + i * slice;
+        w->slice_size = slice;
+        w->cqw.epfd = -1;           // Rien à fermer tant que pas créé
+        w->cm.on_state = mt_on_state;
+        w->cm.ctx = w;
+        cm_conn_start(&loop, &w->cm, (struct sockaddr *)&addr);
+    }
+    for (int i = 0; i < connected; i++)
+        cm_conn_wait(&loop, &workers[i].cm, CM_WAIT_MS);
+    for (int i = 0; i < connected; i++) {
+        if (mt_finish(&workers[i]))
+            goto out;
+    }
+    printf("   ✅ %d connexions établies (une QP + une CQ chacune)\n", connected);
+
+    double base_gbps = 0;
+    for (int k = 1; ; k = k * 2 < opts.max_threads ? k * 2 : opts.max_threads) {
+        uint64_t ops = 0, bytes = 0;
+        double seconds = 0;
+        int go = 0, started = 0;
+
+        for (; started < k; started++) {
+            workers[started].go = &go;
+            workers[started].opts = o->base;
+            workers[started].ret = -1;
+            if (pthread_create(&workers[started].thread, NULL, mt_run,
+                               &workers[started])) {
+                perror("   ❌ pthread_create");
+                break;
+            }
+        }
+        __atomic_store_n(&go, started == k ? 1 : -1, __ATOMIC_RELEASE);
+        for (int i = 0; i < started; i++)
+            pthread_join(workers[i].thread, NULL);
+
+        for (int i = 0; i < k; i++) {
+            if (workers[i].ret)
+                goto out;
+            ops += workers[i].res.ops;
+            bytes += workers[i].res.bytes;
+            if (workers[i].res.seconds > seconds)
+                seconds = workers[i].res.seconds;
+        }
+
+        double gbps = bytes / seconds / 1e9;
+        if (k == 1)
+            base_gbps = gbps;
+        printf("   📊 %-10s %8zu o  %3d thread(s) : %8.3f GB/s  %8.3f Mops/s"
+               "  (x%.2f)\n", o->name ? o->name : bench_op_name(o->base.op),
+               o->base.size, k, gbps, ops / seconds / 1e6,
+               base_gbps > 0 ? gbps / base_gbps : 0.0);
+        for (int i = 0; i < k; i++) {
+            const struct bench_result *r = &workers[i].res;
+            printf("      thread %3d (cœur %3d) : %8.3f GB/s  %8.3f Mops/s\n",
+                   i, workers[i].cpu, r->bytes / r->seconds / 1e9,
+                   r->ops / r->seconds / 1e6);
+        }
+
+        if (o->round_done && o->round_done(k, o->arg))
+            goto out;
+        if (k == opts.max_threads)
+            break;
+    }
+    status = 0;
+
+out:
+    for (int i = 0; i < connected; i++)
+        mt_disconnect(&workers[i]);
+    free(workers);
+    cm_loop_destroy(&loop);
+    rdma_destroy_event_channel(ch);
+    return status;
+}
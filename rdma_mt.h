@@ -0,0 +1,71 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA MT - Débit multi-threads : une QP et une CQ par thread
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * POURQUOI ?
+ * → UN cœur qui poste et poll plafonne bien avant un lien 100/200
+ *   Gb/s en petits messages : il faut plusieurs cœurs
+ * → Une QP partagée entre threads = un verrou dans le driver et des
+ *   lignes de cache qui font le ping-pong entre cœurs
+ *
+ * DONC, PAR THREAD :
+ * → SA connexion RC (son cm_id, sa QP) : le serveur en accepte N,
+ *   établies toutes ensemble sur un canal CM commun (rdma_cmloop.h)
+ * → SA CQ (et sa façon d'y attendre, voir rdma_cq.h)
+ * → SA tranche du buffer local ET de la RAM serveur
+ * → Épinglé sur un cœur du nœud NUMA choisi (celui de la carte,
+ *   voir rdma_numa.h)
+ *
+ * EN COMMUN : le PD et la MR du buffer local (une seule MR, des
+ * tranches disjointes : pas de faux partage entre threads).
+ *
+ *   thread 0 ─ QP0/CQ0 ─┐
+ *   thread 1 ─ QP1/CQ1 ─┼─ PD ─ carte ══ lien ══ serveur
+ *   thread N ─ QPN/CQN ─┘
+ */
+
+#ifndef RDMA_MT_H
+#define RDMA_MT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <infiniband/verbs.h>
+
+#include "rdma_bench.h"
+
+struct mt_opts {
+    const char *server_ip;
+    struct ibv_pd *pd;              // Partagé : toutes les QP sur cette carte
+    char *buf;                      // Buffer enregistré, découpé en tranches
+    size_t buf_size;
+    uint32_t lkey;
+
+    int node;                       // Nœud des cœurs (-1 = inconnu : tous)
+    int max_threads;                // 0 = un par cœur de node
+    int inline_size;
+    enum cq_mode cq_mode;
+    int spin_us;
+    struct bench_opts base;         // op, size, queue_depth, signal_every,
+                                    // batch, duration_s
+
+    // Autre chose que bench_bw à chaque palier (NULL : bench_bw).
+    // body : ce que fait le thread idx sur SA connexion (conn = sa
+    //        tranche), res à remplir comme bench_bw. 0 si succès.
+    // round_done : après le palier de k threads (NULL : rien).
+    //        Non nul : on arrête là.
+    // name : nom dans le tableau (NULL : bench_op_name(base.op))
+    int (*body)(struct bench_conn *conn, int idx,
+                const struct bench_opts *opts, struct bench_result *res,
+                void *arg);
+    int (*round_done)(int k, void *arg);
+    const char *name;
+    void *arg;
+};
+
+// Établit max_threads connexions, puis mesure le débit avec 1, 2,
+// 4, ... max_threads threads en même temps (chacun = bench_bw, ou
+// body, sur SA QP). Débit total + par thread. Retourne 0 si succès.
+int bench_threads(const struct mt_opts *o);
+
+#endif /* RDMA_MT_H */
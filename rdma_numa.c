@@ -0,0 +1,162 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA NUMA - Où est branchée la carte, quels cœurs sont à côté
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * Voir rdma_numa.h
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "rdma_numa.h"
+
+// Politiques mémoire du noyau (<numaif.h> vient avec libnuma : on
+// s'en passe, les valeurs sont celles de l'ABI Linux)
+#define MPOL_DEFAULT    0
+#define MPOL_PREFERRED  1
+#define MPOL_BIND       2
+#define MPOL_MF_MOVE    (1 << 1)
+#define MPOL_F_NODE     (1 << 0)
+#define MPOL_F_ADDR     (1 << 1)
+#define NUMA_MAX_NODES  64
+
+int numa_dev_node(struct ibv_device *dev) {
+    char path[512];
+    int node = -1;
+
+    snprintf(path, sizeof(path), "%s/device/numa_node", dev->ibdev_path);
+    FILE *f = fopen(path, "r");
+    if (!f)
+        return -1;
+    if (fscanf(f, "%d", &node) != 1)
+        node = -1;
+    fclose(f);
+    return node;
+}
+
+// Fichier sysfs "0-15,32-47" → 0, 1, ... 15, 32, ... 47
+static int parse_list(const char *path, int *out, int max) {
+    char list[4096];
+    int n = 0;
+
+    FILE *f = fopen(path, "r");
+    if (!f)
+        return 0;
+    if (!fgets(list, sizeof(list), f)) {
+        fclose(f);
+        return 0;
+    }
+    fclose(f);
+
+    char *p = list;
+    while (*p && *p != '\n' && n < max) {
+        char *end;
+        long lo = strtol(p, &end, 10), hi = lo;
+        if (end == p)
+            break;
+        if (*end == '-')
+            hi = strtol(end + 1, &end, 10);
+        for (long c = lo; c <= hi && n < max; c++)
+            out[n++] = (int)c;
+        p = (*end == ',') ? end + 1 : end;
+    }
+    return n;
+}
+
+int numa_cpus_of_node(int node, int *cpus, int max) {
+    char path[128];
+
+    if (node < 0)
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/online");
+    else
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist",
+                 node);
+    return parse_list(path, cpus, max);
+}
+
+// ═══════════════════════════════════════════════════════
+// CHOIX DU NŒUD : CELUI DE LA CARTE... OU UN AUTRE (EXPRÈS)
+// ═══════════════════════════════════════════════════════
+// cross = 1 : le nœud suivant, pour MESURER le prix de
+// l'interconnexion entre sockets (jamais un bon choix en production)
+
+int numa_pick_node(int dev_node, int cross) {
+    int nodes[NUMA_MAX_NODES];
+
+    if (dev_node < 0 || !cross)
+        return dev_node;
+
+    int n = parse_list("/sys/devices/system/node/online", nodes, NUMA_MAX_NODES);
+    for (int i = 0; i < n; i++) {
+        if (nodes[i] == dev_node)
+            return nodes[(i + 1) % n];
+    }
+    return dev_node;
+}
+
+int numa_pin_cpu(int cpu) {
+    cpu_set_t set;
+
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+int numa_pin_node(int node) {
+    int cpus[NUMA_MAX_CPUS];
+    cpu_set_t set;
+
+    int n = numa_cpus_of_node(node, cpus, NUMA_MAX_CPUS);
+    if (n == 0)
+        return -1;
+    CPU_ZERO(&set);
+    for (int i = 0; i < n; i++)
+        CPU_SET(cpus[i], &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+// ═══════════════════════════════════════════════════════
+// MÉMOIRE : OÙ LE NOYAU PREND LES PAGES
+// ═══════════════════════════════════════════════════════
+// → numa_prefer : politique du THREAD appelant, pour ses
+//   allocations FUTURES (mmap fautés, anneaux de CQ / QP que le
+//   driver alloue en espace utilisateur, chunks du pool)
+// → numa_move : pages DÉJÀ là (RAM exposée allouée avant de
+//   connaître la carte) déplacées par le noyau
+// Les pages épinglées par une MR ne bougent plus : déplacer AVANT
+// ibv_reg_mr.
+
+int numa_prefer(int node) {
+    if (node >= NUMA_MAX_NODES)
+        return -1;
+    if (node < 0)
+        return syscall(SYS_set_mempolicy, MPOL_DEFAULT, NULL, 0);
+
+    unsigned long mask = 1UL << node;
+    return syscall(SYS_set_mempolicy, MPOL_PREFERRED, &mask, NUMA_MAX_NODES);
+}
+
+int numa_move(void *addr, size_t len, int node) {
+    if (node < 0 || node >= NUMA_MAX_NODES)
+        return -1;
+
+    unsigned long mask = 1UL << node;
+    return syscall(SYS_mbind, addr, len, MPOL_BIND, &mask, NUMA_MAX_NODES,
+                   MPOL_MF_MOVE);
+}
+
+int numa_node_of_addr(void *addr) {
+    int node = -1;
+
+    if (syscall(SYS_get_mempolicy, &node, NULL, 0, addr,
+                MPOL_F_NODE | MPOL_F_ADDR))
+        return -1;
+    return node;
+}
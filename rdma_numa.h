@@ -0,0 +1,53 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA NUMA - Où est branchée la carte, quels cœurs sont à côté
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * Sur une machine à deux sockets, la carte est reliée en PCIe à UN
+ * seul d'entre eux. Un thread qui poll depuis l'autre socket paie
+ * l'interconnexion (UPI / Infinity Fabric) à chaque doorbell et
+ * chaque CQE. Même chose pour la mémoire : un DMA de la carte vers
+ * la RAM de l'autre socket la traverse aussi.
+ *
+ * Tout vient de sysfs et des appels système, sans libnuma :
+ *   /sys/class/infiniband/<carte>/device/numa_node
+ *   /sys/devices/system/node/node<N>/cpulist
+ *   set_mempolicy / mbind / get_mempolicy
+ */
+
+#ifndef RDMA_NUMA_H
+#define RDMA_NUMA_H
+
+#include <stddef.h>
+#include <infiniband/verbs.h>
+
+#define NUMA_MAX_CPUS 1024
+
+// Nœud NUMA de la carte (-1 si inconnu : mono-socket, VM)
+int numa_dev_node(struct ibv_device *dev);
+
+// Cœurs en ligne du nœud node (node < 0 : tous les cœurs), rangés
+// dans cpus[0..max). Retourne leur nombre (0 si erreur).
+int numa_cpus_of_node(int node, int *cpus, int max);
+
+// Nœud où placer mémoire et threads : dev_node, ou (cross) un AUTRE
+// nœud en ligne pour mesurer la pénalité. -1 si inconnu.
+int numa_pick_node(int dev_node, int cross);
+
+// Épingle le thread appelant sur cpu / sur tous les cœurs de node.
+// Retourne 0 si succès.
+int numa_pin_cpu(int cpu);
+int numa_pin_node(int node);
+
+// Allocations FUTURES du thread appelant de préférence sur node
+// (node < 0 : politique par défaut). Retourne 0 si succès.
+int numa_prefer(int node);
+
+// Déplace les pages DÉJÀ allouées de [addr, addr+len) sur node
+// (avant ibv_reg_mr). Retourne 0 si succès.
+int numa_move(void *addr, size_t len, int node);
+
+// Nœud de la page qui contient addr (-1 si inconnu)
+int numa_node_of_addr(void *addr);
+
+#endif /* RDMA_NUMA_H */
@@ -0,0 +1,191 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA PAGE - Pages distantes façon InfiniSwap
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * Voir rdma_page.h
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "rdma_page.h"
+
+void page_store_init(struct page_store *ps, struct ibv_qp *qp,
+                     struct cq_waiter *cqw, uint32_t lkey,
+                     uint64_t remote_addr, uint64_t remote_size,
+                     uint32_t rkey) {
+    memset(ps, 0, sizeof(*ps));
+    ps->qp = qp;
+    ps->cqw = cqw;
+    ps->lkey = lkey;
+    ps->remote_addr = remote_addr;
+    ps->rkey = rkey;
+    ps->num_pages = remote_size / RDMA_PAGE_SIZE;
+    ps->max_sge = 1;
+    ps->max_sge_rd = 1;
+}
+
+void page_store_sge(struct page_store *ps, int max_sge, int max_sge_rd) {
+    ps->max_sge = max_sge < 1 ? 1 : max_sge > PAGE_IOV_MAX ? PAGE_IOV_MAX : max_sge;
+    ps->max_sge_rd = max_sge_rd < 1 ? 1 :
+                     max_sge_rd > PAGE_IOV_MAX ? PAGE_IOV_MAX : max_sge_rd;
+}
+
+// ═══════════════════════════════════════════════════════
+// UNE PAGE, ALLER OU RETOUR
+// ═══════════════════════════════════════════════════════
+// Un WR signalé, un SGE de 4 KB, on attend SA complétion.
+// wr_id = page_id : retrouvé dans le message d'erreur.
+
+static int page_io(struct page_store *ps, enum ibv_wr_opcode opcode,
+                   uint64_t page_id, void *local) {
+    if (page_id >= ps->num_pages) {
+        printf("   ❌ Page %lu hors limites (%lu pages distantes)\n",
+               page_id, ps->num_pages);
+        return -1;
+    }
+
+    struct ibv_sge sge;
+    sge.addr = (uint64_t)local;
+    sge.length = RDMA_PAGE_SIZE;
+    sge.lkey = ps->lkey;
+
+    struct ibv_send_wr wr, *bad_wr;
+    memset(&wr, 0, sizeof(wr));
+    wr.wr_id = page_id;
+    wr.sg_list = &sge;
+    wr.num_sge = 1;
+    wr.opcode = opcode;
+    wr.send_flags = IBV_SEND_SIGNALED;
+    wr.wr.rdma.remote_addr = page_remote_addr(ps, page_id);
+    wr.wr.rdma.rkey = ps->rkey;
+
+    int ret = ibv_post_send(ps->qp, &wr, &bad_wr);
+    if (ret) {
+        printf("   ❌ ibv_post_send (page %lu) : %s\n", page_id, strerror(ret));
+        return -1;
+    }
+
+    struct ibv_wc wc;
+    if (cq_wait(ps->cqw, &wc, 1, -1) < 0)
+        return -1;
+    if (wc.status != IBV_WC_SUCCESS) {
+        printf("   ❌ %s page %lu échoué (status: %s)\n",
+               opcode == IBV_WR_RDMA_WRITE ? "Page-out" : "Page-in",
+               wc.wr_id, ibv_wc_status_str(wc.status));
+        return -1;
+    }
+    return 0;
+}
+
+int page_out(struct page_store *ps, uint64_t page_id, const void *src) {
+    if (page_io(ps, IBV_WR_RDMA_WRITE, page_id, (void *)src))
+        return -1;
+    ps->pages_out++;
+    ps->wrs++;
+    return 0;
+}
+
+int page_in(struct page_store *ps, uint64_t page_id, void *dst) {
+    if (page_io(ps, IBV_WR_RDMA_READ, page_id, dst))
+        return -1;
+    ps->pages_in++;
+    ps->wrs++;
+    return 0;
+}
+
+// ═══════════════════════════════════════════════════════
+// PLUSIEURS PAGES, UNE ZONE DISTANTE
+// ═══════════════════════════════════════════════════════
+// Les iovec sont découpés en WR de max_sge SGE ; chaque WR continue
+// la zone distante là où le précédent s'est arrêté. Tous chaînés
+// dans UN ibv_post_send, seul le dernier est signalé : RC exécute
+// dans l'ordre, sa complétion couvre les autres (et une erreur sur
+// un WR non signalé produit quand même un CQE).
+// Retourne le nombre de WR postés, -1 si erreur.
+
+static int page_io_v(struct page_store *ps, enum ibv_wr_opcode opcode,
+                     uint64_t first_page, const struct iovec *iov,
+                     int iovcnt) {
+    const int per_wr = opcode == IBV_WR_RDMA_READ ? ps->max_sge_rd : ps->max_sge;
+    struct ibv_sge sges[PAGE_IOV_MAX];
+    struct ibv_send_wr wrs[PAGE_IOV_MAX], *bad_wr;
+    uint64_t total = 0;
+
+    if (iovcnt < 1 || iovcnt > PAGE_IOV_MAX) {
+        printf("   ❌ %d buffers : 1..%d par appel\n", iovcnt, PAGE_IOV_MAX);
+        return -1;
+    }
+    for (int i = 0; i < iovcnt; i++)
+        total += iov[i].iov_len;
+    if (first_page >= ps->num_pages ||
+        total > (ps->num_pages - first_page) * RDMA_PAGE_SIZE) {
+        printf("   ❌ Pages %lu.. (%lu octets) hors limites (%lu pages distantes)\n",
+               first_page, total, ps->num_pages);
+        return -1;
+    }
+
+    uint64_t remote = page_remote_addr(ps, first_page);
+    int n = 0;
+    for (int i = 0; i < iovcnt; n++) {
+        struct ibv_send_wr *wr = &wrs[n];
+        memset(wr, 0, sizeof(*wr));
+        wr->wr_id = first_page;
+        wr->sg_list = &sges[i];
+        wr->opcode = opcode;
+        wr->wr.rdma.remote_addr = remote;
+        wr->wr.rdma.rkey = ps->rkey;
+        for (; i < iovcnt && wr->num_sge < per_wr; i++, wr->num_sge++) {
+            sges[i].addr = (uint64_t)iov[i].iov_base;
+            sges[i].length = iov[i].iov_len;
+            sges[i].lkey = ps->lkey;
+            remote += iov[i].iov_len;
+        }
+        wr->next = &wrs[n + 1];
+    }
+    wrs[n - 1].next = NULL;
+    wrs[n - 1].send_flags = IBV_SEND_SIGNALED;
+
+    int ret = ibv_post_send(ps->qp, wrs, &bad_wr);
+    if (ret) {
+        printf("   ❌ ibv_post_send (pages %lu.., %d WR) : %s\n",
+               first_page, n, strerror(ret));
+        return -1;
+    }
+
+    struct ibv_wc wc;
+    if (cq_wait(ps->cqw, &wc, 1, -1) < 0)
+        return -1;
+    if (wc.status != IBV_WC_SUCCESS) {
+        printf("   ❌ %s pages %lu.. échoué (status: %s)\n",
+               opcode == IBV_WR_RDMA_WRITE ? "Page-out" : "Page-in",
+               wc.wr_id, ibv_wc_status_str(wc.status));
+        return -1;
+    }
+    ps->wrs += n;
+    return n;
+}
+
+static uint64_t iov_pages(const struct iovec *iov, int iovcnt) {
+    uint64_t total = 0;
+    for (int i = 0; i < iovcnt; i++)
+        total += iov[i].iov_len;
+    return total / RDMA_PAGE_SIZE;
+}
+
+int page_out_v(struct page_store *ps, uint64_t first_page,
+               const struct iovec *iov, int iovcnt) {
+    if (page_io_v(ps, IBV_WR_RDMA_WRITE, first_page, iov, iovcnt) < 0)
+        return -1;
+    ps->pages_out += iov_pages(iov, iovcnt);
+    return 0;
+}
+
+int page_in_v(struct page_store *ps, uint64_t first_page,
+              const struct iovec *iov, int iovcnt) {
+    if (page_io_v(ps, IBV_WR_RDMA_READ, first_page, iov, iovcnt) < 0)
+        return -1;
+    ps->pages_in += iov_pages(iov, iovcnt);
+    return 0;
+}
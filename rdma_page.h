@@ -0,0 +1,92 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA PAGE - Pages distantes façon InfiniSwap
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * La RAM exposée par le serveur = un tableau de pages de 4 KB :
+ *
+ *   remote_addr
+ *   │
+ *   ▼
+ *   ┌────────┬────────┬────────┬─────┬────────────┐
+ *   │ page 0 │ page 1 │ page 2 │ ... │ page N - 1 │   N = size / 4096
+ *   └────────┴────────┴────────┴─────┴────────────┘
+ *
+ * → page_out(id, src) = RDMA_WRITE de 4 KB vers remote_addr + id * 4096
+ * → page_in(id, dst)  = RDMA_READ  de 4 KB depuis la même adresse
+ * → One-sided : le CPU du serveur ne voit jamais passer une page
+ * → Pas de table côté serveur : l'adresse se CALCULE côté client
+ *
+ * src / dst doivent être dans la MR locale donnée à page_store_init
+ * (la carte lit / écrit par DMA, il lui faut la LKEY).
+ *
+ * VECTORISÉ (page_out_v / page_in_v) :
+ * → Des pages ÉPARPILLÉES en local (un iovec), une zone CONTIGUË
+ *   chez le serveur : un RDMA_WRITE peut rassembler (gather)
+ *   plusieurs SGE, un RDMA_READ les disperser (scatter)
+ * → max_sge SGE par WR (max_sge_rd en lecture) : ce que la QP a
+ *   obtenu à sa création, plafonné par la carte (ibv_query_device)
+ * → N pages = ⌈N / max_sge⌉ WR chaînés, UN doorbell, seul le
+ *   dernier est signalé : moins de WQE à lire pour la carte
+ */
+
+#ifndef RDMA_PAGE_H
+#define RDMA_PAGE_H
+
+#include <stdint.h>
+#include <sys/uio.h>
+#include <infiniband/verbs.h>
+
+#include "rdma_common.h"
+#include "rdma_cq.h"
+
+#define PAGE_IOV_MAX    64      // Buffers par appel vectorisé (et WR
+                                // en vol : la Send Queue doit suivre)
+
+struct page_store {
+    struct ibv_qp *qp;
+    struct cq_waiter *cqw;
+    uint32_t lkey;              // MR locale (src / dst)
+
+    uint64_t remote_addr;       // Page 0 côté serveur
+    uint32_t rkey;
+    uint64_t num_pages;
+    int max_sge;                // SGE par WR : RDMA_WRITE
+    int max_sge_rd;             //              RDMA_READ
+
+    uint64_t pages_out;         // Statistiques
+    uint64_t pages_in;
+    uint64_t wrs;               // WR postés (vectorisé compris)
+};
+
+void page_store_init(struct page_store *ps, struct ibv_qp *qp,
+                     struct cq_waiter *cqw, uint32_t lkey,
+                     uint64_t remote_addr, uint64_t remote_size,
+                     uint32_t rkey);
+
+static inline uint64_t page_remote_addr(const struct page_store *ps,
+                                        uint64_t page_id) {
+    return ps->remote_addr + page_id * RDMA_PAGE_SIZE;
+}
+
+// SGE par WR (1 / 1 après page_store_init) ; plafonnés à PAGE_IOV_MAX
+void page_store_sge(struct page_store *ps, int max_sge, int max_sge_rd);
+
+// Écrit une page chez le serveur (RDMA_WRITE). Synchrone :
+// au retour, la page est dans la RAM distante. 0 si succès.
+int page_out(struct page_store *ps, uint64_t page_id, const void *src);
+
+// Lit une page depuis le serveur (RDMA_READ). Synchrone. 0 si succès.
+int page_in(struct page_store *ps, uint64_t page_id, void *dst);
+
+// Écrit les iovcnt buffers (≤ PAGE_IOV_MAX, tous dans la MR locale)
+// bout à bout chez le serveur, à partir de la page first_page.
+// Synchrone. 0 si succès.
+int page_out_v(struct page_store *ps, uint64_t first_page,
+               const struct iovec *iov, int iovcnt);
+
+// Lit la zone de la même taille dans les iovcnt buffers. Synchrone.
+int page_in_v(struct page_store *ps, uint64_t first_page,
+              const struct iovec *iov, int iovcnt);
+
+#endif /* RDMA_PAGE_H */
@@ -0,0 +1,390 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA PCACHE - Cache local de pages distantes (CLOCK)
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * Voir rdma_pcache.h
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rdma_pcache.h"
+
+static inline uint32_t pc_hash(const struct page_cache *pc, uint64_t page) {
+    page ^= page >> 33;
+    page *= 0xff51afd7ed558ccdULL;
+    page ^= page >> 33;
+    return (uint32_t)page & pc->mask;
+}
+
+static inline char *pc_frame_addr(const struct page_cache *pc, uint32_t f) {
+    return pc->frames + (uint64_t)f * RDMA_PAGE_SIZE;
+}
+
+int pcache_init(struct page_cache *pc, struct page_store *ps, char *frames,
+                size_t frames_size) {
+    memset(pc, 0, sizeof(*pc));
+    pc->ps = ps;
+    pc->frames = frames;
+    pc->num_frames = frames_size / RDMA_PAGE_SIZE;
+    if (pc->num_frames == 0) {
+        printf("   ❌ Cache : moins d'une page\n");
+        return -1;
+    }
+
+    // Au moins 2 entrées par cadre : sondages courts
+    uint32_t slots = 2;
+    while (slots < 2 * pc->num_frames)
+        slots <<= 1;
+    pc->mask = slots - 1;
+
+    pc->meta = malloc(pc->num_frames * sizeof(*pc->meta));
+    pc->table = calloc(slots, sizeof(*pc->table));
+    if (!pc->meta || !pc->table) {
+        perror("   ❌ malloc (cache de pages)");
+        pcache_destroy(pc);
+        return -1;
+    }
+    for (uint32_t f = 0; f < pc->num_frames; f++) {
+        pc->meta[f].page = PC_NO_PAGE;
+        pc->meta[f].pins = 0;
+        pc->meta[f].ref = 0;
+        pc->meta[f].dirty = 0;
+        pc->meta[f].loading = 0;
+        pc->meta[f].prefetched = 0;
+    }
+    return 0;
+}
+
+void pcache_destroy(struct page_cache *pc) {
+    free(pc->meta);
+    free(pc->table);
+    pc->meta = NULL;
+    pc->table = NULL;
+}
+
+// ═══════════════════════════════════════════════════════
+// TABLE : PAGE → CADRE
+// ═══════════════════════════════════════════════════════
+// Lecteurs : chargements acquire, jamais de verrou. La page du cadre
+// est relue APRÈS l'entrée : un cadre en cours de recyclage porte
+// PC_NO_PAGE, le lecteur passe son chemin (faux miss, pas de
+// mauvaise page).
+
+static int64_t pc_find(const struct page_cache *pc, uint64_t page) {
+    for (uint32_t i = pc_hash(pc, page);; i = (i + 1) & pc->mask) {
+        uint32_t e = __atomic_load_n(&pc->table[i], __ATOMIC_ACQUIRE);
+        if (e == 0)
+            return -1;
+        if (__atomic_load_n(&pc->meta[e - 1].page, __ATOMIC_ACQUIRE) == page)
+            return e - 1;
+    }
+}
+
+// Épingler PUIS relire la page (voir pc_evict) : si l'écrivain
+// l'évince en même temps, l'un des deux voit l'autre
+const void *pcache_lookup(struct page_cache *pc, uint64_t page_id) {
+    int64_t f = pc_find(pc, page_id);
+    if (f < 0)
+        return NULL;
+
+    struct pc_frame *m = &pc->meta[f];
+    __atomic_add_fetch(&m->pins, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&m->page, __ATOMIC_SEQ_CST) != page_id ||
+        __atomic_load_n(&m->loading, __ATOMIC_ACQUIRE)) {
+        __atomic_sub_fetch(&m->pins, 1, __ATOMIC_RELEASE);
+        return NULL;
+    }
+    __atomic_store_n(&m->ref, 1, __ATOMIC_RELAXED);
+    return pc_frame_addr(pc, (uint32_t)f);
+}
+
+void pcache_unpin(struct page_cache *pc, const void *frame) {
+    uint32_t f = (uint32_t)(((const char *)frame - pc->frames) / RDMA_PAGE_SIZE);
+    __atomic_sub_fetch(&pc->meta[f].pins, 1, __ATOMIC_RELEASE);
+}
+
+// Écrivain unique : la table n'est jamais pleine (≥ 2 entrées par
+// cadre), il y a toujours un trou
+static void pc_insert(struct page_cache *pc, uint64_t page, uint32_t f) {
+    uint32_t i = pc_hash(pc, page);
+    while (pc->table[i])
+        i = (i + 1) & pc->mask;
+    __atomic_store_n(&pc->table[i], f + 1, __ATOMIC_RELEASE);
+}
+
+// Suppression par décalage arrière : pas de pierre tombale, les
+// sondages restent courts même après des millions d'évictions.
+// L'entrée est cherchée par cadre : sa page est déjà PC_NO_PAGE.
+static void pc_remove(struct page_cache *pc, uint64_t page, uint32_t f) {
+    uint32_t i = pc_hash(pc, page);
+    while (pc->table[i] != f + 1)
+        i = (i + 1) & pc->mask;
+
+    for (uint32_t j = (i + 1) & pc->mask;; j = (j + 1) & pc->mask) {
+        uint32_t e = pc->table[j];
+        if (e == 0)
+            break;
+        // L'entrée j peut remonter en i si sa place idéale n'est pas
+        // entre i (exclu) et j
+        uint32_t home = pc_hash(pc, pc->meta[e - 1].page);
+        if (((j - home) & pc->mask) >= ((j - i) & pc->mask)) {
+            __atomic_store_n(&pc->table[i], e, __ATOMIC_RELEASE);
+            i = j;
+        }
+    }
+    __atomic_store_n(&pc->table[i], 0, __ATOMIC_RELEASE);
+}
+
+// ═══════════════════════════════════════════════════════
+// PRÉCHARGEMENTS EN VOL
+// ═══════════════════════════════════════════════════════
+// wr_id d'un lot = if_head après lui : sa complétion fait avancer
+// if_tail jusque-là, tous les cadres du lot sont arrivés.
+
+static int pc_complete(struct page_cache *pc, const struct ibv_wc *wc, int n) {
+    for (int i = 0; i < n; i++) {
+        if (wc[i].status != IBV_WC_SUCCESS) {
+            printf("   ❌ Préchargement échoué (status: %s)\n",
+                   ibv_wc_status_str(wc[i].status));
+            return -1;
+        }
+        for (; pc->if_tail < wc[i].wr_id; pc->if_tail++) {
+            uint32_t f = pc->inflight[pc->if_tail % PC_INFLIGHT_MAX];
+            __atomic_store_n(&pc->meta[f].loading, 0, __ATOMIC_RELEASE);
+        }
+    }
+    return 0;
+}
+
+int pcache_poll(struct page_cache *pc) {
+    struct ibv_wc wc[8];
+
+    if (pc->if_tail == pc->if_head)
+        return 0;
+    int n = ibv_poll_cq(pc->ps->cqw->cq, 8, wc);
+    if (n < 0) {
+        printf("   ❌ ibv_poll_cq (préchargement) échoué\n");
+        return -1;
+    }
+    return pc_complete(pc, wc, n);
+}
+
+// Attend que le cadre f soit arrivé (f == -1 : tout ce qui est en vol)
+static int pc_wait(struct page_cache *pc, int64_t f) {
+    struct ibv_wc wc[8];
+
+    while (pc->if_tail != pc->if_head &&
+           (f < 0 || pc->meta[f].loading)) {
+        int n = cq_wait(pc->ps->cqw, wc, 8, -1);
+        if (n < 0 || pc_complete(pc, wc, n))
+            return -1;
+    }
+    return 0;
+}
+
+// ═══════════════════════════════════════════════════════
+// CLOCK
+// ═══════════════════════════════════════════════════════
+// Au plus deux tours : au premier, tous les ref passent à 0. Les
+// cadres en cours de préchargement ne sont pas candidats (au plus
+// la moitié des cadres, voir pcache_prefetch), ni les épinglés.
+
+static uint32_t pc_victim(struct page_cache *pc) {
+    for (;;) {
+        uint32_t f = pc->hand;
+        pc->hand = (pc->hand + 1) % pc->num_frames;
+
+        struct pc_frame *m = &pc->meta[f];
+        if (m->page == PC_NO_PAGE)
+            return f;
+        if (m->loading || __atomic_load_n(&m->pins, __ATOMIC_RELAXED))
+            continue;
+        if (__atomic_load_n(&m->ref, __ATOMIC_RELAXED)) {
+            __atomic_store_n(&m->ref, 0, __ATOMIC_RELAXED);
+            continue;
+        }
+        return f;
+    }
+}
+
+// Vide le cadre f : retiré de la table, écrit chez le serveur s'il
+// est sale. 0 si succès, 1 si un lecteur l'a épinglé entre-temps
+// (page remise, rien de changé), -1 si erreur.
+static int pc_evict(struct page_cache *pc, uint32_t f) {
+    struct pc_frame *m = &pc->meta[f];
+    uint64_t page = m->page;
+
+    if (page == PC_NO_PAGE)
+        return 0;
+    // Effacer la page PUIS lire pins (voir pcache_lookup)
+    __atomic_store_n(&m->page, PC_NO_PAGE, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&m->pins, __ATOMIC_SEQ_CST)) {
+        __atomic_store_n(&m->page, page, __ATOMIC_RELEASE);
+        return 1;
+    }
+    pc_remove(pc, page, f);
+    pc->evictions++;
+    if (m->prefetched) {
+        m->prefetched = 0;
+        pc->pf_wasted++;
+    }
+
+    if (m->dirty) {
+        if (pc_wait(pc, -1) || page_out(pc->ps, page, pc_frame_addr(pc, f)))
+            return -1;
+        m->dirty = 0;
+        pc->writebacks++;
+    }
+    return 0;
+}
+
+// Un cadre vide, pris par CLOCK. -1 si erreur.
+static int64_t pc_take(struct page_cache *pc) {
+    for (;;) {
+        uint32_t f = pc_victim(pc);
+        int ret = pc_evict(pc, f);
+        if (ret <= 0)
+            return ret ? -1 : f;
+    }
+}
+
+void *pcache_get(struct page_cache *pc, uint64_t page_id, int write) {
+    if (write)
+        pc->writes++;
+    else
+        pc->reads++;
+
+    int64_t hit = pc_find(pc, page_id);
+    if (hit >= 0) {
+        struct pc_frame *m = &pc->meta[hit];
+        if (m->loading) {
+            pc->pf_late++;
+            if (pc_wait(pc, hit))
+                return NULL;
+        }
+        if (m->prefetched) {
+            m->prefetched = 0;
+            pc->pf_used++;
+        }
+        __atomic_store_n(&m->ref, 1, __ATOMIC_RELAXED);
+        m->dirty |= write;
+        pc->hits++;
+        return pc_frame_addr(pc, (uint32_t)hit);
+    }
+
+    // Miss : un cadre, puis la page (lue même pour une écriture)
+    pc->misses++;
+    int64_t f = pc_take(pc);
+    if (f < 0)
+        return NULL;
+
+    char *frame = pc_frame_addr(pc, (uint32_t)f);
+    if (pc_wait(pc, -1) || page_in(pc->ps, page_id, frame))
+        return NULL;
+
+    struct pc_frame *m = &pc->meta[f];
+    __atomic_store_n(&m->ref, 1, __ATOMIC_RELAXED);
+    m->dirty = write;
+    __atomic_store_n(&m->page, page_id, __ATOMIC_RELEASE);
+    pc_insert(pc, page_id, (uint32_t)f);
+    return frame;
+}
+
+int pcache_flush(struct page_cache *pc) {
+    if (pc_wait(pc, -1))
+        return -1;
+    for (uint32_t f = 0; f < pc->num_frames; f++) {
+        struct pc_frame *m = &pc->meta[f];
+        if (m->page == PC_NO_PAGE || !m->dirty)
+            continue;
+        if (page_out(pc->ps, m->page, pc_frame_addr(pc, f)))
+            return -1;
+        m->dirty = 0;
+        pc->writebacks++;
+    }
+    return 0;
+}
+
+// ═══════════════════════════════════════════════════════
+// PRÉCHARGEMENT : UN LOT = UNE CHAÎNE DE WR
+// ═══════════════════════════════════════════════════════
+// Chaque page prend un cadre (CLOCK), publié loading avant le
+// post : un pcache_get qui arrive dessus attendra la complétion au
+// lieu de relire la page. Une page qui suit la précédente chez le
+// serveur devient un SGE de plus du même WR (scatter vers des
+// cadres quelconques), jusqu'à max_sge_rd.
+
+int pcache_prefetch(struct page_cache *pc, const uint64_t *pages, int n) {
+    struct page_store *ps = pc->ps;
+    struct ibv_sge sges[PC_INFLIGHT_MAX];
+    struct ibv_send_wr wrs[PC_INFLIGHT_MAX], *bad_wr;
+    uint64_t limit = pc->num_frames / 2 < PC_INFLIGHT_MAX ?
+                     pc->num_frames / 2 : PC_INFLIGHT_MAX;
+    int done = 0, issued = 0, nwr = 0;
+
+    if (pcache_poll(pc))
+        return -1;
+
+    for (; done < n; done++) {
+        const uint64_t page = pages[done];
+        if (page >= ps->num_pages || pc_find(pc, page) >= 0)
+            continue;
+        if (pc->if_head + issued - pc->if_tail >= limit)
+            break;
+
+        int64_t f = pc_take(pc);
+        if (f < 0)
+            return -1;
+
+        struct pc_frame *m = &pc->meta[f];
+        __atomic_store_n(&m->ref, 1, __ATOMIC_RELAXED);
+        m->dirty = 0;
+        m->prefetched = 1;
+        __atomic_store_n(&m->loading, 1, __ATOMIC_RELAXED);
+        __atomic_store_n(&m->page, page, __ATOMIC_RELEASE);
+        pc_insert(pc, page, (uint32_t)f);
+        pc->inflight[(pc->if_head + issued) % PC_INFLIGHT_MAX] = (uint32_t)f;
+
+        struct ibv_sge *sge = &sges[issued];
+        sge->addr = (uint64_t)pc_frame_addr(pc, (uint32_t)f);
+        sge->length = RDMA_PAGE_SIZE;
+        sge->lkey = ps->lkey;
+
+        struct ibv_send_wr *wr = nwr ? &wrs[nwr - 1] : NULL;
+        if (wr && wr->num_sge < ps->max_sge_rd &&
+            wr->wr.rdma.remote_addr + (uint64_t)wr->num_sge * RDMA_PAGE_SIZE ==
+            page_remote_addr(ps, page)) {
+            wr->num_sge++;
+        } else {
+            wr = &wrs[nwr++];
+            memset(wr, 0, sizeof(*wr));
+            wr->sg_list = sge;
+            wr->num_sge = 1;
+            wr->opcode = IBV_WR_RDMA_READ;
+            wr->wr.rdma.remote_addr = page_remote_addr(ps, page);
+            wr->wr.rdma.rkey = ps->rkey;
+            if (nwr > 1)
+                wrs[nwr - 2].next = wr;
+        }
+        issued++;
+    }
+    if (issued == 0)
+        return done;
+
+    wrs[nwr - 1].wr_id = pc->if_head + issued;
+    wrs[nwr - 1].send_flags = IBV_SEND_SIGNALED;
+    int ret = ibv_post_send(ps->qp, wrs, &bad_wr);
+    if (ret) {
+        printf("   ❌ ibv_post_send (préchargement, %d WR) : %s\n",
+               nwr, strerror(ret));
+        return -1;
+    }
+    pc->if_head += issued;
+    pc->prefetches += issued;
+    ps->pages_in += issued;
+    ps->wrs += nwr;
+    return done;
+}
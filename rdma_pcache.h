@@ -0,0 +1,158 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA PCACHE - Cache local de pages distantes (CLOCK)
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * POURQUOI ?
+ * → page_in / page_out (rdma_page.h) = un aller-retour réseau à
+ *   CHAQUE accès, même sur la page touchée juste avant
+ * → Les accès réels sont biaisés (zipf) : une petite partie des
+ *   pages reçoit l'essentiel du trafic. Gardées en DRAM locale, un
+ *   accès coûte ~100 ns au lieu de quelques μs
+ *
+ * LE CACHE :
+ *
+ *   frames (dans la MR locale)        table (adressage ouvert)
+ *   ┌─────────┬─────────┬─────┐      ┌───┬───┬───┬───┬───┬───┐
+ *   │ cadre 0 │ cadre 1 │ ... │      │ 0 │ 2 │ 0 │ 1 │ 0 │ … │
+ *   └─────────┴─────────┴─────┘      └───┴───┴───┴───┴───┴───┘
+ *   meta : page, ref, dirty           page → cadre + 1 (0 = vide)
+ *
+ * → Un cadre = une page de 4 KB, DANS la MR de ps : page_in y lit
+ *   directement, page_out en repart, aucune copie
+ * → Table : sondage linéaire, au moins 2 entrées par cadre
+ *
+ * LOOKUP SANS VERROU (pcache_lookup, depuis d'autres threads) :
+ * → Un seul thread MODIFIE le cache (pcache_get, prefetch, flush)
+ * → Les entrées de la table, meta.page, ref, loading et pins ne sont
+ *   lues / écrites qu'atomiquement ; une entrée n'est publiée
+ *   (release) qu'une fois la page chargée dans son cadre, ou le cadre
+ *   marqué loading (préchargement, voir plus bas) : un lecteur
+ *   (acquire) qui trouve la page, loading à 0, voit son contenu
+ * → Le lecteur ÉPINGLE le cadre (pins + 1), PUIS relit sa page ;
+ *   l'écrivain, pour évincer, efface la page (PC_NO_PAGE), PUIS lit
+ *   pins. Les deux en seq_cst : l'un des deux voit l'autre. Le
+ *   lecteur recule (faux miss) ou l'écrivain remet la page et prend
+ *   un autre cadre : un cadre épinglé n'est jamais rechargé
+ * → pcache_unpin dès que le lecteur a fini ; le contenu ne bouge pas
+ *   entre-temps, tant que l'écrivain ne modifie pas cette page
+ * → Faux miss possibles (cadre en cours d'éviction, entrée déplacée
+ *   par une suppression) : jamais de mauvaise page
+ *
+ * ÉVICTION CLOCK :
+ * → Chaque accès (lookup compris) met le bit ref du cadre à 1
+ * → Il faut un cadre : l'aiguille tourne, remet à 0 les ref à 1 et
+ *   prend le premier cadre à 0 (une seconde chance, sans la liste
+ *   chaînée d'un LRU à mettre à jour à chaque hit)
+ * → Les cadres épinglés sont sautés (l'écrivain attend si tous le
+ *   sont : les lecteurs ne doivent pas les garder longtemps)
+ *
+ * ÉCRITURES (write-back) :
+ * → pcache_get(..., 1) marque le cadre sale : rien ne part sur le
+ *   réseau tant que la page reste en cache
+ * → Un cadre sale évincé est d'abord écrit chez le serveur
+ *   (page_out) ; pcache_flush écrit tous les cadres sales
+ * → Écriture sur un miss : la page est d'abord lue (on n'écrit
+ *   souvent qu'une partie de la page)
+ *
+ * PRÉCHARGEMENT (pcache_prefetch, piloté par rdma_prefetch.h) :
+ * → RDMA_READ ASYNCHRONES vers des cadres marqués loading, publiés
+ *   tout de suite : un accès qui tombe dessus attend SA complétion
+ *   (compté en retard), pas un aller-retour complet
+ * → Pages distantes consécutives = un WR à plusieurs SGE (comme
+ *   page_in_v) ; un lot = une chaîne, un doorbell, seul le dernier
+ *   WR signalé (wr_id = préchargements lancés, cumul : RC termine
+ *   dans l'ordre, sa complétion libère tout le lot)
+ * → page_in / page_out sont synchrones et attendent LEUR complétion :
+ *   avant eux (miss, write-back, flush), on laisse finir ce qui est
+ *   en vol. Rien de perdu : RC les aurait exécutés après, de toute
+ *   façon
+ * → Au plus PC_INFLIGHT_MAX pages en vol, et la moitié des cadres :
+ *   CLOCK saute les cadres loading, il lui en reste toujours
+ */
+
+#ifndef RDMA_PCACHE_H
+#define RDMA_PCACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rdma_page.h"
+
+#define PC_NO_PAGE      UINT64_MAX      // Cadre libre
+#define PC_INFLIGHT_MAX PAGE_IOV_MAX    // Préchargements en vol (et WR :
+                                        // la Send Queue doit suivre)
+
+struct pc_frame {
+    uint64_t page;              // PC_NO_PAGE = libre (accès atomiques)
+    uint32_t pins;              // Lecteurs (pcache_lookup) en cours (atomique)
+    uint8_t ref;                // CLOCK : touché depuis le dernier tour (atomique)
+    uint8_t dirty;              // Modifié, pas encore écrit chez le serveur
+    uint8_t loading;            // RDMA_READ de préchargement en vol (atomique)
+    uint8_t prefetched;         // Préchargé, pas encore demandé
+};
+
+struct page_cache {
+    struct page_store *ps;
+    char *frames;               // num_frames pages, dans la MR de ps
+    uint32_t num_frames;
+    struct pc_frame *meta;
+    uint32_t *table;            // page → cadre + 1 (accès atomiques)
+    uint32_t mask;              // Taille de la table - 1
+    uint32_t hand;              // Aiguille de CLOCK
+
+    // Préchargements en vol, dans l'ordre des WR
+    uint32_t inflight[PC_INFLIGHT_MAX];
+    uint64_t if_head;           // Pages lancées (cumul)
+    uint64_t if_tail;           // Pages arrivées (cumul)
+
+    uint64_t reads, writes;     // Statistiques (accès)
+    uint64_t hits, misses;
+    uint64_t evictions;
+    uint64_t writebacks;        // page_out de cadres sales
+    uint64_t prefetches;        // Pages préchargées
+    uint64_t pf_used;           // ... puis demandées (hits grâce à elles)
+    uint64_t pf_late;           // ... demandées encore en vol
+    uint64_t pf_wasted;         // ... évincées sans avoir servi
+};
+
+// frames : frames_size octets (≥ une page) dans la MR locale de ps.
+// Retourne 0 si succès.
+int pcache_init(struct page_cache *pc, struct page_store *ps, char *frames,
+                size_t frames_size);
+void pcache_destroy(struct page_cache *pc);
+
+// Sans verrou, sans réseau, depuis n'importe quel thread : le cadre
+// de la page, épinglé (lecture seule), ou NULL si absente (ou pas
+// encore arrivée). À rendre par pcache_unpin.
+const void *pcache_lookup(struct page_cache *pc, uint64_t page_id);
+void pcache_unpin(struct page_cache *pc, const void *frame);
+
+// La page, chargée si besoin (éviction + write-back du cadre pris).
+// write : la page va être modifiée (cadre marqué sale).
+// NULL si erreur.
+void *pcache_get(struct page_cache *pc, uint64_t page_id, int write);
+
+// Écrit chez le serveur tous les cadres sales (ils restent en
+// cache, propres), après les préchargements en vol. 0 si succès.
+int pcache_flush(struct page_cache *pc);
+
+// Précharge les pages, dans l'ordre (déjà en cache ou hors limites :
+// sautées). S'arrête quand il y a trop de pages en vol.
+// Retourne le nombre de pages traitées (lancées ou sautées), -1 si
+// erreur.
+int pcache_prefetch(struct page_cache *pc, const uint64_t *pages, int n);
+
+// Récolte les préchargements arrivés, sans attendre. 0 si succès.
+int pcache_poll(struct page_cache *pc);
+
+// Octets qui n'ont pas traversé le réseau : un accès sans cache =
+// une page lue ou écrite, avec = les page_in des misses, les
+// préchargements et les write-backs (négatif si le cache fait pire)
+static inline int64_t pcache_bytes_saved(const struct page_cache *pc) {
+    return ((int64_t)(pc->reads + pc->writes) -
+            (int64_t)(pc->misses + pc->prefetches + pc->writebacks)) *
+           RDMA_PAGE_SIZE;
+}
+
+#endif /* RDMA_PCACHE_H */
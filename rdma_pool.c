@@ -0,0 +1,123 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA POOL - Buffers de messages pré-enregistrés (slab par PD)
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * Voir rdma_pool.h
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rdma_pool.h"
+
+int pool_init(struct mem_pool *p, struct ibv_pd *pd, int access) {
+    memset(p, 0, sizeof(*p));
+    p->pd = pd;
+    p->access = access;
+    return pthread_mutex_init(&p->lock, NULL);
+}
+
+// Plus petite classe qui contient size octets
+static int pool_class(size_t size) {
+    int cls = 0;
+    while ((1UL << (POOL_MIN_SHIFT + cls)) < size)
+        cls++;
+    return cls;
+}
+
+// ═══════════════════════════════════════════════════════
+// NOUVEAU CHUNK : LE SEUL ibv_reg_mr DU POOL
+// ═══════════════════════════════════════════════════════
+// Appelé verrou tenu, quand la classe cls n'a plus de buffer libre.
+// → mmap (aligné sur une page) + UNE MR pour tout le chunk
+// → Découpé en buffers de la classe, tous chaînés dans la liste libre
+
+static int pool_grow(struct mem_pool *p, int cls) {
+    size_t bsize = 1UL << (POOL_MIN_SHIFT + cls);
+
+    struct pool_chunk *ch = calloc(1, sizeof(*ch));
+    if (!ch)
+        return -1;
+
+    if (mem_region_alloc(&ch->region, POOL_CHUNK_SIZE, MEM_PAGES_4K)) {
+        free(ch);
+        return -1;
+    }
+
+    ch->mr = ibv_reg_mr(p->pd, ch->region.addr, ch->region.size, p->access);
+    if (!ch->mr) {
+        perror("   ❌ ibv_reg_mr (pool)");
+        mem_region_free(&ch->region);
+        free(ch);
+        return -1;
+    }
+
+    size_t n = ch->region.size / bsize;
+    ch->bufs = calloc(n, sizeof(*ch->bufs));
+    if (!ch->bufs) {
+        ibv_dereg_mr(ch->mr);
+        mem_region_free(&ch->region);
+        free(ch);
+        return -1;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        struct pool_buf *b = &ch->bufs[i];
+        b->addr = (char *)ch->region.addr + i * bsize;
+        b->lkey = ch->mr->lkey;
+        b->size = bsize;
+        b->cls = cls;
+        b->next = p->free[cls];
+        p->free[cls] = b;
+    }
+
+    ch->next = p->chunks;
+    p->chunks = ch;
+    p->chunks_registered++;
+    return 0;
+}
+
+struct pool_buf *pool_get(struct mem_pool *p, size_t size) {
+    if (size > POOL_MAX_SIZE)
+        return NULL;
+
+    int cls = pool_class(size);
+    struct pool_buf *b = NULL;
+
+    pthread_mutex_lock(&p->lock);
+    if (p->free[cls] || pool_grow(p, cls) == 0) {
+        b = p->free[cls];
+        p->free[cls] = b->next;
+        b->next = NULL;
+        p->gets++;
+    }
+    pthread_mutex_unlock(&p->lock);
+    return b;
+}
+
+void pool_put(struct mem_pool *p, struct pool_buf *b) {
+    if (!b)
+        return;
+
+    pthread_mutex_lock(&p->lock);
+    b->next = p->free[b->cls];
+    p->free[b->cls] = b;
+    pthread_mutex_unlock(&p->lock);
+}
+
+void pool_destroy(struct mem_pool *p) {
+    struct pool_chunk *ch = p->chunks;
+    while (ch) {
+        struct pool_chunk *next = ch->next;
+        ibv_dereg_mr(ch->mr);
+        mem_region_free(&ch->region);
+        free(ch->bufs);
+        free(ch);
+        ch = next;
+    }
+    p->chunks = NULL;
+    memset(p->free, 0, sizeof(p->free));
+    pthread_mutex_destroy(&p->lock);
+}
@@ -0,0 +1,85 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA POOL - Buffers de messages pré-enregistrés (slab par PD)
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * POURQUOI ?
+ * → ibv_reg_mr coûte des dizaines de μs (appel noyau + épinglage +
+ *   MTT) : hors de question sur le chemin chaud
+ * → Une MR par petit buffer = autant d'entrées dans le cache de
+ *   traductions de la carte
+ *
+ * COMMENT ?
+ * → Classes de tailles : 64 o, 128 o, ... 64 KB (puissances de 2)
+ * → Une classe vide = UN gros bloc (chunk) mmap + ibv_reg_mr UNE
+ *   fois, découpé en buffers de la classe
+ * → Chaque buffer porte son adresse ET sa LKEY : prêt pour un SGE
+ * → Rendre un buffer = le remettre en tête de la liste libre de sa
+ *   classe (rien n'est jamais dé-enregistré avant pool_destroy)
+ *
+ *   chunk (1 MR)                       descripteurs (hors chunk)
+ *   ┌──────┬──────┬──────┬─────┐       ┌──────────────────────────┐
+ *   │ 256o │ 256o │ 256o │ ... │  ◄──  │ addr, lkey, size, next   │
+ *   └──────┴──────┴──────┴─────┘       └──────────────────────────┘
+ *
+ * → Buffers alignés sur une ligne de cache (64 o minimum, chunk
+ *   aligné sur une page) : deux buffers ne partagent jamais une ligne
+ * → Les descripteurs vivent HORS du chunk : la carte ne peut pas les
+ *   écraser par DMA
+ * → Un mutex par pool : partageable entre threads (serveur)
+ */
+
+#ifndef RDMA_POOL_H
+#define RDMA_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <infiniband/verbs.h>
+
+#include "rdma_mem.h"
+
+#define POOL_MIN_SHIFT  6           // 64 o = une ligne de cache
+#define POOL_MAX_SHIFT  16          // 64 KB
+#define POOL_CLASSES    (POOL_MAX_SHIFT - POOL_MIN_SHIFT + 1)
+#define POOL_MAX_SIZE   (1UL << POOL_MAX_SHIFT)
+#define POOL_CHUNK_SIZE (256 * 1024)  // Un chunk = une MR
+
+struct pool_buf {
+    char *addr;
+    uint32_t lkey;
+    uint32_t size;              // Capacité (taille de la classe)
+    int cls;
+    struct pool_buf *next;      // Liste libre
+};
+
+struct pool_chunk {
+    struct mem_region region;
+    struct ibv_mr *mr;
+    struct pool_buf *bufs;      // Un descripteur par buffer
+    struct pool_chunk *next;
+};
+
+struct mem_pool {
+    struct ibv_pd *pd;
+    int access;                 // Droits des MR (IBV_ACCESS_*)
+    pthread_mutex_t lock;
+    struct pool_buf *free[POOL_CLASSES];
+    struct pool_chunk *chunks;
+    long chunks_registered;     // = appels à ibv_reg_mr
+    long gets;
+};
+
+// access : IBV_ACCESS_LOCAL_WRITE suffit pour SEND / RECV
+int pool_init(struct mem_pool *p, struct ibv_pd *pd, int access);
+
+// Un buffer d'AU MOINS size octets (NULL si size > POOL_MAX_SIZE ou
+// si un nouveau chunk ne peut être alloué / enregistré)
+struct pool_buf *pool_get(struct mem_pool *p, size_t size);
+
+void pool_put(struct mem_pool *p, struct pool_buf *b);
+
+// Dé-enregistre et libère TOUS les chunks (plus aucun WR en vol)
+void pool_destroy(struct mem_pool *p);
+
+#endif /* RDMA_POOL_H */
@@ -0,0 +1,127 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA PREFETCH - Préchargement séquentiel / à pas des pages distantes
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * Voir rdma_prefetch.h
+ */
+
+#include <string.h>
+
+#include "rdma_prefetch.h"
+
+void pf_init(struct prefetcher *pf, struct page_cache *pc, int window) {
+    memset(pf, 0, sizeof(*pf));
+    pf->pc = pc;
+    pf->window = window < 0 ? 0 : window > PF_WINDOW_MAX ? PF_WINDOW_MAX : window;
+}
+
+// ═══════════════════════════════════════════════════════
+// APPRENTISSAGE
+// ═══════════════════════════════════════════════════════
+// Le flux de l'accès, s'il est confirmé (NULL sinon) :
+// 1. celui dont c'est la page attendue (last + stride)
+// 2. sinon le plus proche, à PF_MAX_STRIDE pages au plus : son pas
+//    devient l'écart observé
+// 3. sinon un nouveau flux, à la place du moins récent
+
+static struct pf_stream *pf_train(struct prefetcher *pf, uint64_t page) {
+    struct pf_stream *best = NULL, *victim = &pf->streams[0];
+    uint64_t best_dist = PF_MAX_STRIDE + 1;
+
+    pf->clock++;
+    for (int i = 0; i < PF_STREAMS; i++) {
+        struct pf_stream *s = &pf->streams[i];
+        if (!s->valid) {
+            if (victim->valid)
+                victim = s;
+            continue;
+        }
+        if (victim->valid && s->used < victim->used)
+            victim = s;
+
+        if (s->last == page) {         // Même page : rien à apprendre
+            s->used = pf->clock;
+            return NULL;
+        }
+        if (s->stride && page == s->last + (uint64_t)s->stride) {
+            best = s;
+            break;
+        }
+        uint64_t dist = page > s->last ? page - s->last : s->last - page;
+        if (dist < best_dist) {
+            best = s;
+            best_dist = dist;
+        }
+    }
+
+    if (!best) {
+        memset(victim, 0, sizeof(*victim));
+        victim->valid = 1;
+        victim->last = page;
+        victim->used = pf->clock;
+        return NULL;
+    }
+
+    int64_t stride = (int64_t)(page - best->last);
+    if (stride == best->stride) {
+        best->seen++;
+    } else {
+        best->stride = stride;
+        best->seen = 1;
+        best->next = page + (uint64_t)stride;
+    }
+    best->last = page;
+    best->used = pf->clock;
+    return best->seen >= PF_CONFIRM ? best : NULL;
+}
+
+// ═══════════════════════════════════════════════════════
+// LANCEMENT
+// ═══════════════════════════════════════════════════════
+// next = première page pas encore lancée : ahead pages sont déjà
+// en vol ou en cache devant last. Un flux qui a doublé son
+// préchargement (ahead < 0) repart de last + stride.
+
+static int pf_issue(struct prefetcher *pf, struct pf_stream *s) {
+    uint64_t pages[PF_WINDOW_MAX];
+    const uint64_t num_pages = pf->pc->ps->num_pages;
+    int64_t ahead = (int64_t)(s->next - s->last) / s->stride - 1;
+    int n = 0;
+
+    if (ahead < 0) {
+        s->next = s->last + (uint64_t)s->stride;
+        ahead = 0;
+    }
+    if (ahead > pf->window / 2)
+        return 0;
+
+    // Pas négatif : page passe sous 0, devient énorme, la boucle s'arrête
+    for (uint64_t page = s->next; n < pf->window - ahead && page < num_pages;
+         page += (uint64_t)s->stride)
+        pages[n++] = page;
+    if (n == 0)
+        return 0;
+
+    uint64_t before = pf->pc->prefetches;
+    int done = pcache_prefetch(pf->pc, pages, n);
+    if (done < 0)
+        return -1;
+    if (pf->pc->prefetches != before)
+        pf->batches++;
+    s->next += (uint64_t)(done * s->stride);
+    return 0;
+}
+
+// Préchargement AVANT la demande : le cadre rendu ne peut pas être
+// évincé par le lot qu'on vient de lancer. Contrepartie : une
+// demande qui rate passe derrière ce lot (même QP, RC dans l'ordre),
+// surtout l'accès qui vient de confirmer un flux.
+void *pf_get(struct prefetcher *pf, uint64_t page_id, int write) {
+    if (pf->window > 0) {
+        struct pf_stream *s = pf_train(pf, page_id);
+        if (s && pf_issue(pf, s))
+            return NULL;
+    }
+    return pcache_get(pf->pc, page_id, write);
+}
@@ -0,0 +1,81 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA PREFETCH - Préchargement séquentiel / à pas des pages distantes
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * POURQUOI ?
+ * → Un balayage de la mémoire distante = un miss par page, et chaque
+ *   miss attend SON aller-retour : le débit plafonne à
+ *   4 KB / latence (~1 Go/s à 4 μs), loin du lien
+ * → Si on devine les pages suivantes, on les demande AVANT : N
+ *   RDMA_READ en vol, la latence se recouvre, le débit suit le lien
+ *
+ * FLUX (PF_STREAMS suivis en même temps) :
+ * → Un flux = la dernière page demandée + le pas observé
+ * → Chaque accès est rattaché au flux dont il est la page attendue,
+ *   sinon au flux le plus proche (≤ PF_MAX_STRIDE pages), sinon il
+ *   en ouvre un (à la place du moins récemment utilisé)
+ * → Même pas PF_CONFIRM fois de suite : le flux est confirmé, on
+ *   précharge last + pas, + 2 pas, ... jusqu'à window pages d'avance
+ * → Pas négatif accepté (balayage à l'envers)
+ *
+ * FENÊTRE :
+ * → Relance quand il reste moins de window / 2 pages d'avance :
+ *   des lots d'au moins window / 2 pages, un doorbell chacun
+ *   (pcache_prefetch, rdma_pcache.h)
+ * → window = 0 : pas de préchargement (le cache seul)
+ *
+ * COMPTEURS (dans le cache, struct page_cache) :
+ * → précision  = préchargées puis demandées / préchargées
+ *   (le reste : bande passante gâchée, cadres pris pour rien)
+ * → couverture = misses évités / misses qu'on aurait eus
+ *   = pf_used / (pf_used + misses)
+ * → en retard  = demandées avant d'être arrivées (fenêtre trop
+ *   courte pour la latence)
+ */
+
+#ifndef RDMA_PREFETCH_H
+#define RDMA_PREFETCH_H
+
+#include <stdint.h>
+
+#include "rdma_pcache.h"
+
+#define PF_STREAMS      8           // Flux suivis en même temps
+#define PF_WINDOW_MAX   PC_INFLIGHT_MAX
+#define PF_MAX_STRIDE   64          // Écart max (pages) pour suivre un flux
+#define PF_CONFIRM      2           // Même pas N fois de suite : confirmé
+
+struct pf_stream {
+    int valid;
+    uint64_t last;                  // Dernière page demandée
+    int64_t stride;                 // Pas observé (pages), 0 = aucun
+    uint32_t seen;                  // Fois de suite où ce pas est revenu
+    uint64_t next;                  // Prochaine page à précharger
+    uint64_t used;                  // Dernier accès (remplacement LRU)
+};
+
+struct prefetcher {
+    struct page_cache *pc;
+    int window;                     // Pages d'avance, 0..PF_WINDOW_MAX
+    struct pf_stream streams[PF_STREAMS];
+    uint64_t clock;                 // Accès (horloge du LRU)
+    uint64_t batches;               // Lots lancés
+};
+
+void pf_init(struct prefetcher *pf, struct page_cache *pc, int window);
+
+// pcache_get, puis apprentissage du flux et préchargement.
+// NULL si erreur.
+void *pf_get(struct prefetcher *pf, uint64_t page_id, int write);
+
+static inline double pf_accuracy(const struct page_cache *pc) {
+    return pc->prefetches ? (double)pc->pf_used / pc->prefetches : 0.0;
+}
+
+static inline double pf_coverage(const struct page_cache *pc) {
+    return pc->pf_used + pc->misses ?
+           (double)pc->pf_used / (pc->pf_used + pc->misses) : 0.0;
+}
+
+#endif /* RDMA_PREFETCH_H */
@@ -0,0 +1,129 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA RING - Anneau de messages par RDMA_WRITE_WITH_IMM
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * Voir rdma_ring.h
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "rdma_ring.h"
+
+_Static_assert(sizeof(struct ring_hdr) == RING_HDR_SIZE, "en-tête de slot");
+_Static_assert(RING_SLOTS_MAX <= 256, "slot : 8 bits de l'imm");
+
+int ring_shift_for(size_t len) {
+    for (int shift = RING_SHIFT_MIN; shift <= RING_SHIFT_MAX; shift++)
+        if (len + RING_HDR_SIZE <= (1u << shift))
+            return shift;
+    return -1;
+}
+
+void ring_init(struct ring *r, struct ibv_qp *qp, char *rx, uint32_t slots,
+               uint32_t slot_shift, uint32_t max_inline) {
+    memset(r, 0, sizeof(*r));
+    r->qp = qp;
+    r->slots = slots;
+    r->slot_size = 1u << slot_shift;
+    r->max_inline = max_inline;
+    r->rx = rx;
+}
+
+void ring_set_peer(struct ring *r, const struct ring_desc *peer) {
+    r->peer = *peer;
+}
+
+// Crédit reçu (cumul, sur mask bits) : un crédit plus ancien que le
+// dernier connu (arrivé par un autre chemin) est ignoré
+static void ring_ack(struct ring *r, uint32_t credit, uint32_t mask) {
+    uint32_t delta = (credit - r->tx_acked) & mask;
+    if (delta <= r->tx_tail - r->tx_acked)
+        r->tx_acked += delta;
+}
+
+static int ring_write(struct ring *r, char *buf, uint32_t len, uint32_t lkey,
+                      uint64_t remote_addr, uint32_t imm) {
+    struct ibv_sge sge;
+    sge.addr = (uint64_t)buf;
+    sge.length = len;
+    sge.lkey = lkey;
+
+    struct ibv_send_wr wr, *bad_wr;
+    memset(&wr, 0, sizeof(wr));
+    wr.wr_id = r->posted;
+    wr.sg_list = len ? &sge : NULL;
+    wr.num_sge = len ? 1 : 0;
+    wr.opcode = IBV_WR_RDMA_WRITE_WITH_IMM;
+    wr.imm_data = htonl(imm);
+    wr.wr.rdma.remote_addr = remote_addr;
+    wr.wr.rdma.rkey = r->peer.rkey;
+    if (len && len <= r->max_inline)
+        wr.send_flags = IBV_SEND_INLINE;
+    if (++r->posted % RING_SIGNAL_EVERY == 0)
+        wr.send_flags |= IBV_SEND_SIGNALED;
+
+    int ret = ibv_post_send(r->qp, &wr, &bad_wr);
+    if (ret) {
+        printf("   ❌ ibv_post_send (anneau) : %s\n", strerror(ret));
+        return -1;
+    }
+    return 0;
+}
+
+int ring_post(struct ring *r, char *msg, uint32_t len, uint32_t lkey) {
+    if (len > ring_max_msg(r))
+        return -1;
+    if (ring_credits(r) == 0)
+        return 1;
+
+    uint32_t slot = r->tx_tail % r->slots;
+    struct ring_hdr *hdr = (struct ring_hdr *)(msg - RING_HDR_SIZE);
+    hdr->credit = r->rx_head;
+    hdr->seq = r->tx_tail;
+
+    if (ring_write(r, (char *)hdr, RING_HDR_SIZE + len, lkey,
+                   r->peer.addr + (uint64_t)slot * r->slot_size,
+                   CMD_IMM(CMD_RING_MSG, slot << 16 | len)))
+        return -1;
+    r->tx_tail++;
+    r->rx_reported = r->rx_head;
+    return 0;
+}
+
+char *ring_recv(struct ring *r, uint32_t arg, uint32_t *len) {
+    uint32_t slot = arg >> 16;
+    char *p = r->rx + (uint64_t)slot * r->slot_size;
+    const struct ring_hdr *hdr = (const struct ring_hdr *)p;
+
+    // RC = dans l'ordre : c'est forcément le slot suivant
+    if (slot != r->rx_head % r->slots || hdr->seq != r->rx_head ||
+        (arg & 0xFFFF) > ring_max_msg(r)) {
+        printf("   ❌ Anneau désynchronisé : slot %u / seq %u, attendu %u / %u\n",
+               slot, hdr->seq, r->rx_head % r->slots, r->rx_head);
+        return NULL;
+    }
+    ring_ack(r, hdr->credit, 0xFFFFFFFFu);
+    *len = arg & 0xFFFF;
+    return p + RING_HDR_SIZE;
+}
+
+int ring_release(struct ring *r) {
+    r->rx_head++;
+    if (r->rx_head - r->rx_reported < (r->slots + 1) / 2)
+        return 0;
+
+    // Personne à qui les confier : un WRITE de 0 octet
+    if (ring_write(r, NULL, 0, 0, r->peer.addr,
+                   CMD_IMM(CMD_RING_CREDIT, r->rx_head)))
+        return -1;
+    r->rx_reported = r->rx_head;
+    r->credit_msgs++;
+    return 0;
+}
+
+void ring_credit_in(struct ring *r, uint32_t arg) {
+    ring_ack(r, arg, CMD_ARG_MAX);
+}
@@ -0,0 +1,124 @@
+/*
+ * ════════════════════════════════════════════════════════════════════
+ * RDMA RING - Anneau de messages par RDMA_WRITE_WITH_IMM
+ * ════════════════════════════════════════════════════════════════════
+ *
+ * POURQUOI ?
+ * → SEND/RECV : chaque message atterrit dans le buffer du prochain
+ *   RECV posté ; côté serveur c'est le puits commun du SRQ (rien
+ *   d'exploitable), côté client il faut un buffer par RECV, et la
+ *   carte doit aller chercher le WQE du RECV avant de placer les
+ *   données
+ * → Ici chaque côté possède un ANNEAU dans la MR de l'autre : on
+ *   écrit directement dans le slot suivant du pair, et l'immediate
+ *   data le prévient (un RECV de 0 octet consommé, sans buffer)
+ *
+ * UN SLOT (1 << slot_shift octets) :
+ *   ┌───────────────────────┬─────────────────────────────────┐
+ *   │ ring_hdr (8 o)        │ message (≤ slot - 8 octets)     │
+ *   │ credit │ seq          │                                 │
+ *   └───────────────────────┴─────────────────────────────────┘
+ * → imm = CMD_RING_MSG, slot << 16 | longueur
+ * → seq : numéro du message (vérifie qu'on n'en a sauté aucun)
+ * → credit : messages du pair que l'émetteur a CONSOMMÉS (cumul) :
+ *   les crédits voyagent avec le trafic, sans message à part
+ *
+ * CRÉDITS :
+ * → On écrit au plus slots messages non consommés chez le pair
+ *   (tx_tail - tx_acked < slots) : jamais d'écrasement
+ * → Sans trafic retour, le récepteur rend ses crédits seul : un
+ *   RDMA_WRITE_WITH_IMM de 0 octet (CMD_RING_CREDIT, arg = cumul)
+ *   dès que la moitié de l'anneau est consommée sans être annoncée
+ *
+ * ÉTABLISSEMENT :
+ * → Le client décrit son anneau dans la private_data de son
+ *   connect (struct ring_desc, rdma_common.h)
+ * → Le serveur crée le sien, même géométrie, et le renvoie dans
+ *   l'accept (info.ring, INFO_RING)
+ */
+
+#ifndef RDMA_RING_H
+#define RDMA_RING_H
+
+#include <stdint.h>
+#include <infiniband/verbs.h>
+
+#include "rdma_common.h"
+
+#define RING_SLOTS_MAX      256     // Numéro de slot : 8 bits de l'imm
+#define RING_DEFAULT_SLOTS  64
+#define RING_SHIFT_MIN      6       // Slots de 64 octets ...
+#define RING_SHIFT_MAX      16      // ... à 64 KB (longueur : 16 bits)
+#define RING_HDR_SIZE       8
+#define RING_SIGNAL_EVERY   8       // WRITE : 1 signalé sur 8
+
+struct ring_hdr {
+    uint32_t credit;                // Messages du pair consommés (cumul)
+    uint32_t seq;                   // Numéro de ce message
+};
+
+struct ring {
+    struct ibv_qp *qp;
+    uint32_t slots;
+    uint32_t slot_size;
+    uint32_t max_inline;
+
+    // Réception : NOTRE anneau, écrit par le pair
+    char *rx;
+    uint32_t rx_head;               // Messages consommés (cumul)
+    uint32_t rx_reported;           // Dernier rx_head annoncé au pair
+
+    // Émission : l'anneau du PAIR
+    struct ring_desc peer;
+    uint32_t tx_tail;               // Messages écrits (cumul)
+    uint32_t tx_acked;              // Consommés par le pair (crédits)
+
+    uint64_t posted;                // WR postés (signal 1 sur N)
+    uint64_t credit_msgs;           // Crédits envoyés seuls
+};
+
+// Géométrie acceptable ? (desc reçu d'un pair)
+static inline int ring_desc_valid(const struct ring_desc *d) {
+    return d->rkey && d->slots && d->slots <= RING_SLOTS_MAX &&
+           d->slot_shift >= RING_SHIFT_MIN && d->slot_shift <= RING_SHIFT_MAX;
+}
+
+// Plus petit slot_shift pour des messages de len octets (-1 si trop grand)
+int ring_shift_for(size_t len);
+
+// rx : slots << slot_shift octets, dans une MR avec REMOTE_WRITE.
+// L'anneau du pair (même géométrie) est donné par ring_set_peer.
+void ring_init(struct ring *r, struct ibv_qp *qp, char *rx, uint32_t slots,
+               uint32_t slot_shift, uint32_t max_inline);
+void ring_set_peer(struct ring *r, const struct ring_desc *peer);
+
+// Slots libres chez le pair
+static inline uint32_t ring_credits(const struct ring *r) {
+    return r->slots - (r->tx_tail - r->tx_acked);
+}
+
+// Plus grand message
+static inline uint32_t ring_max_msg(const struct ring *r) {
+    return r->slot_size - RING_HDR_SIZE;
+}
+
+// Écrit le message msg (len octets, dans une MR de LKEY lkey) dans le
+// slot suivant du pair. RING_HDR_SIZE octets AVANT msg sont réservés
+// à l'en-tête (rempli ici), et msg ne doit pas bouger avant la
+// réponse. Retourne 0 si posté, 1 si pas de crédit, -1 si erreur.
+int ring_post(struct ring *r, char *msg, uint32_t len, uint32_t lkey);
+
+// Complétion CMD_RING_MSG (arg de l'imm) : le message, dans NOTRE
+// anneau, et sa longueur ; NULL si désynchronisé. Le slot reste à
+// nous jusqu'à ring_release.
+char *ring_recv(struct ring *r, uint32_t arg, uint32_t *len);
+
+// Rend le slot du plus ancien message reçu (crédit annoncé au
+// prochain ring_post, ou seul si la moitié de l'anneau attend).
+// Retourne 0 si succès.
+int ring_release(struct ring *r);
+
+// Complétion CMD_RING_CREDIT (arg de l'imm)
+void ring_credit_in(struct ring *r, uint32_t arg);
+
+#endif /* RDMA_RING_H */
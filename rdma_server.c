@@ -5,43 +5,1174 @@
  * 
  * CE QUE FAIT CE PROGRAMME :
  * 
- * 1. Alloue 1 MB de RAM
+ * 1. Alloue 1 MB de RAM (ou plus, avec -b)
  * 2. Écrit "Hello from Server!" dedans
  * 3. EXPOSE cette RAM via InfiniBand
- * 4. Donne au client : adresse + clé d'accès (RKEY)
+ * 4. Donne à CHAQUE client : adresse + clé d'accès (RKEY)
  * 5. DORT - ne touche plus jamais cette RAM
  * 
  * LE TRUC FOU :
  * → Le client va lire/écrire dans cette RAM
  * → Sans JAMAIS réveiller le CPU du serveur
  * → La carte InfiniBand gère tout !
+ * → Même les compteurs et les verrous : FETCH_AND_ADD et
+ *   COMPARE_AND_SWAP sont exécutés par la carte (rdma_atomic.h)
+ * → Avec -K : la RAM exposée devient une table clé-valeur ; les
+ *   GET sont des RDMA_READ (aucun CPU serveur), seuls les PUT
+ *   passent par un thread client (rdma_kv.h)
+ * → Messages sans RECV à remplir : un client qui le demande a un
+ *   anneau chez le serveur, et le serveur un chez lui ; on s'écrit
+ *   par RDMA_WRITE_WITH_IMM (rdma_ring.h), le serveur fait l'écho
  * 
  * C'est EXACTEMENT ce que fait InfiniSwap pour page-out/page-in
+ * → La RAM exposée = un tableau de pages de 4 KB (RDMA_PAGE_SIZE)
+ * → Page i à l'offset i * 4096 : le client calcule l'adresse seul
+ * 
+ * MULTI-CLIENTS (nœud mémoire) :
+ * → Une boucle d'événements CM accepte autant de clients que voulu
+ * → Chaque connexion a son contexte : QP, CQ, thread
+ * → Adresse + RKEY partent DANS l'accept (private_data) : pas de
+ *   SEND d'infos, ni de buffer enregistré par client
+ * → Les CQ des clients partis sont gardées pour les suivants
+ *   (ibv_create_cq coûte cher quand des centaines de clients
+ *   redémarrent ensemble)
+ * → La RAM exposée (PD + MR) est partagée par tous les clients
+ * → Les RECV aussi : un Shared Receive Queue (SRQ) par carte,
+ *   re-rempli sous un seuil bas → mémoire constante
+ * → Un client qui part (DISCONNECTED) ne gêne pas les autres : la
+ *   boucle CM est non bloquante (epoll, voir rdma_cmloop.h), et sa
+ *   QP n'est détruite qu'à la sortie du timewait (TIMEWAIT_EXIT)
+ * → Ctrl+C pour arrêter proprement le serveur
  * 
  * Compilation :
- *   gcc -Wall -g -o rdma_server rdma_server.c -lrdmacm -libverbs -lpthread
+ *   gcc -Wall -g -o rdma_server rdma_server.c rdma_batch.c rdma_cq.c rdma_mem.c \
+ *       rdma_numa.c rdma_cmloop.c rdma_kv.c rdma_ring.c \
+ *       -lrdmacm -libverbs -lpthread
  * 
  * Utilisation :
- *   ./rdma_server
+ *   ./rdma_server [-b taille] [-H 4k|2m|1g] [-O pin|odp|implicit]
+ *                 [-W poll|event|hybrid] [-u μs] [-X] [-K buckets]
+ *   -b : taille de la RAM exposée (défaut 1M, suffixes K/M/G acceptés)
+ *   -H : pages de la RAM exposée (défaut 4k ; 2m / 1g = huge pages,
+ *        moins d'entrées MTT dans la carte, voir rdma_mem.h)
+ *   -O : enregistrement de la RAM exposée (défaut pin : tout épinglé,
+ *        mlockall) ; odp / implicit = On-Demand Paging, rien n'est
+ *        épinglé ni fauté d'avance (voir "ON-DEMAND PAGING")
+ *   -W : attente des complétions par les threads clients
+ *        (défaut hybrid : spin -u μs puis dort, voir rdma_cq.h)
+ *   -u : budget de spin du mode hybrid (défaut 50 μs)
+ *   -X : placer RAM, CQ et threads sur un AUTRE nœud NUMA que celui
+ *        de la carte (pour mesurer la pénalité, voir rdma_numa.h)
+ *   -K : formater la RAM exposée en table clé-valeur de <buckets>
+ *        buckets de 4 slots (suffixes K/M acceptés) ; le reste de
+ *        la RAM sert aux valeurs (voir rdma_kv.h)
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
-#include <sys/mman.h>
+#include <errno.h>
+#include <signal.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <time.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
 #include <rdma/rdma_cma.h>
 
-#define BUFFER_SIZE 1024*1024  // 1 MB de RAM à exposer
+#include "rdma_common.h"
+#include "rdma_batch.h"
+#include "rdma_cq.h"
+#include "rdma_mem.h"
+#include "rdma_numa.h"
+#include "rdma_cmloop.h"
+#include "rdma_kv.h"
+#include "rdma_ring.h"
+
+#define LISTEN_BACKLOG 1024 // Connexions en attente d'accept
+#define MAX_DEVICES    8    // Cartes InfiniBand gérées
+#define SRV_SIGNAL_EVERY 8  // Réponses PING : 1 signalée sur 8
+// Réponses en attente par connexion : une par requête en vol, plus
+// celles pas encore couvertes par un envoi signalé
+#define SRV_SEND_DEPTH  (ECHO_WINDOW_MAX + 2 * SRV_SIGNAL_EVERY)
+_Static_assert(RING_DEFAULT_SLOTS <= ECHO_WINDOW_MAX,
+               "anneau du client : refusé par le serveur");
+#define SRV_CQ_SPARE   64   // CQ de clients partis gardées, par carte
+#define SRV_TICK_MS    100  // Réveil de la boucle CM (Ctrl+C, timewait)
+#define SRV_TIMEWAIT_MS 5000 // Pas de TIMEWAIT_EXIT (iWARP) : on libère
+
+// ═══════════════════════════════════════════════════════
+// RESSOURCES PAR CARTE (partagées par tous les clients)
+// ═══════════════════════════════════════════════════════
+// Un PD et une MR ne valent que pour UNE carte (ibv_context).
+// → Créés à la première connexion arrivant sur cette carte
+// → Réutilisés par toutes les connexions suivantes
+// → Les CQ aussi, une fois leur client parti (cq_spare) : vidées,
+//   elles ne gardent rien de lui, et une CQ de SRV_SRQ_DEPTH
+//   entrées coûte une allocation + un enregistrement à la carte
+
+struct srv_device {
+    struct ibv_context *verbs;
+    int node;                   // Nœud NUMA utilisé (-1 = inconnu)
+    struct ibv_pd *pd;
+    struct ibv_mr *mr;          // La RAM exposée
+    int reg;                    // enum reg_mode retenu pour mr (odp_check)
+    int atomic;                 // REMOTE_ATOMIC accordé sur mr
+    struct ibv_mr *sink_mr;     // Le "puits" des RECV
+    struct ibv_srq *srq;        // Les RECV de TOUS les clients
+    uint64_t srq_consumed;      // RECV récoltés, pas encore re-postés
+    long srq_refills;
+    pthread_t async_thread;     // Événements asynchrones de la carte
+    int async_started;
+    struct cq_waiter cq_spare[SRV_CQ_SPARE];  // Pile de CQ vides
+    int num_spare;
+    long cq_created, cq_reused;
+};
+
+// ═══════════════════════════════════════════════════════
+// CONTEXTE PAR CONNEXION
+// ═══════════════════════════════════════════════════════
+// Tout ce qui appartient à UN client :
+// → Son QP et sa CQ (ses RECV sont dans le SRQ de la carte)
+// → Le thread qui sert ses commandes
+
+struct conn_ctx {
+    int num;                        // Numéro (pour les logs)
+    struct rdma_cm_id *id;
+    struct srv_device *dev;
+    struct cq_waiter cqw;           // CQ + attente (spin / sommeil)
+    
+    pthread_t thread;
+    int thread_started;
+    int stop;                       // Demandé par la boucle CM
+    long pings;                     // PING servis
+    long kv_puts;                   // PUT servis (table clé-valeur)
+    uint32_t mbox;                  // Boîte aux lettres PUT (KV_NO_MBOX)
+    struct ring ring;               // Anneau de messages (si demandé)
+    char *ring_mem;                 // Notre anneau (NULL : pas d'anneau)
+    struct ibv_mr *ring_mr;
+    long ring_msgs;                 // Messages de l'anneau (écho)
+    long replies_posted;            // Réponses postées (signal 1 sur N)
+    uint32_t max_inline;            // max_inline_data de la QP
+    int recvs;                      // RECV récoltés dans le paquet courant
+    long sink_msgs;                 // SEND de données reçus (puits)
+    uint64_t sink_bytes;
+    long down_ms;                   // Heure du DISCONNECTED (timewait)
+    
+    struct conn_ctx *next;
+};
+
+// La RAM exposée : taille (-b) et type de pages (-H) choisis au
+// lancement, mmap (voir rdma_mem.h)
+static struct mem_region region;
+static enum mem_pages region_pages = MEM_PAGES_4K;
+static char *buffer;
+static size_t buffer_size = BUFFER_SIZE;
 
-// Structure pour transmettre les infos RDMA au client
-struct rdma_buffer_info {
-    uint64_t addr;      // Adresse virtuelle de la RAM
-    uint32_t rkey;      // Clé d'accès RDMA (Remote Key)
+// Table clé-valeur (-K) : formatée dans la RAM exposée, une boîte
+// aux lettres PUT par connexion (bit à 1 = prise ; la boucle CM est
+// la seule à y toucher)
+static uint64_t kv_buckets;
+static struct kv_store kv;
+static uint64_t kv_mbox_used;
+_Static_assert(KV_MBOXES <= 64, "kv_mbox_used : un bit par boîte");
+
+// ═══════════════════════════════════════════════════════
+// ON-DEMAND PAGING (ODP)
+// ═══════════════════════════════════════════════════════
+// ibv_reg_mr classique ÉPINGLE toute la région : 1 MB, aucun souci ;
+// la RAM entière d'un nœud mémoire, impossible (et mlockall aussi).
+//
+// Avec IBV_ACCESS_ON_DEMAND :
+// → Rien n'est épinglé : la carte traduit via le noyau, page par page
+// → Page absente au moment d'un READ / WRITE client : la carte fait
+//   une FAUTE, le noyau amène la page, l'accès reprend (des dizaines
+//   de μs au premier accès, puis comme une région épinglée)
+// → Le noyau peut reprendre une page : la carte est invalidée
+//
+// ODP IMPLICITE : UNE MR pour tout l'espace d'adressage
+// (ibv_reg_mr(pd, NULL, SIZE_MAX)) : plus jamais d'enregistrement.
+// ⚠️ La RKEY donne alors accès à TOUTE la mémoire du serveur.
+//
+// Carte sans ODP (ou sans implicite) : repli annoncé, jamais muet.
+
+enum reg_mode {
+    REG_PIN,                    // ibv_reg_mr classique + mlockall
+    REG_ODP,                    // IBV_ACCESS_ON_DEMAND sur la région
+    REG_IMPLICIT,               // ODP implicite : tout l'espace d'adressage
 };
 
-int main() {
+static enum reg_mode reg_mode = REG_PIN;
+static int numa_cross;          // -X : nœud NUMA distant, exprès
+static long resident_last;      // Pages résidentes au dernier rapport
+
+static const char *reg_mode_name(int mode) {
+    switch (mode) {
+    case REG_PIN:      return "pin";
+    case REG_ODP:      return "odp";
+    case REG_IMPLICIT: return "implicit";
+    }
+    return "?";
+}
+
+// ═══════════════════════════════════════════════════════
+// LE PUITS : OÙ ATTERRISSENT TOUS LES RECV
+// ═══════════════════════════════════════════════════════
+// Les commandes font 0 octet (immediate data) : elles n'écrivent
+// rien. Seuls les SEND de données du benchmark écrivent ici.
+// → TOUS les RECV (du SRQ de chaque carte) pointent sur ce buffer
+// → Son contenu n'a aucune importance : on compte et on jette
+// → La RAM exposée n'est jamais écrasée par un SEND
+// → Taille = min(RAM exposée, MAX_SEND_SIZE) : annoncée au client
+static char *sink;
+static size_t sink_size;
+
+static struct srv_device devices[MAX_DEVICES];
+static int num_devices;
+
+static struct conn_ctx *conns;      // Connexions vivantes
+static struct conn_ctx *timewait;   // Parties, QP encore en timewait
+static int next_conn_num = 1;
+static int active_conns;
+
+static volatile sig_atomic_t stop_server;
+
+// Attente des complétions (-W / -u), pour toutes les connexions
+static enum cq_mode cq_mode = CQ_MODE_HYBRID;
+static int spin_us = CQ_SPIN_DEFAULT_US;
+
+static void on_sigint(int sig) {
+    (void)sig;
+    stop_server = 1;
+}
+
+// ═══════════════════════════════════════════════════════
+// SHARED RECEIVE QUEUE (UN PAR CARTE)
+// ═══════════════════════════════════════════════════════
+// POURQUOI ?
+// → Avant : 1024 RECV PAR client, postés à la connexion
+//   → la mémoire des files de réception grossit avec le nombre
+//     de clients, alors qu'ils sont rarement tous actifs
+// → SRQ : toutes les QP de la carte piochent dans la MÊME file
+//   → SRV_SRQ_DEPTH RECV au total, quel que soit le nombre de clients
+//
+// QUI RE-REMPLIT ?
+// → Les threads clients comptent les RECV récoltés (srq_consumed)
+// → Quand il reste moins de SRV_SRQ_LIMIT RECV dans le SRQ, la
+//   carte lève IBV_EVENT_SRQ_LIMIT_REACHED (une seule fois)
+// → Le thread async_worker re-poste ce qui a été récolté, puis
+//   ré-arme le seuil
+// → Filet de sécurité : si l'événement se perd (seuil ré-armé
+//   alors qu'on est déjà dessous), le même thread re-remplit au
+//   bout de 100 ms
+//
+// Seuls les RECV RÉCOLTÉS sont re-postés : RECV postés + CQE pas
+// encore lus <= SRV_SRQ_DEPTH. C'est ce qui borne la taille des CQ.
+
+// Un RECV = tout le puits : il accepte une commande (0 octet)
+// comme un SEND de données de n'importe quelle taille.
+// Postés par chaînes de WR_BATCH_MAX (un doorbell par chaîne).
+static int srq_refill(struct srv_device *dev, uint64_t count) {
+    struct recv_batch rb;
+    int ret = 0;
+    
+    recv_batch_init_srq(&rb, dev->srq, WR_BATCH_MAX);
+    for (uint64_t i = 0; i < count && !ret; i++)
+        ret = recv_batch_add(&rb, 100, sink, sink_size, dev->sink_mr->lkey);
+    if (!ret)
+        ret = recv_batch_flush(&rb);
+    return ret;
+}
+
+static int srq_arm(struct srv_device *dev) {
+    struct ibv_srq_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.srq_limit = SRV_SRQ_LIMIT;
+    return ibv_modify_srq(dev->srq, &attr, IBV_SRQ_LIMIT);
+}
+
+// Re-poste tout ce que les threads clients ont récolté
+static int srq_top_up(struct srv_device *dev) {
+    uint64_t n = __atomic_exchange_n(&dev->srq_consumed, 0, __ATOMIC_ACQ_REL);
+    if (n == 0)
+        return 0;
+    
+    int ret = srq_refill(dev, n);
+    if (ret) {
+        printf("   ❌ ibv_post_srq_recv : %s\n", strerror(ret));
+        return ret;
+    }
+    dev->srq_refills++;
+    return 0;
+}
+
+static void *async_worker(void *arg) {
+    struct srv_device *dev = arg;
+    struct pollfd pfd = { .fd = dev->verbs->async_fd, .events = POLLIN };
+    
+    if (dev->node >= 0)
+        numa_pin_node(dev->node);
+    
+    while (!stop_server) {
+        if (poll(&pfd, 1, 100) <= 0) {
+            // Filet de sécurité : le seuil est franchi sans événement
+            if (__atomic_load_n(&dev->srq_consumed, __ATOMIC_ACQUIRE) >
+                SRV_SRQ_DEPTH - SRV_SRQ_LIMIT)
+                srq_top_up(dev);
+            continue;
+        }
+        
+        struct ibv_async_event ev;
+        if (ibv_get_async_event(dev->verbs, &ev))
+            continue;   // EAGAIN : fd non bloquant
+        
+        enum ibv_event_type type = ev.event_type;
+        ibv_ack_async_event(&ev);
+        
+        switch (type) {
+        case IBV_EVENT_SRQ_LIMIT_REACHED:
+            if (srq_top_up(dev) == 0)
+                srq_arm(dev);
+            break;
+        case IBV_EVENT_QP_LAST_WQE_REACHED:
+            break;      // QP d'un client parti : normal
+        default:
+            printf("   ⚠️  Événement carte : %s\n", ibv_event_type_str(type));
+            break;
+        }
+    }
+    return NULL;
+}
+
+static int srq_setup(struct srv_device *dev) {
+    struct ibv_srq_init_attr srq_attr;
+    memset(&srq_attr, 0, sizeof(srq_attr));
+    srq_attr.attr.max_wr = SRV_SRQ_DEPTH;
+    srq_attr.attr.max_sge = 1;
+    
+    dev->srq = ibv_create_srq(dev->pd, &srq_attr);
+    if (!dev->srq) {
+        perror("   ❌ ibv_create_srq");
+        return -1;
+    }
+    
+    int ret = srq_refill(dev, SRV_SRQ_DEPTH);
+    if (ret) {
+        printf("   ❌ ibv_post_srq_recv : %s\n", strerror(ret));
+        return -1;
+    }
+    if (srq_arm(dev)) {
+        perror("   ❌ ibv_modify_srq (seuil)");
+        return -1;
+    }
+    
+    // fd non bloquant : le thread vérifie stop_server toutes les 100 ms
+    int flags = fcntl(dev->verbs->async_fd, F_GETFL);
+    fcntl(dev->verbs->async_fd, F_SETFL, flags | O_NONBLOCK);
+    
+    ret = pthread_create(&dev->async_thread, NULL, async_worker, dev);
+    if (ret) {
+        printf("   ❌ pthread_create (événements) : %s\n", strerror(ret));
+        return -1;
+    }
+    dev->async_started = 1;
+    
+    printf("   📥 SRQ : %d RECV partagés, re-remplis sous %d\n\n",
+           SRV_SRQ_DEPTH, SRV_SRQ_LIMIT);
+    return 0;
+}
+
+// ═══════════════════════════════════════════════════════
+// ÉTAPES 7-8 : PD + MEMORY REGISTRATION (UNE FOIS PAR CARTE)
+// ═══════════════════════════════════════════════════════
+// PROTECTION DOMAIN :
+// → Une zone de sécurité pour tes ressources RDMA
+// → Toutes tes ressources (QP, MR) doivent être dans le même PD
+//
+// ✨ MEMORY REGISTRATION - C'EST L'ÉTAPE MAGIQUE ! ✨
+// 1. Tu dis à la carte InfiniBand : "Cette zone RAM est à toi"
+// 2. La carte "pin" cette RAM en mémoire physique
+//    (l'OS ne peut plus la déplacer ou la swapper)
+// 3. La carte te donne une RKEY (Remote Key = clé d'accès)
+// 4. Avec cette RKEY, les clients pourront accéder à cette RAM
+//
+// DROITS D'ACCÈS :
+// - IBV_ACCESS_LOCAL_WRITE  : le serveur peut écrire localement
+// - IBV_ACCESS_REMOTE_READ  : le client peut lire à distance
+// - IBV_ACCESS_REMOTE_WRITE : le client peut écrire à distance
+// - IBV_ACCESS_REMOTE_ATOMIC : le client peut faire FETCH_AND_ADD /
+//   COMPARE_AND_SWAP sur des mots de 8 octets (rdma_atomic.h), si
+//   la carte sait faire (et en ODP, si elle sait les fauter aussi)
+
+// Ce que la carte accepte vraiment : ODP pour RC en READ + WRITE
+// (le client lit ET écrit), implicite en plus si demandé
+static enum reg_mode odp_check(struct ibv_context *verbs, enum reg_mode want) {
+    const uint32_t rc_need = IBV_ODP_SUPPORT_READ | IBV_ODP_SUPPORT_WRITE;
+    struct ibv_device_attr_ex attr;
+    
+    if (want == REG_PIN)
+        return REG_PIN;
+    
+    memset(&attr, 0, sizeof(attr));
+    if (ibv_query_device_ex(verbs, NULL, &attr) ||
+        !(attr.odp_caps.general_caps & IBV_ODP_SUPPORT) ||
+        (attr.odp_caps.per_transport_caps.rc_odp_caps & rc_need) != rc_need) {
+        printf("   ⚠️  Pas d'ODP (RC READ/WRITE) sur cette carte : région épinglée\n");
+        return REG_PIN;
+    }
+    if (want == REG_IMPLICIT &&
+        !(attr.odp_caps.general_caps & IBV_ODP_SUPPORT_IMPLICIT)) {
+        printf("   ⚠️  Pas d'ODP implicite sur cette carte : ODP sur la région\n");
+        return REG_ODP;
+    }
+    return want;
+}
+
+// Atomiques distants possibles sur la région (reg = mode retenu) ?
+// Refus annoncé : le client le voit dans les infos (INFO_ATOMIC)
+static int atomic_check(struct ibv_context *verbs, enum reg_mode reg) {
+    struct ibv_device_attr_ex attr;
+    
+    memset(&attr, 0, sizeof(attr));
+    if (ibv_query_device_ex(verbs, NULL, &attr) ||
+        attr.orig_attr.atomic_cap == IBV_ATOMIC_NONE) {
+        printf("   ⚠️  Pas d'atomiques sur cette carte : RKEY sans REMOTE_ATOMIC\n");
+        return 0;
+    }
+    if (reg != REG_PIN &&
+        !(attr.odp_caps.per_transport_caps.rc_odp_caps & IBV_ODP_SUPPORT_ATOMIC)) {
+        printf("   ⚠️  Pas d'atomiques en ODP sur cette carte : RKEY sans REMOTE_ATOMIC\n");
+        return 0;
+    }
+    return 1;
+}
+
+// Pages de la RAM exposée déjà fautées (par le CPU OU par la carte),
+// et fautes du CPU du serveur lui-même (celles de la carte sont
+// servies par le noyau hors du processus : seul mincore les voit).
+// dev : le mode que sa MR a vraiment (NULL : avant toute carte, le
+// mode demandé)
+static void odp_report(const struct srv_device *dev) {
+    if ((dev ? dev->reg : reg_mode) == REG_PIN)
+        return;
+    
+    long resident = mem_region_resident(&region);
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    printf("   📄 ODP : %ld / %zu pages résidentes (+%ld), fautes CPU :"
+           " %ld mineures, %ld majeures\n", resident,
+           region.size / 4096, resident - resident_last,
+           ru.ru_minflt, ru.ru_majflt);
+    resident_last = resident;
+}
+
+static struct srv_device *device_get(struct ibv_context *verbs) {
+    for (int i = 0; i < num_devices; i++) {
+        if (devices[i].verbs == verbs)
+            return &devices[i];
+    }
+    
+    if (num_devices == MAX_DEVICES) {
+        printf("   ❌ Trop de cartes InfiniBand (max %d)\n", MAX_DEVICES);
+        return NULL;
+    }
+    
+    printf("✨ ÉTAPES 7-8 : PD + Memory Registration sur %s\n",
+           ibv_get_device_name(verbs->device));
+    
+    // PLACEMENT NUMA : la carte est enfin connue
+    // → RAM exposée + puits déplacés sur son nœud AVANT ibv_reg_mr
+    //   (une fois épinglées, les pages ne bougent plus) : seulement
+    //   pour la 1re carte, les suivantes trouvent la RAM déjà là
+    // → CQ, QP : alloués ensuite par ce thread, de préférence
+    //   sur ce nœud (voir on_connect_request pour les autres cartes)
+    int dev_node = numa_dev_node(verbs->device);
+    int node = numa_pick_node(dev_node, numa_cross);
+    if (node < 0) {
+        printf("   🧭 Nœud NUMA de la carte inconnu : pas de placement\n");
+    } else {
+        if (num_devices == 0 &&
+            (numa_move(buffer, buffer_size, node) ||
+             numa_move(sink, sink_size, node)))
+            perror("   ⚠️  mbind (RAM exposée)");
+        numa_prefer(node);
+        printf("   🧭 Carte sur le nœud %d → RAM, CQ et threads sur le nœud %d%s"
+               " (RAM exposée : nœud %d)\n", dev_node, node,
+               node != dev_node ? " (DISTANT, -X)" : "",
+               numa_node_of_addr(buffer));
+        if (numa_cross && node == dev_node)
+            printf("   ⚠️  -X : un seul nœud NUMA, rien à croiser\n");
+    }
+    
+    struct ibv_pd *pd = ibv_alloc_pd(verbs);
+    if (!pd) {
+        perror("   ❌ ibv_alloc_pd");
+        return NULL;
+    }
+    
+    enum reg_mode reg = odp_check(verbs, reg_mode);
+    int atomic = atomic_check(verbs, reg);
+    int access = IBV_ACCESS_LOCAL_WRITE |   // Serveur peut écrire
+                 IBV_ACCESS_REMOTE_READ |   // Client peut lire
+                 IBV_ACCESS_REMOTE_WRITE;   // Client peut écrire
+    if (atomic)
+        access |= IBV_ACCESS_REMOTE_ATOMIC; // Client peut FAA / CAS
+    if (reg != REG_PIN)
+        access |= IBV_ACCESS_ON_DEMAND;
+    
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    
+    struct ibv_mr *mr = ibv_reg_mr(
+        pd,                                         // Protection Domain
+        reg == REG_IMPLICIT ? NULL : buffer,        // Adresse de la RAM
+        reg == REG_IMPLICIT ? SIZE_MAX : buffer_size,  // Taille (-b)
+        access
+    );
+    if (!mr) {
+        perror("   ❌ ibv_reg_mr");
+        ibv_dealloc_pd(pd);
+        return NULL;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    
+    struct ibv_mr *sink_mr = ibv_reg_mr(pd, sink, sink_size,
+                                        IBV_ACCESS_LOCAL_WRITE);
+    if (!sink_mr) {
+        perror("   ❌ ibv_reg_mr (puits)");
+        ibv_dereg_mr(mr);
+        ibv_dealloc_pd(pd);
+        return NULL;
+    }
+    
+    printf("   ✅ MAGIE ACCOMPLIE ! ✨\n");
+    printf("   📊 Infos de la RAM enregistrée :\n");
+    printf("      • Adresse virtuelle : %p\n", buffer);
+    printf("      • RKEY (clé accès)  : 0x%x\n", mr->rkey);
+    printf("      • LKEY (clé locale) : 0x%x\n", mr->lkey);
+    printf("      • Enregistrement    : %.2f ms (%zu pages de %s, %s)\n",
+           ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / 1e6,
+           region.size / region.page_size, mem_pages_name(region_pages),
+           reg_mode_name(reg));
+    printf("      • Atomiques (FAA/CAS) : %s\n\n", atomic ? "oui" : "non");
+    
+    struct srv_device *dev = &devices[num_devices];
+    memset(dev, 0, sizeof(*dev));
+    dev->verbs = verbs;
+    dev->node = node;
+    dev->pd = pd;
+    dev->mr = mr;
+    dev->reg = reg;
+    dev->atomic = atomic;
+    dev->sink_mr = sink_mr;
+    
+    if (srq_setup(dev)) {
+        if (dev->srq)
+            ibv_destroy_srq(dev->srq);
+        ibv_dereg_mr(sink_mr);
+        ibv_dereg_mr(mr);
+        ibv_dealloc_pd(pd);
+        return NULL;
+    }
+    
+    num_devices++;
+    return dev;
+}
+
+// ═══════════════════════════════════════════════════════
+// LIBÉRER UNE CONNEXION
+// ═══════════════════════════════════════════════════════
+// ORDRE CRITIQUE POUR RDMA :
+// 1. Arrêter le thread (plus personne ne poll la CQ) ; déjà
+//    prévenu au DISCONNECTED, il est sorti depuis
+// 2. Destroy QP
+// 3. Drain CQ, puis la garder pour le prochain client (ou Destroy
+//    si la réserve de la carte est pleine)
+// 4. Destroy CM ID (les événements doivent déjà être ACK)
+// → PD et RAM exposée restent : d'autres clients les utilisent
+
+// CQ pour un nouveau client : une de la réserve, sinon une neuve
+// (toujours créées avec la même taille et le même mode -W)
+static int cq_take(struct srv_device *dev, struct cq_waiter *w,
+                   struct ibv_context *verbs) {
+    if (dev->num_spare > 0) {
+        *w = dev->cq_spare[--dev->num_spare];
+        dev->cq_reused++;
+        return 0;
+    }
+    if (cq_waiter_init(w, verbs, SRV_SRQ_DEPTH + SRV_SEND_DEPTH,
+                       cq_mode, spin_us))
+        return -1;
+    dev->cq_created++;
+    return 0;
+}
+
+// CQ vidée (plus aucune QP dessus) : en réserve ou détruite. Les
+// compteurs de sommeil repartent de zéro pour le client suivant.
+static void cq_give_back(struct srv_device *dev, struct cq_waiter *w) {
+    struct ibv_wc wc_drain;
+    while (ibv_poll_cq(w->cq, 1, &wc_drain) > 0);
+    
+    if (dev->num_spare == SRV_CQ_SPARE) {
+        cq_waiter_destroy(w);
+        return;
+    }
+    w->sleeps = 0;
+    dev->cq_spare[dev->num_spare++] = *w;
+}
+
+static void conn_destroy(struct conn_ctx *c) {
+    if (c->thread_started) {
+        __atomic_store_n(&c->stop, 1, __ATOMIC_RELEASE);
+        pthread_join(c->thread, NULL);
+    }
+    
+    if (c->id->qp)
+        rdma_destroy_qp(c->id);
+    
+    if (c->ring_mr)
+        ibv_dereg_mr(c->ring_mr);
+    free(c->ring_mem);
+    
+    if (c->cqw.cq)
+        cq_give_back(c->dev, &c->cqw);
+    
+    // Plus de QP : plus rien ne peut arriver dans sa boîte
+    if (c->mbox != KV_NO_MBOX)
+        kv_mbox_used &= ~(1ULL << c->mbox);
+    
+    rdma_destroy_id(c->id);
+    free(c);
+}
+
+static void conn_unlink(struct conn_ctx *c) {
+    for (struct conn_ctx **pp = &conns; *pp; pp = &(*pp)->next) {
+        if (*pp == c) {
+            *pp = c->next;
+            active_conns--;
+            return;
+        }
+    }
+}
+
+// ═══════════════════════════════════════════════════════
+// TIMEWAIT : LA QP D'UN CLIENT PARTI ATTEND UN PEU
+// ═══════════════════════════════════════════════════════
+// Des paquets de l'ancienne connexion peuvent encore traîner sur le
+// réseau : la QP ne doit pas être détruite (et son numéro réutilisé)
+// avant que le CM le dise (TIMEWAIT_EXIT).
+// → DISCONNECTED : on prévient le thread (sans l'attendre : la
+//   boucle CM ne bloque jamais sur un client), rdma_disconnect
+//   répond au pair et démarre le timewait
+// → TIMEWAIT_EXIT : conn_destroy
+// → Rien après SRV_TIMEWAIT_MS (iWARP n'en envoie pas) : pareil
+
+static long now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000;
+}
+
+static void conn_retire(struct conn_ctx *c) {
+    __atomic_store_n(&c->stop, 1, __ATOMIC_RELEASE);
+    rdma_disconnect(c->id);
+    c->down_ms = now_ms();
+    c->next = timewait;
+    timewait = c;
+}
+
+// force : tout libérer sans attendre (arrêt du serveur)
+static void timewait_reap(struct conn_ctx *only, int force) {
+    long now = now_ms();
+    struct conn_ctx **pp = &timewait;
+    
+    while (*pp) {
+        struct conn_ctx *c = *pp;
+        if (force || c == only || now - c->down_ms > SRV_TIMEWAIT_MS) {
+            *pp = c->next;
+            conn_destroy(c);
+        } else {
+            pp = &c->next;
+        }
+    }
+}
+
+// ═══════════════════════════════════════════════════════
+// TRAITER UNE COMPLÉTION
+// ═══════════════════════════════════════════════════════
+// Retourne 1 si la session est finie (QUIT, erreur, flush).
+//
+// Les réponses aux PING ne sont signalées qu'une fois sur
+// SRV_SIGNAL_EVERY : le CQE d'un SEND signalé libère aussi les
+// slots de tous les SEND non signalés postés avant lui (RC = dans
+// l'ordre). SRV_SIGNAL_EVERY < SRV_SEND_DEPTH : la Send Queue ne
+// peut pas se remplir de SEND dont on n'aura jamais de nouvelles.
+
+static int serve_wc(struct conn_ctx *c, struct ibv_wc *wc) {
+    int ret;
+    
+    if (wc->status != IBV_WC_SUCCESS) {
+        // Flush = le client est parti, DISCONNECTED va suivre
+        if (wc->status != IBV_WC_WR_FLUSH_ERR)
+            printf("   ❌ [client %d] Complétion échouée (status: %s)\n",
+                   c->num, ibv_wc_status_str(wc->status));
+        return 1;
+    }
+    
+    // Complétion d'un SEND (données ou réponse) : rien à faire
+    // (un RDMA_WRITE_WITH_IMM du client consomme un RECV aussi)
+    if (wc->opcode != IBV_WC_RECV && wc->opcode != IBV_WC_RECV_RDMA_WITH_IMM)
+        return 0;
+    
+    // Un RECV du SRQ en moins : compté, re-posté par async_worker
+    c->recvs++;
+    
+    // Pas d'immediate = données du benchmark SEND
+    if (!(wc->wc_flags & IBV_WC_WITH_IMM)) {
+        c->sink_msgs++;
+        c->sink_bytes += wc->byte_len;
+        return 0;
+    }
+    
+    uint32_t imm = ntohl(wc->imm_data);
+    int cmd = CMD_IMM_CMD(imm);
+    uint32_t arg = CMD_IMM_ARG(imm);
+    
+    if (cmd == CMD_QUIT)
+        return 1;
+    
+    if (cmd == CMD_PING) {
+        uint32_t len = arg ? arg : DATA_SIZE;
+        if (len > sink_size)
+            len = sink_size;
+        
+        struct ibv_sge sge_data;
+        sge_data.addr = (uint64_t)buffer;
+        sge_data.length = len;
+        sge_data.lkey = c->dev->mr->lkey;
+        
+        struct ibv_send_wr send_wr_data, *bad_wr_data;
+        memset(&send_wr_data, 0, sizeof(send_wr_data));
+        send_wr_data.wr_id = 2;
+        send_wr_data.sg_list = &sge_data;
+        send_wr_data.num_sge = 1;
+        send_wr_data.opcode = IBV_WR_SEND;
+        if (len <= c->max_inline)
+            send_wr_data.send_flags = IBV_SEND_INLINE;
+        if (++c->replies_posted % SRV_SIGNAL_EVERY == 0)
+            send_wr_data.send_flags |= IBV_SEND_SIGNALED;
+        
+        ret = ibv_post_send(c->id->qp, &send_wr_data, &bad_wr_data);
+        if (ret) {
+            printf("   ❌ [client %d] ibv_post_send (données) : %s\n",
+                   c->num, strerror(ret));
+            return 1;
+        }
+        c->pings++;
+    } else if (cmd == CMD_KV_PUT && wc->opcode == IBV_WC_RECV_RDMA_WITH_IMM) {
+        // La requête est déjà dans SA boîte (écrite avant le RECV,
+        // RC = dans l'ordre) ; réponse = statut dans l'immediate
+        int status = kv_buckets ? kv_apply_put(&kv, c->mbox, arg)
+                                : KV_BAD_REQUEST;
+        
+        struct ibv_send_wr reply_wr, *bad_reply_wr;
+        memset(&reply_wr, 0, sizeof(reply_wr));
+        reply_wr.wr_id = 3;
+        reply_wr.num_sge = 0;
+        reply_wr.opcode = IBV_WR_SEND_WITH_IMM;
+        reply_wr.imm_data = htonl(CMD_IMM(CMD_KV_PUT, status));
+        if (++c->replies_posted % SRV_SIGNAL_EVERY == 0)
+            reply_wr.send_flags = IBV_SEND_SIGNALED;
+        
+        ret = ibv_post_send(c->id->qp, &reply_wr, &bad_reply_wr);
+        if (ret) {
+            printf("   ❌ [client %d] ibv_post_send (réponse PUT) : %s\n",
+                   c->num, strerror(ret));
+            return 1;
+        }
+        c->kv_puts++;
+    } else if (cmd == CMD_RING_MSG && c->ring_mem &&
+               wc->opcode == IBV_WC_RECV_RDMA_WITH_IMM) {
+        // Écho sur place : le message repart du slot où il est
+        // arrivé (même MR). Le slot n'est rendu qu'APRÈS le post : un
+        // crédit posté seul avant (petit anneau) laisserait le client
+        // y écrire avant que la carte n'ait lu l'écho
+        uint32_t len;
+        char *msg = ring_recv(&c->ring, arg, &len);
+        if (!msg)
+            return 1;
+        ret = ring_post(&c->ring, msg, len, c->ring_mr->lkey);
+        if (ret) {
+            if (ret > 0)
+                printf("   ❌ [client %d] Anneau du client plein (crédits"
+                       " non rendus)\n", c->num);
+            return 1;
+        }
+        if (ring_release(&c->ring))
+            return 1;
+        c->ring_msgs++;
+    } else if (cmd == CMD_RING_CREDIT && c->ring_mem) {
+        ring_credit_in(&c->ring, arg);
+    } else {
+        printf("   ⚠️  [client %d] Commande inconnue : %d (ignorée)\n",
+               c->num, cmd);
+    }
+    return 0;
+}
+
+// ═══════════════════════════════════════════════════════
+// THREAD PAR CONNEXION : ÉTAPE 13
+// ═══════════════════════════════════════════════════════
+// (ÉTAPE 12, adresse + RKEY, est partie avec l'accept)
+// ÉTAPE 13 : servir ses commandes jusqu'à CMD_QUIT
+// → CMD_PING : on renvoie <arg> octets par SEND (two-sided)
+// → CMD_KV_PUT : on applique le PUT déposé dans sa boîte
+// → CMD_RING_MSG : message dans notre anneau, renvoyé dans le sien
+// → SEND sans immediate : données du benchmark, on les compte
+// → Pendant ce temps, les RDMA_READ / RDMA_WRITE du client
+//   passent par la carte SANS JAMAIS apparaître dans cette boucle
+//
+// Chaque client a SA CQ et SON thread : un client lent ou
+// bavard ne ralentit pas les autres.
+
+static void *conn_worker(void *arg) {
+    struct conn_ctx *c = arg;
+    
+    // Boucle de polling sur les cœurs du nœud de la carte (le
+    // noyau choisit lequel : plusieurs clients s'y répartissent)
+    if (c->dev->node >= 0)
+        numa_pin_node(c->dev->node);
+    
+    // ÉTAPE 13 : SERVIR LES COMMANDES
+    // Les RECV viennent du SRQ de la carte : on ne re-poste rien
+    // ici, on compte (UNE opération atomique par paquet).
+    // → Jusqu'à POLL_BATCH complétions par appel : en benchmark
+    //   SEND, le puits reçoit plusieurs millions de messages/s
+    struct ibv_wc wcs[POLL_BATCH];
+    
+    while (!__atomic_load_n(&c->stop, __ATOMIC_ACQUIRE)) {
+        // Réveil au moins toutes les 100 ms pour voir c->stop
+        int n = cq_wait(&c->cqw, wcs, POLL_BATCH, 100);
+        if (n < 0)
+            break;
+        
+        int done = 0;
+        for (int i = 0; i < n && !done; i++)
+            done = serve_wc(c, &wcs[i]);
+        
+        if (c->recvs) {
+            __atomic_add_fetch(&c->dev->srq_consumed, c->recvs, __ATOMIC_RELEASE);
+            c->recvs = 0;
+        }
+        if (done)
+            break;
+    }
+    
+    return NULL;
+}
+
+// ═══════════════════════════════════════════════════════
+// ÉVÉNEMENT CONNECT_REQUEST : ÉTAPES 9-12
+// ═══════════════════════════════════════════════════════
+// ÉTAPE 9  : CQ - la file de notifications de CE client
+//            (reprise d'un client parti si possible)
+// ÉTAPE 10 : QP - le "tuyau" RDMA de CE client (RC = fiable)
+// ÉTAPE 11 : accepter (les RECV attendent déjà dans le SRQ de la
+//            carte, créé avec le PD à la première connexion)
+// ÉTAPE 12 : adresse + RKEY dans la réponse à l'accept : le
+//            client peut lire / écrire dès son ESTABLISHED
+// En cas d'échec : rdma_reject, le client voit REJECTED et
+// les autres connexions ne sont pas touchées.
+
+static int on_connect_request(struct rdma_cm_id *id,
+                              const struct rdma_conn_param *req) {
+    struct conn_ctx *c = calloc(1, sizeof(*c));
+    if (!c) {
+        perror("   ❌ calloc (conn_ctx)");
+        rdma_reject(id, NULL, 0);
+        return -1;
+    }
+    c->num = next_conn_num++;
+    c->id = id;
+    c->cqw.epfd = -1;               // Rien à fermer tant que pas créé
+    c->mbox = KV_NO_MBOX;
+    id->context = c;
+    
+    c->dev = device_get(id->verbs);
+    if (!c->dev)
+        goto err;
+    if (c->dev->node >= 0)
+        numa_prefer(c->dev->node);  // CQ + QP de CE client : nœud de SA carte
+    
+    // ÉTAPE 9 : CRÉER COMPLETION QUEUE (CQ)
+    // Pire cas : tout le SRQ consommé par CE client avant que son
+    // thread ne passe (voir "SHARED RECEIVE QUEUE")
+    // Attente selon -W : par défaut hybride, le thread d'un client
+    // silencieux dort au lieu de brûler un cœur
+    if (cq_take(c->dev, &c->cqw, id->verbs))
+        goto err;
+    
+    // ÉTAPE 10 : CRÉER QUEUE PAIR (QP)
+    struct ibv_qp_init_attr qp_attr;
+    memset(&qp_attr, 0, sizeof(qp_attr));
+    qp_attr.send_cq = c->cqw.cq;        // CQ pour envois
+    qp_attr.recv_cq = c->cqw.cq;        // CQ pour réceptions
+    qp_attr.qp_type = IBV_QPT_RC;       // RC = Reliable Connection
+    qp_attr.srq = c->dev->srq;          // RECV : pris dans le SRQ
+    qp_attr.cap.max_send_wr = SRV_SEND_DEPTH;  // Réponses en attente
+    qp_attr.cap.max_send_sge = 1;       // 1 segment par send
+    qp_attr.cap.max_inline_data = INLINE_DEFAULT;  // Infos + petites réponses
+    
+    if (rdma_create_qp(id, c->dev->pd, &qp_attr)) {
+        // Carte sans (assez d') inline : on s'en passe
+        qp_attr.cap.max_inline_data = 0;
+        if (rdma_create_qp(id, c->dev->pd, &qp_attr)) {
+            perror("   ❌ rdma_create_qp");
+            goto err;
+        }
+    }
+    c->max_inline = qp_attr.cap.max_inline_data;
+    
+    // Anneau de messages : demandé par le client dans son connect
+    // (le sien), le nôtre a la même géométrie (rdma_ring.h). Au plus
+    // ECHO_WINDOW_MAX slots : autant d'échos en vol que la Send Queue
+    // (SRV_SEND_DEPTH) en prévoit ; au-delà, pas d'anneau (INFO_RING
+    // absent, le client le voit)
+    struct ring_desc peer_ring = { 0 };
+    if (req->private_data && req->private_data_len >= sizeof(peer_ring))
+        memcpy(&peer_ring, req->private_data, sizeof(peer_ring));
+    if (ring_desc_valid(&peer_ring) && peer_ring.slots > ECHO_WINDOW_MAX)
+        printf("   ⚠️  [client %d] Anneau de %u slots refusé (max %d)\n",
+               c->num, peer_ring.slots, ECHO_WINDOW_MAX);
+    else if (ring_desc_valid(&peer_ring)) {
+        size_t bytes = (size_t)peer_ring.slots << peer_ring.slot_shift;
+        c->ring_mem = aligned_alloc(4096, (bytes + 4095) & ~(size_t)4095);
+        if (!c->ring_mem) {
+            perror("   ❌ aligned_alloc (anneau)");
+            goto err;
+        }
+        c->ring_mr = ibv_reg_mr(c->dev->pd, c->ring_mem, bytes,
+                                IBV_ACCESS_LOCAL_WRITE | IBV_ACCESS_REMOTE_WRITE);
+        if (!c->ring_mr) {
+            perror("   ❌ ibv_reg_mr (anneau)");
+            goto err;
+        }
+        ring_init(&c->ring, id->qp, c->ring_mem, peer_ring.slots,
+                  peer_ring.slot_shift, c->max_inline);
+        ring_set_peer(&c->ring, &peer_ring);
+    }
+    
+    // Boîte aux lettres PUT : la première libre (s'il n'y en a plus,
+    // le client n'aura que les GET)
+    if (kv_buckets && ~kv_mbox_used) {
+        c->mbox = __builtin_ctzll(~kv_mbox_used);
+        kv_mbox_used |= 1ULL << c->mbox;
+    }
+    
+    // ÉTAPE 12 : LES INFOS DU CLIENT, DANS L'ACCEPT
+    // Copiées par le CM dans le message de réponse : rien à
+    // enregistrer, rien à poster, et la RAM exposée n'est pas touchée
+    struct rdma_buffer_info info = {
+        .addr = (uint64_t)buffer,
+        .rkey = c->dev->mr->rkey,
+        .max_send = sink_size,
+        .size = buffer_size,
+        .flags = (c->dev->atomic ? INFO_ATOMIC : 0) |
+                 (kv_buckets ? INFO_KV : 0) |
+                 (c->ring_mem ? INFO_RING : 0),
+        .mbox = c->mbox,
+    };
+    if (c->ring_mem) {
+        info.ring.addr = (uint64_t)c->ring_mem;
+        info.ring.rkey = c->ring_mr->rkey;
+        info.ring.slots = peer_ring.slots;
+        info.ring.slot_shift = peer_ring.slot_shift;
+    }
+    
+    // ÉTAPE 11 : ACCEPTER LA CONNEXION
+    // On accepte autant de RDMA_READ en vol que le client en demande
+    // (le CM a déjà plafonné aux capacités des deux cartes)
+    struct rdma_conn_param conn_param;
+    memset(&conn_param, 0, sizeof(conn_param));
+    conn_param.responder_resources = req->initiator_depth;
+    conn_param.initiator_depth = req->responder_resources;
+    conn_param.rnr_retry_count = 7;
+    conn_param.private_data = &info;
+    conn_param.private_data_len = sizeof(info);
+    
+    if (rdma_accept(id, &conn_param)) {
+        perror("   ❌ rdma_accept");
+        goto err;
+    }
+    
+    c->next = conns;
+    conns = c;
+    active_conns++;
+    
+    printf("🤝 [client %d] Connexion acceptée\n", c->num);
+    return 0;
+    
+err:
+    rdma_reject(id, NULL, 0);
+    // L'ID appartient à l'événement en cours : rdma_destroy_id
+    // bloquerait avant l'ACK → on le rend à la boucle CM
+    if (c->id->qp)
+        rdma_destroy_qp(id);
+    if (c->ring_mr)
+        ibv_dereg_mr(c->ring_mr);
+    free(c->ring_mem);
+    if (c->cqw.cq)
+        cq_give_back(c->dev, &c->cqw);
+    if (c->mbox != KV_NO_MBOX)
+        kv_mbox_used &= ~(1ULL << c->mbox);
+    id->context = NULL;
+    free(c);
+    return -1;
+}
+
+// ═══════════════════════════════════════════════════════
+// ÉVÉNEMENT ESTABLISHED : LANCER LE THREAD DU CLIENT
+// ═══════════════════════════════════════════════════════
+
+static void on_established(struct conn_ctx *c) {
+    int ret = pthread_create(&c->thread, NULL, conn_worker, c);
+    if (ret) {
+        printf("   ❌ [client %d] pthread_create : %s\n", c->num, strerror(ret));
+        rdma_disconnect(c->id);
+        return;
+    }
+    c->thread_started = 1;
+    
+    printf("   ✅ [client %d] Connexion ÉTABLIE (%d active(s))\n",
+           c->num, active_conns);
+}
+
+// ═══════════════════════════════════════════════════════
+// UN ÉVÉNEMENT CM (ACK compris)
+// ═══════════════════════════════════════════════════════
+// Tout événement concerne UNE connexion (id->context) : aucun n'est
+// fatal pour le serveur, un événement inconnu est juste signalé.
+
+static void on_cm_event(struct rdma_cm_event *event) {
+    struct rdma_cm_id *id = event->id;
+    struct conn_ctx *c = id->context;
+    enum rdma_cm_event_type type = event->event;
+    
+    switch (type) {
+    case RDMA_CM_EVENT_CONNECT_REQUEST:
+        if (on_connect_request(id, &event->param.conn)) {
+            // Rejeté : l'ID se détruit APRÈS l'ACK
+            rdma_ack_cm_event(event);
+            rdma_destroy_id(id);
+            return;
+        }
+        break;
+        
+    case RDMA_CM_EVENT_ESTABLISHED:
+        if (c)
+            on_established(c);
+        break;
+        
+    case RDMA_CM_EVENT_DISCONNECTED:
+        if (c) {
+            conn_unlink(c);
+            printf("👋 [client %d] %s (%ld PING, %ld anneau, %ld PUT, %ld SEND"
+                   " puits = %lu octets, %lu sommeils, %d active(s))\n", c->num,
+                   rdma_event_str(type), c->pings, c->ring_msgs, c->kv_puts,
+                   c->sink_msgs, c->sink_bytes, c->cqw.sleeps, active_conns);
+            odp_report(c->dev);
+            conn_retire(c);
+        }
+        break;
+        
+    case RDMA_CM_EVENT_TIMEWAIT_EXIT:
+        // ACK d'abord : rdma_destroy_id attend tous les ACK
+        rdma_ack_cm_event(event);
+        if (c)
+            timewait_reap(c, 0);
+        return;
+        
+    case RDMA_CM_EVENT_CONNECT_ERROR:
+    case RDMA_CM_EVENT_UNREACHABLE:
+    case RDMA_CM_EVENT_REJECTED:
+        // Jamais établie : rien en vol, pas de timewait
+        rdma_ack_cm_event(event);
+        if (c) {
+            conn_unlink(c);
+            printf("👋 [client %d] %s (%d active(s))\n", c->num,
+                   rdma_event_str(type), active_conns);
+            conn_destroy(c);
+        }
+        return;
+        
+    default:
+        printf("   ⚠️  Événement ignoré : %s\n", rdma_event_str(type));
+        break;
+    }
+    
+    rdma_ack_cm_event(event);
+}
+
+int main(int argc, char *argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "b:H:O:W:u:XK:h")) != -1) {
+        switch (opt) {
+        case 'b':
+            buffer_size = parse_size(optarg);
+            if (buffer_size < 4096) {
+                printf("❌ Taille invalide : au moins 4K\n");
+                return 1;
+            }
+            break;
+        case 'H':
+            if (mem_pages_parse(optarg, &region_pages)) {
+                printf("❌ -H : 4k, 2m ou 1g\n");
+                return 1;
+            }
+            break;
+        case 'O':
+            if (!strcmp(optarg, "pin"))           reg_mode = REG_PIN;
+            else if (!strcmp(optarg, "odp"))      reg_mode = REG_ODP;
+            else if (!strcmp(optarg, "implicit")) reg_mode = REG_IMPLICIT;
+            else {
+                printf("❌ -O : pin, odp ou implicit\n");
+                return 1;
+            }
+            break;
+        case 'W':
+            if (cq_mode_parse(optarg, &cq_mode)) {
+                printf("❌ -W : poll, event ou hybrid\n");
+                return 1;
+            }
+            break;
+        case 'u':
+            spin_us = atoi(optarg);
+            if (spin_us < 0) {
+                printf("❌ Budget de spin invalide\n");
+                return 1;
+            }
+            break;
+        case 'X':
+            numa_cross = 1;
+            break;
+        case 'K':
+            kv_buckets = parse_size(optarg);
+            if (kv_buckets == 0) {
+                printf("❌ Nombre de buckets invalide\n");
+                return 1;
+            }
+            break;
+        default:
+            printf("Usage: %s [-b taille] [-H 4k|2m|1g] [-O pin|odp|implicit]"
+                   " [-W poll|event|hybrid] [-u μs] [-X] [-K buckets]\n",
+                   argv[0]);
+            return 1;
+        }
+    }
+    
     printf("═══════════════════════════════════════════════════\n");
     printf("    RDMA SERVER - HELLO WORLD INFINIBAND\n");
     printf("═══════════════════════════════════════════════════\n\n");
@@ -49,29 +1180,69 @@ int main() {
     // CRITICAL: Verrouiller la mémoire pour RDMA
     // Évite que le kernel ne "swap" la mémoire sur disque
     // Ce qui bloquerait l'HCA d'accéder à la RAM physique
-    printf("🔒 Verrouillage mémoire pour RDMA...\n");
-    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
-        perror("   ⚠️  mlockall échoué (non-critique, continue)");
+    // → SAUF en ODP : MCL_FUTURE fauterait et verrouillerait toute
+    //   la RAM exposée, exactement ce que l'ODP veut éviter
+    if (reg_mode == REG_PIN) {
+        printf("🔒 Verrouillage mémoire pour RDMA...\n");
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+            perror("   ⚠️  mlockall échoué (non-critique, continue)");
+        } else {
+            printf("   ✅ Mémoire verrouillée pour RDMA\n\n");
+        }
     } else {
-        printf("   ✅ Mémoire verrouillée pour RDMA\n\n");
+        printf("🔓 ODP (%s) : pas de mlockall, rien n'est épinglé\n\n",
+               reg_mode_name(reg_mode));
     }
     
     // ═══════════════════════════════════════════════════════
     // ÉTAPE 1 : ALLOUER LA RAM QU'ON VA EXPOSER
     // ═══════════════════════════════════════════════════════
-    // CONCRÈTEMENT : malloc() alloue 1 MB dans notre espace mémoire
+    // CONCRÈTEMENT : mmap() de -b octets (1 MB par défaut), en pages
+    // de 4 KB ou en huge pages (-H 2m / 1g)
     // Cette RAM est normale pour l'instant (pas encore RDMA-accessible)
     
     printf("📦 ÉTAPE 1 : Allocation mémoire\n");
-    printf("   Utilisons buffer statique (pré-alloué)...\n");
+    printf("   %zu octets, pages de %s...\n", buffer_size,
+           mem_pages_name(region_pages));
+    
+    // Arrondi à la page choisie : la RAM exposée est vue par les
+    // clients comme un tableau de pages de 4 KB (RDMA_PAGE_SIZE)
+    // En ODP : réservée seulement, chaque page arrive au 1er accès
+    if ((reg_mode == REG_PIN ? mem_region_alloc : mem_region_reserve)
+            (&region, buffer_size, region_pages))
+        return 1;
+    buffer = region.addr;
+    buffer_size = region.size;
+    sink_size = buffer_size < MAX_SEND_SIZE ? buffer_size : MAX_SEND_SIZE;
     
-    // Buffer STATIQUE - plus stable pour RDMA, déjà en mémoire
-    static char buffer[1024*1024] __attribute__((aligned(4096)));
-    memset(buffer, 0, sizeof(buffer));
-    strcpy(buffer, "Hello from Server! This is RDMA magic.");
+    sink = aligned_alloc(4096, (sink_size + 4095) & ~(size_t)4095);
+    if (!sink) {
+        perror("   ❌ aligned_alloc (puits)");
+        return 1;
+    }
     
     printf("   ✅ RAM allouée à l'adresse : %p\n", buffer);
-    printf("   📝 Contenu initial : '%s'\n\n", buffer);
+    if (kv_buckets) {
+        // En-tête, boîtes et buckets au début, valeurs derrière
+        if (kv_format(&kv, buffer, buffer_size, kv_buckets)) {
+            printf("   ❌ -K %lu : %zu octets ne suffisent pas (256 octets"
+                   " par bucket, plus les boîtes et le tas)\n",
+                   kv_buckets, buffer_size);
+            return 1;
+        }
+        printf("   🗄️  Table clé-valeur : %lu buckets x %d slots, %d boîtes"
+               " PUT, tas de %lu octets\n", kv_buckets, KV_BUCKET_SLOTS,
+               KV_MBOXES, kv.hdr->heap_size);
+    } else {
+        // mmap anonyme : déjà à zéro
+        strcpy(buffer, "Hello from Server! This is RDMA magic.");
+        printf("   📄 %zu pages de %d octets (page_id 0..%zu)\n",
+               buffer_size / RDMA_PAGE_SIZE, RDMA_PAGE_SIZE,
+               buffer_size / RDMA_PAGE_SIZE - 1);
+        printf("   📝 Contenu initial : '%s'\n", buffer);
+    }
+    odp_report(NULL);
+    printf("\n");
     
     // ═══════════════════════════════════════════════════════
     // ÉTAPE 2 : CRÉER UN "RDMA EVENT CHANNEL"
@@ -90,6 +1261,14 @@ int main() {
         return 1;
     }
     
+    // Non bloquant, surveillé par epoll (rdma_cmloop.h) : la boucle
+    // ÉTAPE 6 ne reste jamais coincée dans rdma_get_cm_event
+    struct cm_loop cm_loop;
+    if (cm_loop_init(&cm_loop, cm_channel)) {
+        rdma_destroy_event_channel(cm_channel);
+        return 1;
+    }
+    
     printf("   ✅ Event channel créé\n\n");
     
     // ═══════════════════════════════════════════════════════
@@ -107,6 +1286,7 @@ int main() {
     int ret = rdma_create_id(cm_channel, &cm_id, NULL, RDMA_PS_TCP);
     if (ret) {
         perror("   ❌ rdma_create_id");
+        cm_loop_destroy(&cm_loop);
         rdma_destroy_event_channel(cm_channel);
         return 1;
     }
@@ -120,484 +1300,137 @@ int main() {
     // → On dit "j'écoute sur le port 12345"
     // → N'importe quelle interface (INADDR_ANY)
     
-    printf("📍 ÉTAPE 4 : Bind sur port 12345\n");
+    printf("📍 ÉTAPE 4 : Bind sur port %d\n", RDMA_PORT);
     printf("   (Comme bind() en TCP)\n");
     
     struct sockaddr_in addr;
     memset(&addr, 0, sizeof(addr));
     addr.sin_family = AF_INET;
-    addr.sin_port = htons(12345);
+    addr.sin_port = htons(RDMA_PORT);
     addr.sin_addr.s_addr = INADDR_ANY;  // Toutes les interfaces
     
     ret = rdma_bind_addr(cm_id, (struct sockaddr *)&addr);
     if (ret) {
         perror("   ❌ rdma_bind_addr");
         rdma_destroy_id(cm_id);
+        cm_loop_destroy(&cm_loop);
         rdma_destroy_event_channel(cm_channel);
         return 1;
     }
     
-    printf("   ✅ Bind réussi sur 0.0.0.0:12345\n\n");
+    printf("   ✅ Bind réussi sur 0.0.0.0:%d\n\n", RDMA_PORT);
     
     // ═══════════════════════════════════════════════════════
     // ÉTAPE 5 : ÉCOUTER LES CONNEXIONS
     // ═══════════════════════════════════════════════════════
     // CONCRÈTEMENT : Comme listen() pour TCP
     // → On attend des connexions entrantes
-    // → Backlog = 1 (une seule connexion à la fois)
+    // → Backlog = LISTEN_BACKLOG (des centaines de clients peuvent
+    //   arriver en même temps : nœuds de calcul qui redémarrent ;
+    //   trop petit, le CM rejette les demandes en trop)
     
     printf("👂 ÉTAPE 5 : Écoute des connexions\n");
     printf("   (Comme listen() en TCP)\n");
     
-    ret = rdma_listen(cm_id, 1);
+    ret = rdma_listen(cm_id, LISTEN_BACKLOG);
     if (ret) {
         perror("   ❌ rdma_listen");
         rdma_destroy_id(cm_id);
+        cm_loop_destroy(&cm_loop);
         rdma_destroy_event_channel(cm_channel);
         return 1;
     }
     
-    printf("   ✅ En écoute sur port 12345\n\n");
+    printf("   ✅ En écoute sur port %d\n\n", RDMA_PORT);
     
     printf("═══════════════════════════════════════════════════\n");
-    printf("    SERVEUR PRÊT - En attente du client...\n");
+    printf("    SERVEUR PRÊT - En attente des clients...\n");
     printf("═══════════════════════════════════════════════════\n\n");
     
-    // ═══════════════════════════════════════════════════════
-    // ÉTAPE 6 : ACCEPTER LA CONNEXION CLIENT
-    // ═══════════════════════════════════════════════════════
-    // CONCRÈTEMENT : Comme accept() pour TCP
-    // → On attend un événement RDMA_CM_EVENT_CONNECT_REQUEST
-    // → Le client essaie de se connecter
-    
-    printf("⏳ ÉTAPE 6 : Attente connexion client...\n");
-    
-    struct rdma_cm_event *event;
-    ret = rdma_get_cm_event(cm_channel, &event);
-    if (ret) {
-        perror("   ❌ rdma_get_cm_event");
-        rdma_destroy_id(cm_id);
-        rdma_destroy_event_channel(cm_channel);
-        return 1;
-    }
-    
-    if (event->event != RDMA_CM_EVENT_CONNECT_REQUEST) {
-        printf("   ❌ Événement inattendu : %d\n", event->event);
-        rdma_ack_cm_event(event);
-        rdma_destroy_id(cm_id);
-        rdma_destroy_event_channel(cm_channel);
-        return 1;
-    }
-    
-    struct rdma_cm_id *client_id = event->id;
-    printf("   ✅ Client connecté !\n\n");
-    rdma_ack_cm_event(event);
-    
-    // ═══════════════════════════════════════════════════════
-    // ÉTAPE 7 : CRÉER "PROTECTION DOMAIN" (PD)
-    // ═══════════════════════════════════════════════════════
-    // C'EST QUOI ?
-    // → Une zone de sécurité pour tes ressources RDMA
-    // → Toutes tes ressources (QP, MR) doivent être dans le même PD
-    // → Comme un "namespace" pour isoler les ressources
-    
-    printf("🛡️  ÉTAPE 7 : Création Protection Domain\n");
-    printf("   (Zone de sécurité pour ressources RDMA)\n");
-    
-    struct ibv_pd *pd = ibv_alloc_pd(client_id->verbs);
-    if (!pd) {
-        perror("   ❌ ibv_alloc_pd");
-        rdma_destroy_id(client_id);
-        rdma_destroy_id(cm_id);
-        rdma_destroy_event_channel(cm_channel);
-        return 1;
-    }
-    
-    printf("   ✅ Protection Domain créé\n\n");
-    
-    // ═══════════════════════════════════════════════════════
-    // ÉTAPE 8 : ENREGISTRER LA RAM (MEMORY REGISTRATION)
-    // ═══════════════════════════════════════════════════════
-    // ✨ C'EST L'ÉTAPE MAGIQUE ! ✨
-    // 
-    // QU'EST-CE QUI SE PASSE CONCRÈTEMENT ?
-    // 
-    // 1. Tu dis à la carte InfiniBand : "Cette zone RAM est à toi"
-    // 2. La carte "pin" cette RAM en mémoire physique
-    //    (l'OS ne peut plus la déplacer ou la swapper)
-    // 3. La carte te donne une RKEY (Remote Key = clé d'accès)
-    // 4. Avec cette RKEY, le client pourra accéder à cette RAM
-    //
-    // DROITS D'ACCÈS :
-    // - IBV_ACCESS_LOCAL_WRITE  : le serveur peut écrire localement
-    // - IBV_ACCESS_REMOTE_READ  : le client peut lire à distance
-    // - IBV_ACCESS_REMOTE_WRITE : le client peut écrire à distance
-    //
-    // APRÈS CETTE ÉTAPE :
-    // → La carte InfiniBand peut lire/écrire cette RAM
-    // → SANS passer par le CPU du serveur
-    // → C'est la MAGIE de RDMA !
-    
-    printf("✨ ÉTAPE 8 : Memory Registration (MAGIE RDMA)\n");
-    printf("   ┌─────────────────────────────────────────────┐\n");
-    printf("   │ On dit à la carte InfiniBand :              │\n");
-    printf("   │ 'Cette RAM est à toi, tu peux y accéder     │\n");
-    printf("   │  directement sans passer par le CPU !'      │\n");
-    printf("   └─────────────────────────────────────────────┘\n\n");
-    
-    struct ibv_mr *mr = ibv_reg_mr(
-        pd,                             // Protection Domain
-        buffer,                         // Adresse de la RAM
-        BUFFER_SIZE,                    // Taille (1 MB)
-        IBV_ACCESS_LOCAL_WRITE |        // Serveur peut écrire
-        IBV_ACCESS_REMOTE_READ |        // Client peut lire
-        IBV_ACCESS_REMOTE_WRITE         // Client peut écrire
-    );
-    
-    if (!mr) {
-        perror("   ❌ ibv_reg_mr");
-        ibv_dealloc_pd(pd);
-        rdma_destroy_id(client_id);
-        rdma_destroy_id(cm_id);
-        rdma_destroy_event_channel(cm_channel);
-        return 1;
-    }
-    
-    printf("   ✅ MAGIE ACCOMPLIE ! ✨\n");
-    printf("   ┌─────────────────────────────────────────────┐\n");
-    printf("   │ La carte InfiniBand peut maintenant :      │\n");
-    printf("   │ • Lire cette RAM directement                │\n");
-    printf("   │ • Écrire dans cette RAM directement         │\n");
-    printf("   │ • SANS réveiller le CPU du serveur !        │\n");
-    printf("   └─────────────────────────────────────────────┘\n\n");
-    
-    printf("   📊 Infos de la RAM enregistrée :\n");
-    printf("      • Adresse virtuelle : %p\n", buffer);
-    printf("      • RKEY (clé accès)  : 0x%x\n", mr->rkey);
-    printf("      • LKEY (clé locale) : 0x%x\n\n", mr->lkey);
-    
-    // ═══════════════════════════════════════════════════════
-    // ÉTAPE 9 : CRÉER COMPLETION QUEUE (CQ)
-    // ═══════════════════════════════════════════════════════
-    // C'EST QUOI ?
-    // → Une file d'attente pour les notifications
-    // → Quand une opération RDMA se termine, un événement arrive ici
-    // → Le CPU peut "poll" cette queue pour savoir si c'est fini
-    
-    printf("📨 ÉTAPE 9 : Création Completion Queue\n");
-    printf("   (File pour notifications d'opérations RDMA)\n");
-    
-    struct ibv_cq *cq = ibv_create_cq(client_id->verbs, 16, NULL, NULL, 0);
-    if (!cq) {
-        perror("   ❌ ibv_create_cq");
-        ibv_dereg_mr(mr);
-        ibv_dealloc_pd(pd);
-        rdma_destroy_id(client_id);
-        rdma_destroy_id(cm_id);
-        rdma_destroy_event_channel(cm_channel);
-        return 1;
-    }
-    
-    printf("   ✅ Completion Queue créée\n\n");
-    
-    // ═══════════════════════════════════════════════════════
-    // ÉTAPE 10 : CRÉER QUEUE PAIR (QP)
-    // ═══════════════════════════════════════════════════════
-    // C'EST QUOI ?
-    // → Le "tuyau" par lequel passent les données RDMA
-    // → Équivalent d'un socket TCP, mais pour RDMA
-    // → 2 queues :
-    //   - Send Queue : pour envoyer des données
-    //   - Receive Queue : pour recevoir des données
-    // → Type RC (Reliable Connection) = connexion fiable
-    
-    printf("🚰 ÉTAPE 10 : Création Queue Pair\n");
-    printf("   (Le 'tuyau' RDMA - équivalent d'un socket)\n");
-    
-    struct ibv_qp_init_attr qp_attr;
-    memset(&qp_attr, 0, sizeof(qp_attr));
-    qp_attr.send_cq = cq;               // CQ pour envois
-    qp_attr.recv_cq = cq;               // CQ pour réceptions
-    qp_attr.qp_type = IBV_QPT_RC;       // RC = Reliable Connection
-    qp_attr.cap.max_send_wr = 16;       // Max 16 send en attente
-    qp_attr.cap.max_recv_wr = 16;       // Max 16 recv en attente
-    qp_attr.cap.max_send_sge = 1;       // 1 segment par send
-    qp_attr.cap.max_recv_sge = 1;       // 1 segment par recv
-    
-    ret = rdma_create_qp(client_id, pd, &qp_attr);
-    if (ret) {
-        perror("   ❌ rdma_create_qp");
-        ibv_destroy_cq(cq);
-        ibv_dereg_mr(mr);
-        ibv_dealloc_pd(pd);
-        rdma_destroy_id(client_id);
-        rdma_destroy_id(cm_id);
-        rdma_destroy_event_channel(cm_channel);
-        return 1;
-    }
-    
-    printf("   ✅ Queue Pair créée\n\n");
-    
-    // ═══════════════════════════════════════════════════════
-    // ÉTAPE 11 : ACCEPTER LA CONNEXION
-    // ═══════════════════════════════════════════════════════
-    // CONCRÈTEMENT : On finalise la connexion avec le client
-    // → On envoie notre "ACK" au client
-    // → La connexion RDMA est maintenant établie
-    
-    printf("🤝 ÉTAPE 11 : Acceptation de la connexion\n");
-    
-    struct rdma_conn_param conn_param;
-    memset(&conn_param, 0, sizeof(conn_param));
-    
-    ret = rdma_accept(client_id, &conn_param);
-    if (ret) {
-        perror("   ❌ rdma_accept");
-        ibv_destroy_qp(client_id->qp);
-        ibv_destroy_cq(cq);
-        ibv_dereg_mr(mr);
-        ibv_dealloc_pd(pd);
-        rdma_destroy_id(client_id);
-        rdma_destroy_id(cm_id);
-        rdma_destroy_event_channel(cm_channel);
-        return 1;
-    }
-    
-    printf("   ✅ Connexion acceptée\n");
-    
-    // Attendre l'événement ESTABLISHED
-    ret = rdma_get_cm_event(cm_channel, &event);
-    if (ret || event->event != RDMA_CM_EVENT_ESTABLISHED) {
-        printf("   ❌ Échec établissement connexion\n");
-        rdma_ack_cm_event(event);
-        ibv_destroy_qp(client_id->qp);
-        ibv_destroy_cq(cq);
-        ibv_dereg_mr(mr);
-        ibv_dealloc_pd(pd);
-        rdma_destroy_id(client_id);
-        rdma_destroy_id(cm_id);
-        rdma_destroy_event_channel(cm_channel);
-        return 1;
-    }
-    
-    printf("   ✅ Connexion ÉTABLIE\n\n");
-    rdma_ack_cm_event(event);
-    
-    // ═══════════════════════════════════════════════════════
-    // INITIALISER LE QP : POST_RECV DUMMY
-    // ═══════════════════════════════════════════════════════
-    // Les QP doivent avoir au moins une opération RECV postée
-    // pour être complètement initialisés et prêts pour les
-    // opérations RDMA distantes (READ/WRITE)
-    
-    struct ibv_sge recv_sge_dummy;
-    recv_sge_dummy.addr = (uint64_t)buffer;
-    recv_sge_dummy.length = sizeof(struct rdma_buffer_info);
-    recv_sge_dummy.lkey = mr->lkey;
-    
-    struct ibv_recv_wr recv_wr_dummy, *bad_recv_wr;
-    memset(&recv_wr_dummy, 0, sizeof(recv_wr_dummy));
-    recv_wr_dummy.wr_id = 0;
-    recv_wr_dummy.sg_list = &recv_sge_dummy;
-    recv_wr_dummy.num_sge = 1;
-    
-    ret = ibv_post_recv(client_id->qp, &recv_wr_dummy, &bad_recv_wr);
-    if (ret) {
-        perror("   ⚠️  Dummy POST_RECV échoué (continue)");
-    }
     
     // ═══════════════════════════════════════════════════════
-    // ÉTAPE 12 : ENVOYER LES INFOS AU CLIENT
+    // ÉTAPE 6 : BOUCLE D'ÉVÉNEMENTS CM
     // ═══════════════════════════════════════════════════════
-    // ON ENVOIE QUOI ?
-    // → L'adresse virtuelle de la RAM
-    // → La RKEY (clé d'accès)
+    // CONCRÈTEMENT : comme une boucle accept() d'un serveur TCP
+    // → CONNECT_REQUEST : nouveau client → ÉTAPES 9-11
+    // → ESTABLISHED     : connexion prête → thread du client
+    // → DISCONNECTED    : client parti → son thread s'arrête, sa QP
+    //                     passe en timewait
+    // → TIMEWAIT_EXIT   : on libère SON contexte
     //
-    // AVEC CES 2 INFOS, LE CLIENT POURRA :
-    // → Faire RDMA_READ pour lire la RAM
-    // → Faire RDMA_WRITE pour écrire dans la RAM
-    // → SANS réveiller le CPU du serveur !
+    // Le listener, le PD et la RAM exposée ne sont JAMAIS détruits
+    // par le départ d'un client.
     
-    // ═══════════════════════════════════════════════════════
-    // ÉTAPE 12 : ENVOYER LES INFOS AU CLIENT
-    // ═══════════════════════════════════════════════════════
-    // ON ENVOIE QUOI ?
-    // → L'adresse virtuelle de la RAM
-    // → La RKEY (clé d'accès)
-    //
-    // AVEC CES 2 INFOS, LE CLIENT POURRA :
-    // → Faire RDMA_READ pour lire la RAM
-    // → Faire RDMA_WRITE pour écrire dans la RAM
-    // → SANS réveiller le CPU du serveur !
-    
-    printf("📤 ÉTAPE 12 : Envoi des infos au client\n");
-    
-    // Placer les infos au DÉBUT du buffer (plus sûr)
-    struct rdma_buffer_info *info = (struct rdma_buffer_info *)buffer;
-    info->addr = (uint64_t)buffer;
-    info->rkey = mr->rkey;
-
-    printf("   ┌─────────────────────────────────────────────┐\n");
-    printf("   │ INFORMATIONS ENVOYÉES AU CLIENT :           │\n");
-    printf("   ├─────────────────────────────────────────────┤\n");
-    printf("   │ Adresse RAM : 0x%016lx          │\n", info->addr);
-    printf("   │ RKEY        : 0x%08x                    │\n", info->rkey);
-    printf("   │ Info addr   : 0x%016lx (start)     │\n", (uint64_t)info);
-    printf("   │ Buffer addr : 0x%016lx                │\n", (uint64_t)buffer);
-    printf("   │ MR LKEY     : 0x%08x                    │\n", mr->lkey);
-    printf("   │                                             │\n");
-    printf("   │ Le client peut maintenant :                 │\n");
-    printf("   │ • RDMA_READ  → lire cette RAM               │\n");
-    printf("   │ • RDMA_WRITE → écrire dans cette RAM        │\n");
-    printf("   │ • Sans JAMAIS réveiller mon CPU ! 😴        │\n");
-    printf("   └─────────────────────────────────────────────┘\n\n");
-
-    // Préparer la requête d'envoi (depuis le buffer qui est enregistré)
-    struct ibv_sge sge;
-    sge.addr = (uint64_t)info;  // ← Envoyer depuis le DÉBUT du buffer
-    sge.length = sizeof(struct rdma_buffer_info);
-    sge.lkey = mr->lkey;
-
-    struct ibv_send_wr send_wr, *bad_wr;
-    memset(&send_wr, 0, sizeof(send_wr));
-    send_wr.wr_id = 1;
-    send_wr.sg_list = &sge;
-    send_wr.num_sge = 1;
-    send_wr.opcode = IBV_WR_SEND;
-    send_wr.send_flags = IBV_SEND_SIGNALED;
-
-    ret = ibv_post_send(client_id->qp, &send_wr, &bad_wr);
-    if (ret) {
-        perror("   ❌ ibv_post_send");
-        return 1;
-    }
-
-    // Attendre la complétion
-    struct ibv_wc wc;
-    while (ibv_poll_cq(cq, 1, &wc) < 1);
-
-    if (wc.status != IBV_WC_SUCCESS) {
-        printf("   ❌ Envoi échoué (status: %d)\n", wc.status);
-        return 1;
-    }
-
-    printf("   ✅ Infos envoyées au client\n\n");
-    
-    // ═══════════════════════════════════════════════════════
-    // ÉTAPE 13 : ATTENDRE SIGNAL DU CLIENT AVANT D'ENVOYER
-    // ═══════════════════════════════════════════════════════
-    // Le client va nous envoyer un dummy message pour signaler
-    // qu'il a posté son RECV et est prêt à recevoir
-    
-    printf("📥 ÉTAPE 13 : Attente signal client avant envoi données...\n");
-    
-    struct ibv_sge sge_signal;
-    sge_signal.addr = (uint64_t)buffer;
-    sge_signal.length = 1;  // Juste 1 byte
-    sge_signal.lkey = mr->lkey;
-    
-    struct ibv_recv_wr recv_signal_wr, *bad_recv_signal_wr;
-    memset(&recv_signal_wr, 0, sizeof(recv_signal_wr));
-    recv_signal_wr.wr_id = 100;
-    recv_signal_wr.sg_list = &sge_signal;
-    recv_signal_wr.num_sge = 1;
-    
-    ret = ibv_post_recv(client_id->qp, &recv_signal_wr, &bad_recv_signal_wr);
-    if (ret) {
-        perror("   ❌ ibv_post_recv (signal)");
-        return 1;
-    }
-    
-    // Attendre le signal du client
-    while (ibv_poll_cq(cq, 1, &wc) < 1);
-    
-    if (wc.status != IBV_WC_SUCCESS) {
-        printf("   ❌ Signal échoué (status: %d)\n", wc.status);
-        return 1;
-    }
-    
-    printf("   ✅ Signal reçu - le client est prêt\n\n");
-    
-    // ═══════════════════════════════════════════════════════
-    // ÉTAPE 14 : MESURER LA LATENCE D'ENVOI
-    // ═══════════════════════════════════════════════════════
-    struct timespec latency_start, latency_end;
-    clock_gettime(CLOCK_MONOTONIC, &latency_start);
-    
-    printf("📤 ÉTAPE 14 : Envoi contenu RAM au client\n");
-    
-    struct ibv_sge sge_data;
-    sge_data.addr = (uint64_t)buffer;
-    sge_data.length = 100;  // Envoyer 100 octets
-    sge_data.lkey = mr->lkey;
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_sigint;      // Pas de SA_RESTART : on veut EINTR
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
     
-    struct ibv_send_wr send_wr_data, *bad_wr_data;
-    memset(&send_wr_data, 0, sizeof(send_wr_data));
-    send_wr_data.wr_id = 2;
-    send_wr_data.sg_list = &sge_data;
-    send_wr_data.num_sge = 1;
-    send_wr_data.opcode = IBV_WR_SEND;
-    send_wr_data.send_flags = IBV_SEND_SIGNALED;
-    
-    ret = ibv_post_send(client_id->qp, &send_wr_data, &bad_wr_data);
-    if (ret) {
-        perror("   ❌ ibv_post_send (données)");
-        return 1;
-    }
-    
-    // Attendre complétion
-    while (ibv_poll_cq(cq, 1, &wc) < 1);
-    
-    clock_gettime(CLOCK_MONOTONIC, &latency_end);
-    
-    // Calculer la latence en microsecondes
-    long latency_us = (latency_end.tv_sec - latency_start.tv_sec) * 1000000 +
-                      (latency_end.tv_nsec - latency_start.tv_nsec) / 1000;
+    struct rdma_cm_event *event;
     
-    if (wc.status != IBV_WC_SUCCESS) {
-        printf("   ❌ Envoi données échoué (status: %d)\n", wc.status);
-        return 1;
+    while (!stop_server) {
+        // Dort sur le canal CM (ou SRV_TICK_MS, ou Ctrl+C) ; puis
+        // TOUS les événements prêts, chacun pour SA connexion
+        if (cm_loop_wait(&cm_loop, SRV_TICK_MS) < 0) {
+            perror("   ❌ epoll_wait");
+            break;
+        }
+        while (!stop_server && (ret = cm_loop_next(&cm_loop, &event)) > 0)
+            on_cm_event(event);
+        if (ret < 0) {
+            perror("   ❌ rdma_get_cm_event");
+            break;
+        }
+        timewait_reap(NULL, 0);
     }
     
-    printf("   ✅ Données envoyées au client (latence: %ld μs)\n\n", latency_us);
-
-    printf("═══════════════════════════════════════════════════\n");
-    printf("    HANDSHAKE COMPLET - CONNEXION RÉUSSIE ✅\n");
-    printf("═══════════════════════════════════════════════════\n\n");
-    printf("La communication SEND/RECV fonctionne parfaitement !\n");
-    printf("Le client a reçu les données serveur sans RDMA_READ.\n\n");
-    
     printf("\n═══════════════════════════════════════════════════\n");
     printf("    FIN DU SERVEUR\n");
     printf("═══════════════════════════════════════════════════\n");
     
     // Cleanup - ORDRE CRITIQUE POUR RDMA !
-    // 1. Disconnect RDMA en premier (avant destruction QP)
-    rdma_disconnect(client_id);
-    
-    // 2. Destroy QP
-    ibv_destroy_qp(client_id->qp);
-    
-    // 3. Drain CQ
-    struct ibv_wc wc_drain;
-    int drain_count = 0;
-    while (ibv_poll_cq(cq, 1, &wc_drain) > 0) {
-        drain_count++;
+    // 1. Déconnecter et libérer chaque client encore là (et ceux
+    //    en timewait : on ne réutilisera plus rien)
+    while (conns) {
+        struct conn_ctx *c = conns;
+        conns = c->next;
+        rdma_disconnect(c->id);
+        conn_destroy(c);
+    }
+    timewait_reap(NULL, 1);
+    
+    if (kv_buckets)
+        printf("🗄️  Table clé-valeur : %lu clés, %lu PUT, tas %lu / %lu"
+               " octets\n", kv.keys, kv.puts, kv.heap_used,
+               kv.hdr->heap_size);
+    
+    // 2. Arrêter les threads d'événements, détruire les SRQ
+    //    (plus aucune QP ne s'en sert)
+    // 3. Deregister MR + Deallocate PD de chaque carte
+    stop_server = 1;
+    for (int i = 0; i < num_devices; i++) {
+        if (devices[i].async_started)
+            pthread_join(devices[i].async_thread, NULL);
+        printf("📥 %s : SRQ re-rempli %ld fois, %ld CQ créée(s), %ld"
+               " reprise(s)\n", ibv_get_device_name(devices[i].verbs->device),
+               devices[i].srq_refills, devices[i].cq_created,
+               devices[i].cq_reused);
+        while (devices[i].num_spare > 0)
+            cq_waiter_destroy(&devices[i].cq_spare[--devices[i].num_spare]);
+        ibv_destroy_srq(devices[i].srq);
+        ibv_dereg_mr(devices[i].sink_mr);
+        ibv_dereg_mr(devices[i].mr);
+        ibv_dealloc_pd(devices[i].pd);
     }
     
-    // 4. Destroy CQ
-    ibv_destroy_cq(cq);
-    
-    // 5. Deregister MR
-    ibv_dereg_mr(mr);
-    
-    // 6. Deallocate PD
-    ibv_dealloc_pd(pd);
-    
-    // 7-9. RDMA cleanup
-    rdma_destroy_id(client_id);
+    // 4. RDMA cleanup
     rdma_destroy_id(cm_id);
+    cm_loop_destroy(&cm_loop);
     rdma_destroy_event_channel(cm_channel);
     
+    free(sink);
+    mem_region_free(&region);
+    
     return 0;
-}
\ No newline at end of file
+}